@@ -0,0 +1,239 @@
+#pragma once
+
+/*
+	Keyframe animation tracks
+	Vito Domenico Tagliente
+	math library for games
+*/
+
+#include <algorithm>
+#include <vector>
+#include "common.h"
+#include "vector.h"
+#include "quaternion.h"
+
+namespace math4games
+{
+	// interpolation between two keys
+	enum class interpolation
+	{
+		step,
+		linear,
+		cubic // Hermite, with per key tangents
+	};
+
+	// how a value type is stored in a track
+	template<typename T>
+	struct track_traits;
+
+	template<std::size_t N>
+	struct track_traits<base_vector<N, float>>
+	{
+		static const std::size_t components = N;
+		static const bool normalize = false;
+
+		static void store(const base_vector<N, float>& value, float* dst) {
+			for (unsigned int i = 0; i < N; ++i)
+				dst[i] = value[i];
+		}
+
+		static base_vector<N, float> load(const float* src) {
+			base_vector<N, float> value;
+			for (unsigned int i = 0; i < N; ++i)
+				value[i] = src[i];
+			return value;
+		}
+	};
+
+	template<>
+	struct track_traits<vector2> : track_traits<base_vector<2, float>> {};
+	template<>
+	struct track_traits<vector3> : track_traits<base_vector<3, float>> {};
+	template<>
+	struct track_traits<vector4> : track_traits<base_vector<4, float>> {};
+
+	template<>
+	struct track_traits<float>
+	{
+		static const std::size_t components = 1;
+		static const bool normalize = false;
+
+		static void store(const float value, float* dst) {
+			dst[0] = value;
+		}
+
+		static float load(const float* src) {
+			return src[0];
+		}
+	};
+
+	// quaternions are blended component wise, then normalized
+	template<>
+	struct track_traits<quaternion>
+	{
+		static const std::size_t components = 4;
+		static const bool normalize = true;
+
+		static void store(const quaternion& value, float* dst) {
+			dst[0] = value.v[0];
+			dst[1] = value.v[1];
+			dst[2] = value.v[2];
+			dst[3] = value.w;
+		}
+
+		static quaternion load(const float* src) {
+			return quaternion(src[0], src[1], src[2], src[3]);
+		}
+	};
+
+	// keyframe track, times and values are kept in separate arrays
+	template<typename T>
+	struct track
+	{
+		static const std::size_t components = track_traits<T>::components;
+
+		// interpolation mode
+		interpolation mode = interpolation::linear;
+
+		// key times, in increasing order
+		std::vector<float> times;
+
+		// key values, components floats per key
+		std::vector<float> values;
+
+		// incoming and outgoing tangents, components floats per key (cubic only)
+		std::vector<float> in_tangents;
+		std::vector<float> out_tangents;
+
+		// num of keys
+		std::size_t size() const {
+			return times.size();
+		}
+
+		// duration of the track
+		float duration() const {
+			return times.empty() ? 0.0f : times.back() - times.front();
+		}
+
+		// append a key, time must not be lower than the last key time
+		void add(const float time, const T& value) {
+			add(time, value, value, value);
+			// zero tangents
+			std::fill(in_tangents.end() - components, in_tangents.end(), 0.0f);
+			std::fill(out_tangents.end() - components, out_tangents.end(), 0.0f);
+		}
+
+		void add(const float time, const T& value, const T& in_tangent, const T& out_tangent) {
+			assert(times.empty() || time >= times.back());
+			times.push_back(time);
+			values.resize(values.size() + components);
+			in_tangents.resize(in_tangents.size() + components);
+			out_tangents.resize(out_tangents.size() + components);
+			track_traits<T>::store(value, &values[values.size() - components]);
+			track_traits<T>::store(in_tangent, &in_tangents[in_tangents.size() - components]);
+			track_traits<T>::store(out_tangent, &out_tangents[out_tangents.size() - components]);
+		}
+
+		// the i-th key value
+		T value(const std::size_t i) const {
+			return track_traits<T>::load(&values[i * components]);
+		}
+	};
+
+	// vector and rotation tracks
+	typedef track<float> float_track;
+	typedef track<vector2> vec2_track;
+	typedef track<vector3> vec3_track;
+	typedef track<vector4> vec4_track;
+	typedef track<quaternion> quaternion_track;
+
+	// playback state of a track: the key at or before the last sampled time.
+	// Sampling at increasing (or slightly decreasing) times reuses it, so
+	// sequential playback does not search the keys
+	struct track_cursor
+	{
+		std::size_t key = 0;
+	};
+
+	// index of the key at or before time, updating the cursor
+	inline std::size_t seek(const std::vector<float>& times, const float time, track_cursor& cursor) {
+		const std::size_t last = times.size() - 1;
+		std::size_t k = cursor.key < last ? cursor.key : last;
+		if (times[k] <= time) {
+			// same or next segment
+			if (k == last || time < times[k + 1])
+				return cursor.key = k;
+			if (k + 1 == last || time < times[k + 2])
+				return cursor.key = k + 1;
+		}
+		else if (k > 0 && times[k - 1] <= time) {
+			// previous segment
+			return cursor.key = k - 1;
+		}
+		// jump, binary search
+		const auto it = std::upper_bound(times.begin(), times.end(), time);
+		k = it == times.begin() ? 0 : static_cast<std::size_t>(it - times.begin()) - 1;
+		return cursor.key = k;
+	}
+
+	// sample a track at time, times out of range are clamped to the first and last key
+	template<typename T>
+	T sample(const track<T>& track, const float time, track_cursor& cursor) {
+		const std::size_t N = track_traits<T>::components;
+		assert(track.size() > 0);
+
+		const std::size_t k = seek(track.times, time, cursor);
+		const float* a = &track.values[k * N];
+		if (track.mode == interpolation::step || k + 1 == track.size() || time <= track.times[k])
+			return track_traits<T>::load(a);
+
+		const float* b = &track.values[(k + 1) * N];
+		const float dt = track.times[k + 1] - track.times[k];
+		const float t = (time - track.times[k]) / dt;
+
+		// blend along the shortest arc
+		float sign = 1.0f;
+		if (track_traits<T>::normalize) {
+			float d = 0.0f;
+			for (std::size_t i = 0; i < N; ++i)
+				d += a[i] * b[i];
+			sign = d < 0.0f ? -1.0f : 1.0f;
+		}
+
+		float result[N];
+		if (track.mode == interpolation::linear) {
+			for (std::size_t i = 0; i < N; ++i)
+				result[i] = lerp(a[i], sign * b[i], t);
+		}
+		else {
+			// cubic Hermite basis
+			const float t2 = t * t;
+			const float t3 = t2 * t;
+			const float h00 = 2.0f * t3 - 3.0f * t2 + 1.0f;
+			const float h10 = t3 - 2.0f * t2 + t;
+			const float h01 = -2.0f * t3 + 3.0f * t2;
+			const float h11 = t3 - t2;
+			const float* m0 = &track.out_tangents[k * N];
+			const float* m1 = &track.in_tangents[(k + 1) * N];
+			for (std::size_t i = 0; i < N; ++i)
+				result[i] = h00 * a[i] + h10 * dt * m0[i] + sign * (h01 * b[i] + h11 * dt * m1[i]);
+		}
+
+		if (track_traits<T>::normalize) {
+			float l = 0.0f;
+			for (std::size_t i = 0; i < N; ++i)
+				l += result[i] * result[i];
+			const float f = l > 0.0f ? 1.0f / std::sqrt(l) : 0.0f;
+			for (std::size_t i = 0; i < N; ++i)
+				result[i] *= f;
+		}
+		return track_traits<T>::load(result);
+	}
+
+	// sample count tracks at the same time, each with its own cursor
+	template<typename T>
+	void sample(const track<T>* tracks, track_cursor* cursors, T* results, const std::size_t count, const float time) {
+		for (std::size_t i = 0; i < count; ++i)
+			results[i] = sample(tracks[i], time, cursors[i]);
+	}
+};
\ No newline at end of file
@@ -0,0 +1,488 @@
+#pragma once
+
+/*
+	Binary container for arrays of math types
+	Vito Domenico Tagliente
+	math library for games
+*/
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "vector.h"
+#include "point.h"
+#include "matrix.h"
+#include "quaternion.h"
+
+#ifdef _WIN32
+// keep the min and max macros, and the rarely used apis, out of the
+// including code
+#ifndef NOMINMAX
+#define NOMINMAX
+#define MATH4GAMES_UNDEF_NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#define MATH4GAMES_UNDEF_WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#ifdef MATH4GAMES_UNDEF_NOMINMAX
+#undef NOMINMAX
+#undef MATH4GAMES_UNDEF_NOMINMAX
+#endif
+#ifdef MATH4GAMES_UNDEF_WIN32_LEAN_AND_MEAN
+#undef WIN32_LEAN_AND_MEAN
+#undef MATH4GAMES_UNDEF_WIN32_LEAN_AND_MEAN
+#endif
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace math4games
+{
+	/*
+		File layout, all values little endian:
+
+		offset	size	field
+		0		4		magic "M4GB"
+		4		4		version
+		8		1		element kind
+		9		1		scalar kind
+		10		1		rows (components for vectors, points and quaternions)
+		11		1		columns (1 for vectors, points and quaternions)
+		12		1		layout
+		13		3		reserved, zero
+		16		8		element count
+		24		8		data offset, from the start of the file
+
+		Data starts at a 64 byte aligned offset. Matrices are stored row major.
+		aos: the elements one after another
+		soa: one array of count scalars per component
+	*/
+
+	const std::uint32_t binary_version = 1;
+	const std::size_t binary_header_size = 32;
+	const std::size_t binary_data_alignment = 64;
+
+	enum class element_kind : std::uint8_t
+	{
+		vector = 0,
+		point = 1,
+		matrix = 2,
+		quaternion = 3
+	};
+
+	enum class scalar_kind : std::uint8_t
+	{
+		f32 = 0,
+		f64 = 1,
+		i32 = 2,
+		u32 = 3
+	};
+
+	enum class data_layout : std::uint8_t
+	{
+		aos = 0,
+		soa = 1
+	};
+
+	template<typename T>
+	struct scalar_traits;
+
+	template<> struct scalar_traits<float> { static const scalar_kind kind = scalar_kind::f32; };
+	template<> struct scalar_traits<double> { static const scalar_kind kind = scalar_kind::f64; };
+	template<> struct scalar_traits<int> { static const scalar_kind kind = scalar_kind::i32; };
+	template<> struct scalar_traits<unsigned int> { static const scalar_kind kind = scalar_kind::u32; };
+
+	// description of the stored array
+	struct binary_header
+	{
+		std::uint32_t version = binary_version;
+		element_kind element = element_kind::vector;
+		scalar_kind scalar = scalar_kind::f32;
+		std::uint8_t rows = 0;
+		std::uint8_t columns = 1;
+		data_layout layout = data_layout::aos;
+		std::uint64_t count = 0;
+		std::uint64_t offset = 0;
+
+		// scalars per element
+		std::size_t components() const {
+			return static_cast<std::size_t>(rows) * columns;
+		}
+	};
+
+	namespace detail
+	{
+		inline bool little_endian() {
+			const std::uint32_t one = 1;
+			unsigned char byte;
+			std::memcpy(&byte, &one, 1);
+			return byte == 1;
+		}
+
+		// little endian encoding of a value
+		template<typename T>
+		void put_le(unsigned char* dst, const T value) {
+			unsigned char bytes[sizeof(T)];
+			std::memcpy(bytes, &value, sizeof(T));
+			for (std::size_t i = 0; i < sizeof(T); ++i)
+				dst[i] = little_endian() ? bytes[i] : bytes[sizeof(T) - 1 - i];
+		}
+
+		template<typename T>
+		T get_le(const unsigned char* src) {
+			unsigned char bytes[sizeof(T)];
+			for (std::size_t i = 0; i < sizeof(T); ++i)
+				bytes[i] = little_endian() ? src[i] : src[sizeof(T) - 1 - i];
+			T value;
+			std::memcpy(&value, bytes, sizeof(T));
+			return value;
+		}
+
+		inline void encode_header(const binary_header& h, unsigned char* dst) {
+			std::memset(dst, 0, binary_header_size);
+			std::memcpy(dst, "M4GB", 4);
+			put_le(dst + 4, h.version);
+			dst[8] = static_cast<unsigned char>(h.element);
+			dst[9] = static_cast<unsigned char>(h.scalar);
+			dst[10] = h.rows;
+			dst[11] = h.columns;
+			dst[12] = static_cast<unsigned char>(h.layout);
+			put_le(dst + 16, h.count);
+			put_le(dst + 24, h.offset);
+		}
+
+		// false when the header is not a valid one of this version
+		inline bool decode_header(const unsigned char* src, binary_header& h) {
+			if (std::memcmp(src, "M4GB", 4) != 0)
+				return false;
+			if (src[8] > static_cast<unsigned char>(element_kind::quaternion) ||
+				src[9] > static_cast<unsigned char>(scalar_kind::u32) ||
+				src[12] > static_cast<unsigned char>(data_layout::soa) ||
+				src[13] != 0 || src[14] != 0 || src[15] != 0)
+				return false;
+			h.version = get_le<std::uint32_t>(src + 4);
+			h.element = static_cast<element_kind>(src[8]);
+			h.scalar = static_cast<scalar_kind>(src[9]);
+			h.rows = src[10];
+			h.columns = src[11];
+			h.layout = static_cast<data_layout>(src[12]);
+			h.count = get_le<std::uint64_t>(src + 16);
+			h.offset = get_le<std::uint64_t>(src + 24);
+			// only matrices have columns, quaternions have 4 components
+			if (h.rows == 0 || h.columns == 0 ||
+				(h.element != element_kind::matrix && h.columns != 1) ||
+				(h.element == element_kind::quaternion && (h.rows != 4 || h.scalar != scalar_kind::f32)))
+				return false;
+			return h.version == binary_version;
+		}
+
+		// write count elements of components scalars each, element k component c
+		// being read through get(k, c)
+		template<typename T, typename Getter>
+		bool write_binary(const char* path, binary_header h, const std::size_t count, Getter get) {
+			h.scalar = scalar_traits<T>::kind;
+			h.count = count;
+			h.offset = binary_data_alignment;
+
+			std::FILE* file = std::fopen(path, "wb");
+			if (file == nullptr)
+				return false;
+
+			unsigned char head[binary_data_alignment] = {};
+			encode_header(h, head);
+			bool ok = std::fwrite(head, 1, sizeof(head), file) == sizeof(head);
+
+			// encode in chunks
+			const std::size_t components = h.components();
+			const std::size_t chunk = 4096;
+			std::vector<unsigned char> buffer(chunk * sizeof(T));
+			std::size_t used = 0;
+			auto flush = [&]() {
+				ok = ok && std::fwrite(buffer.data(), 1, used, file) == used;
+				used = 0;
+			};
+			auto put = [&](const T value) {
+				put_le(&buffer[used], value);
+				used += sizeof(T);
+				if (used == buffer.size())
+					flush();
+			};
+			if (h.layout == data_layout::aos) {
+				for (std::size_t k = 0; k < count; ++k) {
+					for (std::size_t c = 0; c < components; ++c)
+						put(get(k, c));
+				}
+			}
+			else {
+				for (std::size_t c = 0; c < components; ++c) {
+					for (std::size_t k = 0; k < count; ++k)
+						put(get(k, c));
+				}
+			}
+			flush();
+			return std::fclose(file) == 0 && ok;
+		}
+
+		// arrays of the derived vector and point types (vec3, point3, ...),
+		// their size differs from the base one
+		template<std::size_t N, typename T, typename Element>
+		bool write_binary_named(const char* path, const element_kind element, const Element* data,
+			const std::size_t count, const data_layout layout) {
+			binary_header h;
+			h.element = element;
+			h.rows = static_cast<std::uint8_t>(N);
+			h.layout = layout;
+			return write_binary<T>(path, h, count,
+				[data](const std::size_t k, const std::size_t c) { return data[k][static_cast<unsigned int>(c)]; });
+		}
+	}
+
+	// write arrays of math types, return false on io errors
+	template<std::size_t N, typename T>
+	bool write_binary(const char* path, const base_vector<N, T>* data, const std::size_t count,
+		const data_layout layout = data_layout::aos) {
+		binary_header h;
+		h.element = element_kind::vector;
+		h.rows = static_cast<std::uint8_t>(N);
+		h.layout = layout;
+		return detail::write_binary<T>(path, h, count,
+			[data](const std::size_t k, const std::size_t c) { return data[k][static_cast<unsigned int>(c)]; });
+	}
+
+	template<typename T>
+	bool write_binary(const char* path, const base_vector2<T>* data, const std::size_t count,
+		const data_layout layout = data_layout::aos) {
+		return detail::write_binary_named<2, T>(path, element_kind::vector, data, count, layout);
+	}
+
+	template<typename T>
+	bool write_binary(const char* path, const base_vector3<T>* data, const std::size_t count,
+		const data_layout layout = data_layout::aos) {
+		return detail::write_binary_named<3, T>(path, element_kind::vector, data, count, layout);
+	}
+
+	template<typename T>
+	bool write_binary(const char* path, const base_vector4<T>* data, const std::size_t count,
+		const data_layout layout = data_layout::aos) {
+		return detail::write_binary_named<4, T>(path, element_kind::vector, data, count, layout);
+	}
+
+	template<typename T>
+	bool write_binary(const char* path, const base_point2<T>* data, const std::size_t count,
+		const data_layout layout = data_layout::aos) {
+		return detail::write_binary_named<2, T>(path, element_kind::point, data, count, layout);
+	}
+
+	template<typename T>
+	bool write_binary(const char* path, const base_point3<T>* data, const std::size_t count,
+		const data_layout layout = data_layout::aos) {
+		return detail::write_binary_named<3, T>(path, element_kind::point, data, count, layout);
+	}
+
+	template<std::size_t N, typename T>
+	bool write_binary(const char* path, const base_point<N, T>* data, const std::size_t count,
+		const data_layout layout = data_layout::aos) {
+		binary_header h;
+		h.element = element_kind::point;
+		h.rows = static_cast<std::uint8_t>(N);
+		h.layout = layout;
+		return detail::write_binary<T>(path, h, count,
+			[data](const std::size_t k, const std::size_t c) { return data[k][static_cast<unsigned int>(c)]; });
+	}
+
+	template<std::size_t N, std::size_t M, typename T>
+	bool write_binary(const char* path, const base_matrix<N, M, T>* data, const std::size_t count,
+		const data_layout layout = data_layout::aos) {
+		binary_header h;
+		h.element = element_kind::matrix;
+		h.rows = static_cast<std::uint8_t>(N);
+		h.columns = static_cast<std::uint8_t>(M);
+		h.layout = layout;
+		return detail::write_binary<T>(path, h, count,
+			[data](const std::size_t k, const std::size_t c) { return data[k].data[c]; });
+	}
+
+	inline bool write_binary(const char* path, const quaternion* data, const std::size_t count,
+		const data_layout layout = data_layout::aos) {
+		binary_header h;
+		h.element = element_kind::quaternion;
+		h.rows = 4;
+		h.layout = layout;
+		return detail::write_binary<float>(path, h, count,
+			[data](const std::size_t k, const std::size_t c) { return c < 3 ? data[k].v[static_cast<unsigned int>(c)] : data[k].w; });
+	}
+
+	// read only typed view over the mapped data, no copies
+	template<typename T>
+	struct binary_view
+	{
+		const T* data = nullptr;
+		std::size_t count = 0;
+		std::size_t components = 0;
+		data_layout layout = data_layout::aos;
+
+		// component c of the k-th element
+		T operator() (const std::size_t k, const std::size_t c) const {
+			return layout == data_layout::aos ? data[k * components + c] : data[c * count + k];
+		}
+
+		// contiguous array of the c-th components (soa only)
+		const T* component(const std::size_t c) const {
+			assert(layout == data_layout::soa);
+			return data + c * count;
+		}
+
+		// contiguous scalars of the k-th element (aos only)
+		const T* element(const std::size_t k) const {
+			assert(layout == data_layout::aos);
+			return data + k * components;
+		}
+
+		// gather the k-th element as a math type
+		template<std::size_t N>
+		base_vector<N, T> vector(const std::size_t k) const {
+			base_vector<N, T> v;
+			for (unsigned int c = 0; c < N && c < components; ++c)
+				v[c] = (*this)(k, c);
+			return v;
+		}
+
+		template<std::size_t N, std::size_t M>
+		base_matrix<N, M, T> matrix(const std::size_t k) const {
+			base_matrix<N, M, T> m;
+			for (unsigned int c = 0; c < N * M && c < components; ++c)
+				m.data[c] = (*this)(k, c);
+			return m;
+		}
+
+		quaternion rotation(const std::size_t k) const {
+			return quaternion((*this)(k, 0), (*this)(k, 1), (*this)(k, 2), (*this)(k, 3));
+		}
+	};
+
+	// memory mapped binary file, the views stay valid while the file is open
+	struct binary_file
+	{
+		binary_file() = default;
+
+		binary_file(const char* path) {
+			open(path);
+		}
+
+		~binary_file() {
+			close();
+		}
+
+		binary_file(const binary_file&) = delete;
+		binary_file& operator= (const binary_file&) = delete;
+
+		// map the file and validate its header
+		bool open(const char* path) {
+			close();
+			// data is exposed as is, so the host must match the file byte order
+			if (!detail::little_endian())
+				return false;
+#ifdef _WIN32
+			m_file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (m_file == INVALID_HANDLE_VALUE)
+				return false;
+			LARGE_INTEGER size;
+			if (!GetFileSizeEx(m_file, &size) || size.QuadPart < static_cast<LONGLONG>(binary_header_size)) {
+				close();
+				return false;
+			}
+			m_size = static_cast<std::size_t>(size.QuadPart);
+			m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (m_mapping == nullptr) {
+				close();
+				return false;
+			}
+			m_data = static_cast<const unsigned char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+			const int fd = ::open(path, O_RDONLY);
+			if (fd < 0)
+				return false;
+			struct stat info;
+			if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(binary_header_size)) {
+				::close(fd);
+				return false;
+			}
+			m_size = static_cast<std::size_t>(info.st_size);
+			void* p = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+			::close(fd);
+			m_data = p == MAP_FAILED ? nullptr : static_cast<const unsigned char*>(p);
+#endif
+			if (m_data == nullptr) {
+				close();
+				return false;
+			}
+
+			const std::size_t scalar_size = m_data[9] == static_cast<unsigned char>(scalar_kind::f64) ? 8 : 4;
+			if (!detail::decode_header(m_data, m_header) ||
+				// the data can not overlap the header
+				m_header.offset < binary_data_alignment ||
+				m_header.offset % binary_data_alignment != 0 ||
+				m_header.offset > m_size ||
+				(m_size - m_header.offset) / scalar_size / (m_header.components() ? m_header.components() : 1) < m_header.count) {
+				close();
+				return false;
+			}
+			return true;
+		}
+
+		void close() {
+#ifdef _WIN32
+			if (m_data != nullptr)
+				UnmapViewOfFile(m_data);
+			if (m_mapping != nullptr)
+				CloseHandle(m_mapping);
+			if (m_file != INVALID_HANDLE_VALUE)
+				CloseHandle(m_file);
+			m_mapping = nullptr;
+			m_file = INVALID_HANDLE_VALUE;
+#else
+			if (m_data != nullptr)
+				munmap(const_cast<unsigned char*>(m_data), m_size);
+#endif
+			m_data = nullptr;
+			m_size = 0;
+			m_header = binary_header();
+		}
+
+		bool is_open() const {
+			return m_data != nullptr;
+		}
+
+		const binary_header& header() const {
+			return m_header;
+		}
+
+		// typed view, empty if T does not match the stored scalar type
+		template<typename T>
+		binary_view<T> view() const {
+			binary_view<T> v;
+			if (!is_open() || m_header.scalar != scalar_traits<T>::kind)
+				return v;
+			v.data = reinterpret_cast<const T*>(m_data + m_header.offset);
+			v.count = static_cast<std::size_t>(m_header.count);
+			v.components = m_header.components();
+			v.layout = m_header.layout;
+			return v;
+		}
+
+	private:
+		const unsigned char* m_data = nullptr;
+		std::size_t m_size = 0;
+		binary_header m_header;
+#ifdef _WIN32
+		HANDLE m_file = INVALID_HANDLE_VALUE;
+		HANDLE m_mapping = nullptr;
+#endif
+	};
+};
\ No newline at end of file
@@ -0,0 +1,481 @@
+#pragma once
+
+/*
+	Bulk math functions
+	Vito Domenico Tagliente
+	math library for games
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include "common.h"
+
+namespace math4games
+{
+	// error of the bulk functions: precise within a few ulps of the
+	// correctly rounded result, fast within a relative error of 1e-4
+	enum class accuracy
+	{
+		precise,
+		fast
+	};
+
+	namespace detail
+	{
+		const std::size_t bulk_lanes = 64;
+		typedef float bulk_block[bulk_lanes];
+
+		// adding and subtracting 1.5 * 2^23 rounds to the nearest integer
+		const float round_magic = 12582912.0f;
+		const float two_over_pi = 0.63661977f;
+		const float log2e = 1.44269504f;
+		const float sqrt2 = 1.41421356f;
+
+		// pi / 2 and ln 2 split so that the first parts times the integers
+		// of the reductions are exact, pi / 2 from the halved parts of pi
+		// in SLEEF and ln 2 from Cephes
+		const float pio2_1 = 1.5703125f;
+		const float pio2_2 = 4.8351287841796875e-4f;
+		const float pio2_3 = 3.1385570764541625977e-7f;
+		const float pio2_4 = 6.077100628276710381e-11f;
+		const float ln2_1 = 0.693359375f;
+		const float ln2_2 = -2.12194440e-4f;
+
+		// largest argument reduced without loss, bigger ones go to <cmath>
+		const float trig_limit = 8192.0f;
+
+		inline std::uint32_t float_bits(const float x) {
+			std::uint32_t i;
+			std::memcpy(&i, &x, sizeof(i));
+			return i;
+		}
+
+		inline float bits_float(const std::uint32_t i) {
+			float x;
+			std::memcpy(&x, &i, sizeof(x));
+			return x;
+		}
+
+		// c ? a : b through bit masks, ternaries whose arms are computed
+		// become branches that stop the vectorizer
+		inline float select(const bool c, const float a, const float b) {
+			const std::uint32_t m = 0u - static_cast<std::uint32_t>(c);
+			return bits_float((float_bits(a) & m) | (float_bits(b) & ~m));
+		}
+
+		inline bool is_normal_positive(const float x) {
+			return (x >= std::numeric_limits<float>::min()) & (x <= std::numeric_limits<float>::max());
+		}
+
+		/*
+			The kernels evaluate a block of lanes without data dependent
+			branches, writing to local blocks that the compiler knows are
+			not aliased by the inputs, so that it vectorizes them. Arguments
+			outside of the reduced domain get garbage that the public
+			functions replace with the <cmath> result. The inputs are copied
+			to local blocks first, so results may alias them.
+		*/
+
+		template<typename Kernel>
+		void bulk_map(const float* x, float* result, const std::size_t count, Kernel kernel) {
+			bulk_block a = {}, r;
+			for (std::size_t first = 0; first < count; first += bulk_lanes) {
+				const std::size_t n = std::min(bulk_lanes, count - first);
+				std::copy(x + first, x + first + n, a);
+				kernel(a, r, n);
+				std::copy(r, r + n, result + first);
+			}
+		}
+
+		template<typename Kernel>
+		void bulk_map(const float* x, const float* y, float* result, const std::size_t count, Kernel kernel) {
+			bulk_block a = {}, b = {}, r;
+			for (std::size_t first = 0; first < count; first += bulk_lanes) {
+				const std::size_t n = std::min(bulk_lanes, count - first);
+				std::copy(x + first, x + first + n, a);
+				std::copy(y + first, y + first + n, b);
+				kernel(a, b, r, n);
+				std::copy(r, r + n, result + first);
+			}
+		}
+
+		template<typename Kernel>
+		void bulk_map(const float* x, const float* y, const float* z, float* result, const std::size_t count, Kernel kernel) {
+			bulk_block a = {}, b = {}, c = {}, r;
+			for (std::size_t first = 0; first < count; first += bulk_lanes) {
+				const std::size_t n = std::min(bulk_lanes, count - first);
+				std::copy(x + first, x + first + n, a);
+				std::copy(y + first, y + first + n, b);
+				std::copy(z + first, z + first + n, c);
+				kernel(a, b, c, r, n);
+				std::copy(r, r + n, result + first);
+			}
+		}
+
+		// calls fix on the lanes of [0, n) that are not inside the domain of
+		// a kernel, after a vectorized check that there is any
+		template<typename Inside, typename Fix>
+		void bulk_fallback(const std::size_t n, Inside inside, Fix fix) {
+			std::uint32_t outside = 0;
+			for (std::size_t k = 0; k < bulk_lanes; ++k)
+				outside |= inside(k) ? 0u : 1u;
+			if (outside != 0)
+				for (std::size_t k = 0; k < n; ++k)
+					if (!inside(k))
+						fix(k);
+		}
+
+		// 1 / sqrt(x) for normal positive x, bit trick estimate refined by
+		// two Newton steps to a relative error of 5e-6
+		inline void rsqrt_estimate(const bulk_block& x, bulk_block& result) {
+			bulk_block t;
+			for (std::size_t k = 0; k < bulk_lanes; ++k) {
+				const float h = 0.5f * x[k];
+				float y = bits_float(0x5f375a86u - (float_bits(x[k]) >> 1));
+				y = y * (1.5f - h * y * y);
+				t[k] = y * (1.5f - h * y * y);
+			}
+			std::copy(t, t + bulk_lanes, result);
+		}
+
+		template<accuracy A>
+		void rsqrt_lanes(const bulk_block& x, bulk_block& result) {
+			bulk_block t;
+			rsqrt_estimate(x, t);
+			if (A == accuracy::precise)
+				for (std::size_t k = 0; k < bulk_lanes; ++k)
+					t[k] = t[k] * (1.5f - 0.5f * x[k] * t[k] * t[k]);
+			std::copy(t, t + bulk_lanes, result);
+		}
+
+		// sqrt(x) = x / sqrt(x), the precise tier corrects it with the
+		// residual x - s * s
+		template<accuracy A>
+		void sqrt_lanes(const bulk_block& x, bulk_block& result) {
+			bulk_block t;
+			rsqrt_estimate(x, t);
+			for (std::size_t k = 0; k < bulk_lanes; ++k) {
+				const float s = x[k] * t[k];
+				t[k] = A == accuracy::precise ? s + 0.5f * t[k] * (x[k] - s * s) : s;
+			}
+			std::copy(t, t + bulk_lanes, result);
+		}
+
+		// r in [-pi / 4, pi / 4], sin and cos of r are swapped and negated
+		// by the quadrant q
+		template<accuracy A>
+		void sincos_lanes(const bulk_block& x, bulk_block& sin, bulk_block& cos) {
+			bulk_block s, c;
+			for (std::size_t k = 0; k < bulk_lanes; ++k) {
+				const float q = (x[k] * two_over_pi + round_magic) - round_magic;
+				const float r = (((x[k] - q * pio2_1) - q * pio2_2) - q * pio2_3) - q * pio2_4;
+				const float z = r * r;
+				float ps, pc;
+				if (A == accuracy::precise) {
+					// Cephes sinf and cosf
+					ps = r + r * z * ((-1.9515295891e-4f * z + 8.3321608736e-3f) * z - 1.6666654611e-1f);
+					pc = 1.0f - 0.5f * z + z * z * ((2.443315711809948e-5f * z - 1.388731625493765e-3f) * z + 4.166664568298827e-2f);
+				}
+				else {
+					ps = r * ((8.150056557e-3f * z - 1.666238231e-1f) * z + 9.999984929e-1f);
+					pc = (4.036229394e-2f * z - 4.996854847e-1f) * z + 9.999882169e-1f;
+				}
+				const std::uint32_t j = static_cast<std::uint32_t>(static_cast<std::int32_t>(q));
+				const bool odd = (j & 1u) != 0;
+				s[k] = bits_float(float_bits(select(odd, pc, ps)) ^ ((j & 2u) << 30));
+				c[k] = bits_float(float_bits(select(odd, ps, pc)) ^ (((j + 1u) & 2u) << 30));
+			}
+			std::copy(s, s + bulk_lanes, sin);
+			std::copy(c, c + bulk_lanes, cos);
+		}
+
+		template<accuracy A>
+		void tan_lanes(const bulk_block& x, bulk_block& result) {
+			bulk_block t;
+			for (std::size_t k = 0; k < bulk_lanes; ++k) {
+				const float q = (x[k] * two_over_pi + round_magic) - round_magic;
+				const float r = (((x[k] - q * pio2_1) - q * pio2_2) - q * pio2_3) - q * pio2_4;
+				const float z = r * r;
+				float p;
+				if (A == accuracy::precise) {
+					// Cephes tanf
+					p = r + r * z * (((((9.38540185543e-3f * z + 3.11992232697e-3f) * z + 2.44301354525e-2f) * z
+						+ 5.34112807005e-2f) * z + 1.33387994085e-1f) * z + 3.33331568548e-1f);
+				}
+				else
+					p = r * (((9.413058338e-2f * z + 1.159758698e-1f) * z + 3.355828757e-1f) * z + 9.999558550e-1f);
+				// tan(r + pi / 2) = -1 / tan(r)
+				const float u = -1.0f / p;
+				t[k] = select((static_cast<std::int32_t>(q) & 1) != 0, u, p);
+			}
+			std::copy(t, t + bulk_lanes, result);
+		}
+
+		// the ratio of the smaller and the larger of |y| and |x| is in
+		// [0, 1], its atan is then reflected into the octant of (x, y)
+		template<accuracy A>
+		void atan2_lanes(const bulk_block& y, const bulk_block& x, bulk_block& result) {
+			bulk_block t;
+			for (std::size_t k = 0; k < bulk_lanes; ++k) {
+				const float ax = std::fabs(x[k]), ay = std::fabs(y[k]);
+				const float a = std::min(ax, ay) / std::max(ax, ay);
+				float r;
+				if (A == accuracy::precise) {
+					// Cephes atanf, above tan(pi / 8) atan(a) = pi / 4 + atan((a - 1) / (a + 1))
+					const bool big = a > 0.41421356f;
+					const float v = select(big, (a - 1.0f) / (a + 1.0f), a);
+					const float offset = big ? 0.25f * pi : 0.0f;
+					const float z = v * v;
+					r = offset + (v + v * z * (((8.05374449538e-2f * z - 1.38776856032e-1f) * z + 1.99777106478e-1f) * z - 3.33329491539e-1f));
+				}
+				else {
+					const float z = a * a;
+					r = a * ((((2.386340751e-2f * z - 9.192657897e-2f) * z + 1.852156763e-1f) * z - 3.317008401e-1f) * z + 9.999700339e-1f);
+				}
+				r = select(ay > ax, 0.5f * pi - r, r);
+				r = select(x[k] < 0.0f, pi - r, r);
+				t[k] = bits_float(float_bits(r) | (float_bits(y[k]) & 0x80000000u));
+			}
+			std::copy(t, t + bulk_lanes, result);
+		}
+
+		template<accuracy A>
+		void acos_lanes(const bulk_block& x, bulk_block& result) {
+			bulk_block w, s;
+			for (std::size_t k = 0; k < bulk_lanes; ++k)
+				w[k] = A == accuracy::precise ? 0.5f * (1.0f - std::fabs(x[k])) : 1.0f - std::fabs(x[k]);
+			// w is in [0, 1], the estimate of sqrt(0) is 0
+			sqrt_lanes<A>(w, s);
+			for (std::size_t k = 0; k < bulk_lanes; ++k) {
+				const float a = std::fabs(x[k]);
+				float r;
+				if (A == accuracy::precise) {
+					// Cephes asinf: acos(a) = 2 asin(sqrt((1 - a) / 2)) above 1 / 2,
+					// pi / 2 - asin(a) below
+					const bool big = a > 0.5f;
+					const float z = select(big, w[k], a * a);
+					const float v = select(big, s[k], a);
+					const float p = v + v * z * ((((4.2163199048e-2f * z + 2.4181311049e-2f) * z + 4.5470025998e-2f) * z
+						+ 7.4953002686e-2f) * z + 1.6666752422e-1f);
+					r = select(big, 2.0f * p, 0.5f * pi - p);
+				}
+				else
+					r = s[k] * (((-1.861649622e-2f * a + 7.409335555e-2f) * a - 2.120525554e-1f) * a + 1.570725419f);
+				w[k] = select(x[k] < 0.0f, pi - r, r);
+			}
+			std::copy(w, w + bulk_lanes, result);
+		}
+
+		// |r| <= ln 2 / 2, exp(x) = 2^n exp(r) for x in [-87, 88] where 2^n
+		// is a normal float
+		template<accuracy A>
+		void exp_lanes(const bulk_block& x, bulk_block& result) {
+			bulk_block t;
+			for (std::size_t k = 0; k < bulk_lanes; ++k) {
+				const float n = (x[k] * log2e + round_magic) - round_magic;
+				const float r = (x[k] - n * ln2_1) - n * ln2_2;
+				float p;
+				if (A == accuracy::precise) {
+					// Cephes expf
+					p = (((((1.9875691500e-4f * r + 1.3981999507e-3f) * r + 8.3334519073e-3f) * r + 4.1665795894e-2f) * r
+						+ 1.6666665459e-1f) * r + 5.0000001201e-1f) * r * r + r + 1.0f;
+				}
+				else
+					p = (((4.145860819e-2f * r + 1.679090722e-1f) * r + 5.000435866e-1f) * r + 9.999634049e-1f) * r + 9.999992614e-1f;
+				const std::uint32_t e = static_cast<std::uint32_t>(static_cast<std::int32_t>(n) + 127);
+				t[k] = p * bits_float(e << 23);
+			}
+			std::copy(t, t + bulk_lanes, result);
+		}
+
+		// x = 2^e m with m in [sqrt(2) / 2, sqrt(2)], log(x) = e ln 2 + log(m)
+		// for normal positive x
+		template<accuracy A>
+		void log_lanes(const bulk_block& x, bulk_block& result) {
+			bulk_block t;
+			for (std::size_t k = 0; k < bulk_lanes; ++k) {
+				const std::uint32_t i = float_bits(x[k]);
+				const float m = bits_float((i & 0x007fffffu) | 0x3f800000u);
+				const bool big = m > sqrt2;
+				const float f = select(big, 0.5f * m, m) - 1.0f;
+				const float e = static_cast<float>(static_cast<std::int32_t>(i >> 23) - 127) + (big ? 1.0f : 0.0f);
+				if (A == accuracy::precise) {
+					// Cephes logf
+					const float z = f * f;
+					float y = f * z * ((((((((7.0376836292e-2f * f - 1.1514610310e-1f) * f + 1.1676998740e-1f) * f
+						- 1.2420140846e-1f) * f + 1.4249322787e-1f) * f - 1.6668057665e-1f) * f + 2.0000714765e-1f) * f
+						- 2.4999993993e-1f) * f + 3.3333331174e-1f);
+					y += e * ln2_2;
+					y -= 0.5f * z;
+					t[k] = (f + y) + e * ln2_1;
+				}
+				else
+					t[k] = f * ((((1.765805420e-1f * f - 2.709459943e-1f) * f + 3.363888424e-1f) * f - 4.994506475e-1f) * f
+						+ 9.999661814e-1f) + e * 0.69314718f;
+			}
+			std::copy(t, t + bulk_lanes, result);
+		}
+	};
+
+	/*
+		Span versions of <cmath> and of the common operations, over count
+		floats. result may be the input itself. The precise functions are
+		within a few ulps of <cmath> and the fast ones within a relative
+		error of 1e-4, arguments outside of the range of the vectorized
+		kernels (huge angles, non finite values, denormals, exp overflow)
+		are evaluated by <cmath>.
+	*/
+	namespace bulk
+	{
+		template<accuracy A = accuracy::precise>
+		void sin(const float* x, float* result, const std::size_t count) {
+			detail::bulk_map(x, result, count, [](const detail::bulk_block& a, detail::bulk_block& r, const std::size_t n) {
+				detail::bulk_block c;
+				detail::sincos_lanes<A>(a, r, c);
+				detail::bulk_fallback(n, [&](const std::size_t k) { return std::fabs(a[k]) <= detail::trig_limit; },
+					[&](const std::size_t k) { r[k] = std::sin(a[k]); });
+			});
+		}
+
+		template<accuracy A = accuracy::precise>
+		void cos(const float* x, float* result, const std::size_t count) {
+			detail::bulk_map(x, result, count, [](const detail::bulk_block& a, detail::bulk_block& r, const std::size_t n) {
+				detail::bulk_block s;
+				detail::sincos_lanes<A>(a, s, r);
+				detail::bulk_fallback(n, [&](const std::size_t k) { return std::fabs(a[k]) <= detail::trig_limit; },
+					[&](const std::size_t k) { r[k] = std::cos(a[k]); });
+			});
+		}
+
+		template<accuracy A = accuracy::precise>
+		void sincos(const float* x, float* sin, float* cos, const std::size_t count) {
+			detail::bulk_block a = {}, s, c;
+			for (std::size_t first = 0; first < count; first += detail::bulk_lanes) {
+				const std::size_t n = std::min(detail::bulk_lanes, count - first);
+				std::copy(x + first, x + first + n, a);
+				detail::sincos_lanes<A>(a, s, c);
+				detail::bulk_fallback(n, [&](const std::size_t k) { return std::fabs(a[k]) <= detail::trig_limit; },
+					[&](const std::size_t k) {
+						s[k] = std::sin(a[k]);
+						c[k] = std::cos(a[k]);
+					});
+				std::copy(s, s + n, sin + first);
+				std::copy(c, c + n, cos + first);
+			}
+		}
+
+		template<accuracy A = accuracy::precise>
+		void tan(const float* x, float* result, const std::size_t count) {
+			detail::bulk_map(x, result, count, [](const detail::bulk_block& a, detail::bulk_block& r, const std::size_t n) {
+				detail::tan_lanes<A>(a, r);
+				detail::bulk_fallback(n, [&](const std::size_t k) { return std::fabs(a[k]) <= detail::trig_limit; },
+					[&](const std::size_t k) { r[k] = std::tan(a[k]); });
+			});
+		}
+
+		// zeros and infinities go to <cmath>, for its signed results
+		template<accuracy A = accuracy::precise>
+		void atan2(const float* y, const float* x, float* result, const std::size_t count) {
+			detail::bulk_map(y, x, result, count, [](const detail::bulk_block& a, const detail::bulk_block& b, detail::bulk_block& r, const std::size_t n) {
+				detail::atan2_lanes<A>(a, b, r);
+				detail::bulk_fallback(n, [&](const std::size_t k) {
+						const float m = std::max(std::fabs(a[k]), std::fabs(b[k]));
+						return (m > 0.0f) & (m <= std::numeric_limits<float>::max());
+					},
+					[&](const std::size_t k) { r[k] = std::atan2(a[k], b[k]); });
+			});
+		}
+
+		template<accuracy A = accuracy::precise>
+		void acos(const float* x, float* result, const std::size_t count) {
+			detail::bulk_map(x, result, count, [](const detail::bulk_block& a, detail::bulk_block& r, const std::size_t n) {
+				detail::acos_lanes<A>(a, r);
+				detail::bulk_fallback(n, [&](const std::size_t k) { return std::fabs(a[k]) <= 1.0f; },
+					[&](const std::size_t k) { r[k] = std::acos(a[k]); });
+			});
+		}
+
+		template<accuracy A = accuracy::precise>
+		void exp(const float* x, float* result, const std::size_t count) {
+			detail::bulk_map(x, result, count, [](const detail::bulk_block& a, detail::bulk_block& r, const std::size_t n) {
+				detail::exp_lanes<A>(a, r);
+				detail::bulk_fallback(n, [&](const std::size_t k) { return (a[k] >= -87.0f) & (a[k] <= 88.0f); },
+					[&](const std::size_t k) { r[k] = std::exp(a[k]); });
+			});
+		}
+
+		template<accuracy A = accuracy::precise>
+		void log(const float* x, float* result, const std::size_t count) {
+			detail::bulk_map(x, result, count, [](const detail::bulk_block& a, detail::bulk_block& r, const std::size_t n) {
+				detail::log_lanes<A>(a, r);
+				detail::bulk_fallback(n, [&](const std::size_t k) { return detail::is_normal_positive(a[k]); },
+					[&](const std::size_t k) { r[k] = std::log(a[k]); });
+			});
+		}
+
+		template<accuracy A = accuracy::precise>
+		void sqrt(const float* x, float* result, const std::size_t count) {
+			detail::bulk_map(x, result, count, [](const detail::bulk_block& a, detail::bulk_block& r, const std::size_t n) {
+				detail::sqrt_lanes<A>(a, r);
+				detail::bulk_fallback(n, [&](const std::size_t k) { return detail::is_normal_positive(a[k]); },
+					[&](const std::size_t k) { r[k] = std::sqrt(a[k]); });
+			});
+		}
+
+		template<accuracy A = accuracy::precise>
+		void rsqrt(const float* x, float* result, const std::size_t count) {
+			detail::bulk_map(x, result, count, [](const detail::bulk_block& a, detail::bulk_block& r, const std::size_t n) {
+				detail::rsqrt_lanes<A>(a, r);
+				detail::bulk_fallback(n, [&](const std::size_t k) { return detail::is_normal_positive(a[k]); },
+					[&](const std::size_t k) { r[k] = 1.0f / std::sqrt(a[k]); });
+			});
+		}
+
+		// degrees to radians
+		inline void radians(const float* x, float* result, const std::size_t count) {
+			detail::bulk_map(x, result, count, [](const detail::bulk_block& a, detail::bulk_block& r, const std::size_t) {
+				for (std::size_t k = 0; k < detail::bulk_lanes; ++k)
+					r[k] = a[k] * deg2rad_factor;
+			});
+		}
+
+		// radians to degrees
+		inline void degrees(const float* x, float* result, const std::size_t count) {
+			detail::bulk_map(x, result, count, [](const detail::bulk_block& a, detail::bulk_block& r, const std::size_t) {
+				for (std::size_t k = 0; k < detail::bulk_lanes; ++k)
+					r[k] = a[k] * rad2deg_factor;
+			});
+		}
+
+		inline void lerp(const float* a, const float* b, const float t, float* result, const std::size_t count) {
+			detail::bulk_map(a, b, result, count, [t](const detail::bulk_block& x, const detail::bulk_block& y, detail::bulk_block& r, const std::size_t) {
+				for (std::size_t k = 0; k < detail::bulk_lanes; ++k)
+					r[k] = (1.0f - t) * x[k] + y[k] * t;
+			});
+		}
+
+		// per element parameters
+		inline void lerp(const float* a, const float* b, const float* t, float* result, const std::size_t count) {
+			detail::bulk_map(a, b, t, result, count, [](const detail::bulk_block& x, const detail::bulk_block& y, const detail::bulk_block& u,
+				detail::bulk_block& r, const std::size_t) {
+				for (std::size_t k = 0; k < detail::bulk_lanes; ++k)
+					r[k] = (1.0f - u[k]) * x[k] + y[k] * u[k];
+			});
+		}
+
+		inline void clamp(const float* x, const float min, const float max, float* result, const std::size_t count) {
+			detail::bulk_map(x, result, count, [min, max](const detail::bulk_block& a, detail::bulk_block& r, const std::size_t) {
+				// ternaries on values, std::min and std::max return references
+				// that become branches
+				for (std::size_t k = 0; k < detail::bulk_lanes; ++k) {
+					const float v = a[k] < max ? a[k] : max;
+					r[k] = v > min ? v : min;
+				}
+			});
+		}
+	};
+};
\ No newline at end of file
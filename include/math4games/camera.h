@@ -0,0 +1,244 @@
+#pragma once
+
+/*
+	Camera
+	Vito Domenico Tagliente
+	math library for games
+*/
+
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include "vector.h"
+#include "matrix.h"
+#include "transformation.h"
+#include "sweep.h"
+
+namespace math4games
+{
+	// volume seen by a camera: left, right, bottom, top, near and far
+	// planes, the inside is in front of all of them. An infinite far plane
+	// has a null normal and is always in front
+	struct frustum
+	{
+		plane planes[6];
+
+		bool contains(const vec3& p) const {
+			for (unsigned int i = 0; i < 6; ++i)
+				if (planes[i].signed_distance(p) < 0.0f)
+					return false;
+			return true;
+		}
+
+		// conservative: boxes and spheres near the edges may pass
+		bool intersects(const aabb& box) const {
+			for (unsigned int i = 0; i < 6; ++i)
+				if (planes[i].signed_distance(box.support(planes[i].normal)) < 0.0f)
+					return false;
+			return true;
+		}
+
+		bool intersects(const vec3& center, const float radius) const {
+			for (unsigned int i = 0; i < 6; ++i)
+				if (planes[i].signed_distance(center) < -radius)
+					return false;
+			return true;
+		}
+	};
+
+	/*
+		Camera caching its matrices. View and projection, with their closed
+		form inverses, are computed when set; view projection, its inverse
+		and the frustum lazily on the first read after a change. The view
+		is rigid, the camera looks down -z, standard projections map depth
+		to [-1, 1] and reverse z ones to [0, 1] with the near plane at 1
+	*/
+	struct camera
+	{
+		camera() {
+			set_perspective(1.0471975f, 1.0f, 0.1f, 1000.0f);
+		}
+
+		// view
+
+		void look_at(const base_vector<3, float>& eye, const base_vector<3, float>& target,
+			const base_vector<3, float>& up = base_vector<3, float>({ 0.0f, 1.0f, 0.0f })) {
+			set_view(math4games::look_at(eye, target, up));
+		}
+
+		// rigid world to camera transform
+		void set_view(const base_matrix<4, 4, float>& view) {
+			m_view = view;
+			// inverse = [R^T | -R^T t]
+			const float* v = m_view.data.data();
+			float* w = m_inverse_view.data.data();
+			for (unsigned int i = 0; i < 3; ++i) {
+				for (unsigned int j = 0; j < 3; ++j)
+					w[i * 4 + j] = v[j * 4 + i];
+				w[i * 4 + 3] = -(v[i] * v[3] + v[4 + i] * v[7] + v[8 + i] * v[11]);
+			}
+			w[12] = w[13] = w[14] = 0.0f;
+			w[15] = 1.0f;
+			m_dirty = all_dirty;
+		}
+
+		// projection
+
+		// fov in radians, an infinite far plane removes the far clipping
+		void set_perspective(const float fov, const float aspect, const float near_plane,
+			const float far_plane = std::numeric_limits<float>::infinity(), const bool reverse_z = false) {
+			const bool infinite = std::isinf(far_plane);
+			if (reverse_z)
+				m_projection = infinite ? perspective_infinite_reverse_z(fov, aspect, near_plane)
+					: perspective_reverse_z(fov, aspect, near_plane, far_plane);
+			else
+				m_projection = infinite ? perspective_infinite(fov, aspect, near_plane)
+					: perspective(fov, aspect, near_plane, far_plane);
+			m_perspective = true;
+			m_reverse_z = reverse_z;
+			invert_projection();
+		}
+
+		// change the aspect ratio of a perspective projection, without a tan
+		void set_aspect(const float aspect) {
+			assert(m_perspective);
+			m_projection.data[0] = m_projection.data[5] / aspect;
+			invert_projection();
+		}
+
+		void set_orthographic(const float left, const float right, const float bottom, const float top,
+			const float near_plane, const float far_plane) {
+			m_projection = orthographic(left, right, bottom, top, near_plane, far_plane);
+			m_perspective = false;
+			m_reverse_z = false;
+			invert_projection();
+		}
+
+		// cached matrices
+
+		const base_matrix<4, 4, float>& view() const {
+			return m_view;
+		}
+
+		const base_matrix<4, 4, float>& inverse_view() const {
+			return m_inverse_view;
+		}
+
+		const base_matrix<4, 4, float>& projection() const {
+			return m_projection;
+		}
+
+		const base_matrix<4, 4, float>& inverse_projection() const {
+			return m_inverse_projection;
+		}
+
+		const base_matrix<4, 4, float>& view_projection() const {
+			if (m_dirty & view_projection_dirty) {
+				m_view_projection = m_projection * m_view;
+				m_dirty &= ~view_projection_dirty;
+			}
+			return m_view_projection;
+		}
+
+		const base_matrix<4, 4, float>& inverse_view_projection() const {
+			if (m_dirty & inverse_view_projection_dirty) {
+				m_inverse_view_projection = m_inverse_view * m_inverse_projection;
+				m_dirty &= ~inverse_view_projection_dirty;
+			}
+			return m_inverse_view_projection;
+		}
+
+		// world space frustum
+		const frustum& view_frustum() const {
+			if (m_dirty & frustum_dirty) {
+				// Gribb-Hartmann: the planes are sums and differences of the rows
+				const float* m = view_projection().data.data();
+				set_plane(m_frustum.planes[0], m, 0, 1.0f, 1.0f);
+				set_plane(m_frustum.planes[1], m, 0, -1.0f, 1.0f);
+				set_plane(m_frustum.planes[2], m, 1, 1.0f, 1.0f);
+				set_plane(m_frustum.planes[3], m, 1, -1.0f, 1.0f);
+				if (m_reverse_z) {
+					// z <= w and z >= 0
+					set_plane(m_frustum.planes[4], m, 2, -1.0f, 1.0f);
+					set_plane(m_frustum.planes[5], m, 2, 1.0f, 0.0f);
+				}
+				else {
+					set_plane(m_frustum.planes[4], m, 2, 1.0f, 1.0f);
+					set_plane(m_frustum.planes[5], m, 2, -1.0f, 1.0f);
+				}
+				m_dirty &= ~frustum_dirty;
+			}
+			return m_frustum;
+		}
+
+		// camera position in world space
+		base_vector<3, float> position() const {
+			return base_vector<3, float>({ m_inverse_view.data[3], m_inverse_view.data[7], m_inverse_view.data[11] });
+		}
+
+		bool reverse_z() const {
+			return m_reverse_z;
+		}
+
+	private:
+		enum : unsigned int
+		{
+			view_projection_dirty = 1,
+			inverse_view_projection_dirty = 2,
+			frustum_dirty = 4,
+			all_dirty = 7
+		};
+
+		// closed form inverse of the projections built by this camera
+		void invert_projection() {
+			const float* p = m_projection.data.data();
+			float* q = m_inverse_projection.data.data();
+			for (unsigned int i = 0; i < 16; ++i)
+				q[i] = 0.0f;
+			q[0] = 1.0f / p[0];
+			q[5] = 1.0f / p[5];
+			if (m_perspective) {
+				// rows (a, 0, 0, 0), (0, b, 0, 0), (0, 0, c, d), (0, 0, -1, 0)
+				q[11] = -1.0f;
+				q[14] = 1.0f / p[11];
+				q[15] = p[10] / p[11];
+			}
+			else {
+				// diagonal scale and translation
+				q[10] = 1.0f / p[10];
+				q[3] = -p[3] * q[0];
+				q[7] = -p[7] * q[5];
+				q[11] = -p[11] * q[10];
+				q[15] = 1.0f;
+			}
+			m_dirty = all_dirty;
+		}
+
+		// plane row 3 * w + row i * s, normalized
+		static void set_plane(plane& result, const float* m, const unsigned int i, const float s, const float w) {
+			float e[4];
+			for (unsigned int j = 0; j < 4; ++j)
+				e[j] = m[12 + j] * w + m[i * 4 + j] * s;
+			const float length = std::sqrt(e[0] * e[0] + e[1] * e[1] + e[2] * e[2]);
+			// the far plane at infinity is w > 0, up to rounding
+			if (length <= 1.0e-6f * std::fabs(e[3])) {
+				result.normal = vec3(0.0f, 0.0f, 0.0f);
+				result.distance = -e[3];
+				return;
+			}
+			result.normal = vec3(e[0] / length, e[1] / length, e[2] / length);
+			result.distance = -e[3] / length;
+		}
+
+		base_matrix<4, 4, float> m_view = identity<4, float>();
+		base_matrix<4, 4, float> m_inverse_view = identity<4, float>();
+		base_matrix<4, 4, float> m_projection;
+		base_matrix<4, 4, float> m_inverse_projection;
+		mutable base_matrix<4, 4, float> m_view_projection;
+		mutable base_matrix<4, 4, float> m_inverse_view_projection;
+		mutable frustum m_frustum;
+		mutable unsigned int m_dirty = all_dirty;
+		bool m_perspective = true;
+		bool m_reverse_z = false;
+	};
+};
\ No newline at end of file
@@ -15,12 +15,12 @@ namespace math4games
 	const float rad2deg_factor = 180.0f / pi;
 
 	// degrees to radians
-	float radians(const float theta) {
+	inline float radians(const float theta) {
 		return theta * deg2rad_factor;
 	}
 
 	// radians to degrees
-	float degrees(const float theta) {
+	inline float degrees(const float theta) {
 		return theta * rad2deg_factor;
 	}
 
@@ -0,0 +1,646 @@
+#pragma once
+
+/*
+	Convex collision
+	Vito Domenico Tagliente
+	math library for games
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include "vector.h"
+#include "point.h"
+#include "matrix.h"
+
+namespace math4games
+{
+	/*
+		Narrow phase collision between convex shapes with GJK (distance
+		and intersection) and EPA (penetration depth).
+		A shape is any type with a support function
+			vec3 support(const vec3& direction) const
+		returning its farthest point along direction, in world space.
+		GJK works on the Minkowski difference A - B, whose support along d
+		is support_A(d) - support_B(-d).
+	*/
+
+	// sphere
+	struct convex_sphere
+	{
+		vec3 center;
+		float radius = 0.0f;
+
+		vec3 support(const vec3& direction) const {
+			const float length = direction.magnitude();
+			if (length == 0.0f)
+				return center;
+			return center + direction * (radius / length);
+		}
+	};
+
+	// capsule: the points within radius of the segment a, b
+	struct convex_capsule
+	{
+		vec3 a;
+		vec3 b;
+		float radius = 0.0f;
+
+		vec3 support(const vec3& direction) const {
+			const vec3& end = direction * a > direction * b ? a : b;
+			const float length = direction.magnitude();
+			if (length == 0.0f)
+				return end;
+			return end + direction * (radius / length);
+		}
+	};
+
+	// oriented box, the columns of rotation are its local axes
+	struct convex_box
+	{
+		vec3 center;
+		base_matrix<3, 3, float> rotation = matrix3::identity;
+		vec3 extents;
+
+		vec3 support(const vec3& direction) const {
+			vec3 result = center;
+			for (unsigned int j = 0; j < 3; ++j) {
+				// r(i, j) = element at row i, column j
+				float d = 0.0f;
+				for (unsigned int i = 0; i < 3; ++i)
+					d += rotation.data[i * 3 + j] * direction.data[i];
+				const float e = d < 0.0f ? -extents.data[j] : extents.data[j];
+				for (unsigned int i = 0; i < 3; ++i)
+					result.data[i] += rotation.data[i * 3 + j] * e;
+			}
+			return result;
+		}
+	};
+
+	// convex hull of an array of points, by linear search
+	template<typename P = point3>
+	struct convex_points
+	{
+		const P* points = nullptr;
+		std::size_t count = 0;
+
+		convex_points() = default;
+		convex_points(const P* _points, const std::size_t _count) : points(_points), count(_count) {}
+
+		vec3 support(const vec3& direction) const {
+			assert(count > 0);
+			std::size_t best = 0;
+			float best_distance = -std::numeric_limits<float>::max();
+			for (std::size_t k = 0; k < count; ++k) {
+				const float d = points[k].data[0] * direction.data[0] + points[k].data[1] * direction.data[1]
+					+ points[k].data[2] * direction.data[2];
+				if (d > best_distance) {
+					best_distance = d;
+					best = k;
+				}
+			}
+			return vec3(points[best].data[0], points[best].data[1], points[best].data[2]);
+		}
+	};
+
+	// a vertex of the Minkowski difference with the points of A and B it comes from
+	struct convex_vertex
+	{
+		vec3 a;
+		vec3 b;
+		vec3 w;
+		// direction of the support query, used to rebuild the vertex
+		vec3 direction;
+	};
+
+	// support of A - B along direction
+	template<typename A, typename B>
+	convex_vertex minkowski_support(const A& a, const B& b, const vec3& direction) {
+		convex_vertex v;
+		v.a = a.support(direction);
+		v.b = b.support(-direction);
+		v.w = v.a - v.b;
+		v.direction = direction;
+		return v;
+	}
+
+	/*
+		warm start: the directions of the last simplex. Pass the same
+		cache for the same pair every frame, the simplex is rebuilt from
+		them on the moved shapes and GJK usually converges in one or two
+		iterations
+	*/
+	struct gjk_cache
+	{
+		vec3 directions[4];
+		unsigned int count = 0;
+
+		void reset() {
+			count = 0;
+		}
+	};
+
+	struct gjk_result
+	{
+		bool intersect = false;
+		// distance between the shapes, 0 when they intersect
+		float distance = 0.0f;
+		// closest points on A and B
+		vec3 point_a;
+		vec3 point_b;
+		unsigned int iterations = 0;
+		// final simplex, contains the origin when the shapes intersect
+		convex_vertex simplex[4];
+		unsigned int count = 0;
+	};
+
+	namespace detail
+	{
+		// closest point to the origin on the simplex s, by the Voronoi
+		// regions of its features. The simplex is reduced to the smallest
+		// feature containing the point and lambda holds its barycentric
+		// coordinates. Returns false when the origin is inside a tetrahedron
+		inline vec3 closest_segment(convex_vertex* s, unsigned int& count, float* lambda) {
+			const vec3 ab = s[1].w - s[0].w;
+			const float length = ab * ab;
+			const float t = length > 0.0f ? -(s[0].w * ab) / length : 0.0f;
+			if (t <= 0.0f) {
+				count = 1;
+				lambda[0] = 1.0f;
+				return s[0].w;
+			}
+			if (t >= 1.0f) {
+				s[0] = s[1];
+				count = 1;
+				lambda[0] = 1.0f;
+				return s[0].w;
+			}
+			lambda[0] = 1.0f - t;
+			lambda[1] = t;
+			return s[0].w + ab * t;
+		}
+
+		inline vec3 closest_triangle(convex_vertex* s, unsigned int& count, float* lambda) {
+			const vec3& a = s[0].w;
+			const vec3& b = s[1].w;
+			const vec3& c = s[2].w;
+			const vec3 ab = b - a, ac = c - a;
+			const vec3 ap = -a;
+
+			const float d1 = ab * ap, d2 = ac * ap;
+			if (d1 <= 0.0f && d2 <= 0.0f) {
+				count = 1;
+				lambda[0] = 1.0f;
+				return a;
+			}
+			const vec3 bp = -b;
+			const float d3 = ab * bp, d4 = ac * bp;
+			if (d3 >= 0.0f && d4 <= d3) {
+				s[0] = s[1];
+				count = 1;
+				lambda[0] = 1.0f;
+				return s[0].w;
+			}
+			const float vc = d1 * d4 - d3 * d2;
+			if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+				const float t = d1 / (d1 - d3);
+				count = 2;
+				lambda[0] = 1.0f - t;
+				lambda[1] = t;
+				return a + ab * t;
+			}
+			const vec3 cp = -c;
+			const float d5 = ab * cp, d6 = ac * cp;
+			if (d6 >= 0.0f && d5 <= d6) {
+				s[0] = s[2];
+				count = 1;
+				lambda[0] = 1.0f;
+				return s[0].w;
+			}
+			const float vb = d5 * d2 - d1 * d6;
+			if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+				const float t = d2 / (d2 - d6);
+				s[1] = s[2];
+				count = 2;
+				lambda[0] = 1.0f - t;
+				lambda[1] = t;
+				return a + ac * t;
+			}
+			const float va = d3 * d6 - d5 * d4;
+			if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+				const float t = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+				const vec3 closest = b + (c - b) * t;
+				s[0] = s[1];
+				s[1] = s[2];
+				count = 2;
+				lambda[0] = 1.0f - t;
+				lambda[1] = t;
+				return closest;
+			}
+			const float sum = va + vb + vc;
+			if (!(sum > 0.0f)) {
+				// degenerate triangle, fall back to its first edge
+				count = 2;
+				return closest_segment(s, count, lambda);
+			}
+			const float v = vb / sum, w = vc / sum;
+			lambda[0] = 1.0f - v - w;
+			lambda[1] = v;
+			lambda[2] = w;
+			return a + ab * v + ac * w;
+		}
+
+		// true when the origin and d are not strictly on the same side of the plane abc,
+		// degenerate faces count as outside
+		inline bool origin_outside(const vec3& a, const vec3& b, const vec3& c, const vec3& d) {
+			const vec3 n = vec3(b - a).cross(c - a);
+			const float origin_side = -(a * n);
+			const float d_side = (d - a) * n;
+			return origin_side * d_side <= 0.0f;
+		}
+
+		inline bool closest_tetrahedron(convex_vertex* s, unsigned int& count, float* lambda, vec3& closest) {
+			// faces and the vertex opposite to each
+			const unsigned int faces[4][4] = { { 0, 1, 2, 3 }, { 0, 2, 3, 1 }, { 0, 3, 1, 2 }, { 1, 3, 2, 0 } };
+			// a nearly flat tetrahedron can not enclose the origin, and the
+			// sides of its faces are lost to rounding: try every face
+			const vec3 ab = s[1].w - s[0].w, ac = s[2].w - s[0].w, ad = s[3].w - s[0].w;
+			const float volume = ab * ac.cross(ad);
+			const bool flat = std::abs(volume) <= 1e-5f * ab.magnitude() * ac.magnitude() * ad.magnitude();
+			float best = std::numeric_limits<float>::max();
+			convex_vertex best_simplex[3];
+			float best_lambda[3] = {};
+			unsigned int best_count = 0;
+			for (unsigned int f = 0; f < 4; ++f) {
+				const unsigned int* face = faces[f];
+				if (!flat && !origin_outside(s[face[0]].w, s[face[1]].w, s[face[2]].w, s[face[3]].w))
+					continue;
+				convex_vertex t[3] = { s[face[0]], s[face[1]], s[face[2]] };
+				unsigned int n = 3;
+				float l[3];
+				const vec3 p = closest_triangle(t, n, l);
+				const float distance = p * p;
+				if (distance < best) {
+					best = distance;
+					closest = p;
+					best_count = n;
+					for (unsigned int i = 0; i < n; ++i) {
+						best_simplex[i] = t[i];
+						best_lambda[i] = l[i];
+					}
+				}
+			}
+			if (best_count == 0)
+				return false;
+			count = best_count;
+			for (unsigned int i = 0; i < count; ++i) {
+				s[i] = best_simplex[i];
+				lambda[i] = best_lambda[i];
+			}
+			return true;
+		}
+
+		// closest point of the simplex, false when it encloses the origin
+		inline bool closest_simplex(convex_vertex* s, unsigned int& count, float* lambda, vec3& closest) {
+			switch (count) {
+			case 1:
+				lambda[0] = 1.0f;
+				closest = s[0].w;
+				return true;
+			case 2: closest = closest_segment(s, count, lambda); return true;
+			case 3: closest = closest_triangle(s, count, lambda); return true;
+			default: return closest_tetrahedron(s, count, lambda, closest);
+			}
+		}
+
+		template<typename A, typename B>
+		gjk_result gjk(const A& a, const B& b, gjk_cache* cache, const bool intersect_only,
+			const unsigned int max_iterations, const float tolerance) {
+			gjk_result result;
+			convex_vertex* s = result.simplex;
+			unsigned int& count = result.count;
+			float lambda[4] = { 1.0f };
+			vec3 v;
+
+			// rebuild the cached simplex, or start from an arbitrary direction
+			if (cache != nullptr && cache->count > 0) {
+				for (unsigned int i = 0; i < cache->count; ++i)
+					s[i] = minkowski_support(a, b, cache->directions[i]);
+				count = cache->count;
+			}
+			else {
+				s[0] = minkowski_support(a, b, vec3(1.0f, 0.0f, 0.0f));
+				count = 1;
+			}
+
+			bool inside = !closest_simplex(s, count, lambda, v);
+			float max_length = 0.0f;
+			while (!inside && result.iterations < max_iterations) {
+				++result.iterations;
+				const float distance = v * v;
+				if (distance == 0.0f) {
+					inside = true;
+					break;
+				}
+
+				const convex_vertex w = minkowski_support(a, b, -v);
+				const float vw = v * w.w;
+				// a separating axis, the shapes do not intersect
+				if (intersect_only && vw > 0.0f)
+					break;
+				// no progress along v, v is the closest point
+				if (distance - vw <= tolerance * distance)
+					break;
+				// a vertex at rounding distance of the simplex, as the same
+				// corner found again, would make it degenerate
+				const float near = tolerance * tolerance * std::max(max_length, w.w * w.w);
+				bool duplicate = false;
+				for (unsigned int i = 0; i < count; ++i) {
+					const vec3 d = s[i].w - w.w;
+					duplicate = duplicate || d * d <= near;
+				}
+				if (duplicate)
+					break;
+
+				// keep the simplex in case the new one does not get closer
+				convex_vertex previous[4];
+				float previous_lambda[4];
+				const unsigned int previous_count = count;
+				const vec3 previous_v = v;
+				for (unsigned int i = 0; i < count; ++i) {
+					previous[i] = s[i];
+					previous_lambda[i] = lambda[i];
+				}
+
+				s[count++] = w;
+				for (unsigned int i = 0; i < count; ++i)
+					max_length = std::max(max_length, s[i].w * s[i].w);
+				inside = !closest_simplex(s, count, lambda, v);
+				// rounding on a nearly degenerate simplex, v can only
+				// decrease: keep the previous one and stop
+				if (!inside && v * v >= distance) {
+					count = previous_count;
+					v = previous_v;
+					for (unsigned int i = 0; i < count; ++i) {
+						s[i] = previous[i];
+						lambda[i] = previous_lambda[i];
+					}
+					break;
+				}
+				// the origin touches the simplex
+				if (!inside && v * v <= tolerance * tolerance * max_length)
+					inside = true;
+			}
+
+			if (cache != nullptr) {
+				cache->count = count;
+				for (unsigned int i = 0; i < count; ++i)
+					cache->directions[i] = s[i].direction;
+			}
+
+			result.intersect = inside;
+			if (inside) {
+				result.distance = 0.0f;
+				return result;
+			}
+			result.point_a = vec3::zero;
+			result.point_b = vec3::zero;
+			for (unsigned int i = 0; i < count; ++i) {
+				result.point_a += s[i].a * lambda[i];
+				result.point_b += s[i].b * lambda[i];
+			}
+			result.distance = v.magnitude();
+			return result;
+		}
+	}
+
+	// distance and closest points between two convex shapes.
+	// cache is optional, see gjk_cache
+	template<typename A, typename B>
+	gjk_result gjk_distance(const A& a, const B& b, gjk_cache* cache = nullptr,
+		const unsigned int max_iterations = 32, const float tolerance = 1e-5f) {
+		return detail::gjk(a, b, cache, false, max_iterations, tolerance);
+	}
+
+	// intersection test, stops as soon as a separating axis is found:
+	// cheaper than gjk_distance but the distance and points are not final
+	template<typename A, typename B>
+	bool gjk_intersect(const A& a, const B& b, gjk_cache* cache = nullptr,
+		const unsigned int max_iterations = 32, const float tolerance = 1e-5f) {
+		return detail::gjk(a, b, cache, true, max_iterations, tolerance).intersect;
+	}
+
+	struct epa_result
+	{
+		bool valid = false;
+		// penetration depth along normal
+		float depth = 0.0f;
+		// unit direction from A to B, moving B by depth * normal separates the shapes
+		vec3 normal;
+		// deepest points of A inside B and of B inside A
+		vec3 point_a;
+		vec3 point_b;
+		unsigned int iterations = 0;
+	};
+
+	namespace detail
+	{
+		// polytope of the expanding polytope algorithm, with fixed capacity
+		struct epa_polytope
+		{
+			static const unsigned int max_vertices = 128;
+			static const unsigned int max_faces = 2 * max_vertices;
+
+			struct face
+			{
+				unsigned int v[3];
+				vec3 normal;
+				float distance;
+			};
+
+			convex_vertex vertices[max_vertices];
+			face faces[max_faces];
+			unsigned int vertex_count = 0;
+			unsigned int face_count = 0;
+
+			// adds the face abc with the outward normal, false when it is degenerate
+			bool add_face(const unsigned int a, const unsigned int b, const unsigned int c) {
+				if (face_count == max_faces)
+					return false;
+				const vec3& pa = vertices[a].w;
+				vec3 n = vec3(vertices[b].w - pa).cross(vertices[c].w - pa);
+				const float length = n.magnitude();
+				if (!(length > 0.0f))
+					return false;
+				n *= 1.0f / length;
+				face& f = faces[face_count++];
+				f.v[0] = a;
+				f.v[1] = b;
+				f.v[2] = c;
+				f.normal = n;
+				f.distance = n * pa;
+				return true;
+			}
+		};
+
+		// grows the gjk simplex to a tetrahedron around the origin
+		template<typename A, typename B>
+		bool epa_tetrahedron(const A& a, const B& b, convex_vertex* s, unsigned int& count) {
+			const vec3 axes[3] = { vec3(1.0f, 0.0f, 0.0f), vec3(0.0f, 1.0f, 0.0f), vec3(0.0f, 0.0f, 1.0f) };
+			if (count == 1) {
+				// any direction that moves away from the single vertex
+				for (unsigned int i = 0; i < 6 && count < 2; ++i) {
+					const vec3 d = i < 3 ? axes[i] : vec3(-axes[i - 3]);
+					const convex_vertex w = minkowski_support(a, b, d);
+					if (vec3(w.w - s[0].w).magnitude() > 1e-6f)
+						s[count++] = w;
+				}
+			}
+			if (count == 2) {
+				// directions perpendicular to the segment
+				const vec3 ab = s[1].w - s[0].w;
+				unsigned int axis = 0;
+				for (unsigned int i = 1; i < 3; ++i) {
+					if (std::fabs(ab.data[i]) < std::fabs(ab.data[axis]))
+						axis = i;
+				}
+				const vec3 first = ab.cross(axes[axis]);
+				const vec3 second = ab.cross(first);
+				const vec3 directions[4] = { first, vec3(-first), second, vec3(-second) };
+				for (unsigned int i = 0; i < 4 && count < 3; ++i) {
+					const convex_vertex w = minkowski_support(a, b, directions[i]);
+					if (vec3(w.w - s[0].w).cross(ab).magnitude() > 1e-6f)
+						s[count++] = w;
+				}
+			}
+			if (count == 3) {
+				const vec3 n = vec3(s[1].w - s[0].w).cross(s[2].w - s[0].w);
+				for (unsigned int i = 0; i < 2 && count < 4; ++i) {
+					const convex_vertex w = minkowski_support(a, b, i == 0 ? n : vec3(-n));
+					if (std::fabs((w.w - s[0].w) * n) > 1e-6f)
+						s[count++] = w;
+				}
+			}
+			return count == 4;
+		}
+	}
+
+	// penetration depth of intersecting shapes, from the simplex of a
+	// gjk_result that reports an intersection. Polytopes converge exactly,
+	// curved shapes (spheres, capsules) converge from below as the
+	// polytope refines, up to max_iterations vertices
+	template<typename A, typename B>
+	epa_result epa_penetration(const A& a, const B& b, const gjk_result& gjk,
+		const unsigned int max_iterations = 64, const float tolerance = 1e-4f) {
+		epa_result result;
+		if (!gjk.intersect)
+			return result;
+
+		detail::epa_polytope polytope;
+		convex_vertex s[4];
+		unsigned int count = gjk.count;
+		for (unsigned int i = 0; i < count; ++i)
+			s[i] = gjk.simplex[i];
+		if (!detail::epa_tetrahedron(a, b, s, count))
+			return result;
+
+		// orient the tetrahedron so that the faces wind outward
+		if ((s[3].w - s[0].w) * vec3(s[1].w - s[0].w).cross(s[2].w - s[0].w) > 0.0f)
+			std::swap(s[1], s[2]);
+		for (unsigned int i = 0; i < 4; ++i)
+			polytope.vertices[i] = s[i];
+		polytope.vertex_count = 4;
+		polytope.add_face(0, 1, 2);
+		polytope.add_face(0, 3, 1);
+		polytope.add_face(0, 2, 3);
+		polytope.add_face(1, 3, 2);
+		if (polytope.face_count < 4)
+			return result;
+
+		unsigned int closest = 0;
+		while (true) {
+			closest = 0;
+			for (unsigned int f = 1; f < polytope.face_count; ++f) {
+				if (polytope.faces[f].distance < polytope.faces[closest].distance)
+					closest = f;
+			}
+			const detail::epa_polytope::face nearest = polytope.faces[closest];
+			if (result.iterations == max_iterations || polytope.vertex_count == detail::epa_polytope::max_vertices)
+				break;
+			++result.iterations;
+
+			const convex_vertex w = minkowski_support(a, b, nearest.normal);
+			// the face is on the boundary of A - B
+			if (w.w * nearest.normal - nearest.distance <= tolerance)
+				break;
+
+			// remove the faces that see w, keeping the boundary of the hole.
+			// w on the plane of a face, common on boxes, does not see it:
+			// rounding would remove faces apart from the hole and turn the
+			// new ones inside out
+			const float coplanar = tolerance * 0.01f;
+			unsigned int edges[detail::epa_polytope::max_faces * 3][2];
+			unsigned int edge_count = 0;
+			for (unsigned int f = 0; f < polytope.face_count;) {
+				const detail::epa_polytope::face& face = polytope.faces[f];
+				if (face.normal * (w.w - polytope.vertices[face.v[0]].w) <= coplanar) {
+					++f;
+					continue;
+				}
+				for (unsigned int e = 0; e < 3; ++e) {
+					const unsigned int from = face.v[e], to = face.v[(e + 1) % 3];
+					// an edge shared with another removed face is interior
+					bool shared = false;
+					for (unsigned int k = 0; k < edge_count; ++k) {
+						if (edges[k][0] == to && edges[k][1] == from) {
+							edges[k][0] = edges[--edge_count][0];
+							edges[k][1] = edges[edge_count][1];
+							shared = true;
+							break;
+						}
+					}
+					if (!shared) {
+						edges[edge_count][0] = from;
+						edges[edge_count][1] = to;
+						++edge_count;
+					}
+				}
+				polytope.faces[f] = polytope.faces[--polytope.face_count];
+			}
+
+			const unsigned int index = polytope.vertex_count++;
+			polytope.vertices[index] = w;
+			for (unsigned int e = 0; e < edge_count; ++e)
+				polytope.add_face(edges[e][0], edges[e][1], index);
+			if (polytope.face_count == 0)
+				return result;
+		}
+
+		// contact points from the barycentric coordinates of the origin
+		// projected on the closest face
+		const detail::epa_polytope::face& face = polytope.faces[closest];
+		const convex_vertex& v0 = polytope.vertices[face.v[0]];
+		const convex_vertex& v1 = polytope.vertices[face.v[1]];
+		const convex_vertex& v2 = polytope.vertices[face.v[2]];
+		const vec3 p = face.normal * face.distance;
+		const vec3 e0 = v1.w - v0.w, e1 = v2.w - v0.w, e2 = p - v0.w;
+		const float d00 = e0 * e0, d01 = e0 * e1, d11 = e1 * e1, d20 = e2 * e0, d21 = e2 * e1;
+		const float denominator = d00 * d11 - d01 * d01;
+		float u = 1.0f, v = 0.0f, w = 0.0f;
+		if (denominator > 0.0f) {
+			v = (d11 * d20 - d01 * d21) / denominator;
+			w = (d00 * d21 - d01 * d20) / denominator;
+			u = 1.0f - v - w;
+		}
+
+		result.valid = true;
+		result.depth = face.distance;
+		result.normal = face.normal;
+		result.point_a = v0.a * u + v1.a * v + v2.a * w;
+		result.point_b = v0.b * u + v1.b * v + v2.b * w;
+		return result;
+	}
+};
\ No newline at end of file
@@ -0,0 +1,544 @@
+#pragma once
+
+/*
+	Delaunay triangulation
+	Vito Domenico Tagliente
+	math library for games
+*/
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "vector.h"
+#include "point.h"
+#include "spatial.h"
+#include "predicates.h"
+
+namespace math4games
+{
+	const std::uint32_t delaunay_none = 0xffffffffu;
+
+	/*
+		triangles, counter clockwise, as a half-edge structure: half-edge e
+		goes from triangles[e] to triangles[next(e)] in the triangle e / 3,
+		halfedges[e] is the opposite half-edge or delaunay_none on the hull
+		and constrained[e] is 1 on the edges of the constraints
+	*/
+	struct delaunay2
+	{
+		std::vector<std::uint32_t> triangles;
+		std::vector<std::uint32_t> halfedges;
+		std::vector<std::uint8_t> constrained;
+
+		std::size_t size() const {
+			return triangles.size() / 3;
+		}
+
+		static std::uint32_t next(const std::uint32_t e) {
+			return e % 3 == 2 ? e - 2 : e + 1;
+		}
+
+		static std::uint32_t prev(const std::uint32_t e) {
+			return e % 3 == 0 ? e + 2 : e - 1;
+		}
+
+		void clear() {
+			triangles.clear();
+			halfedges.clear();
+			constrained.clear();
+		}
+	};
+
+	namespace detail
+	{
+		struct delaunay_edge
+		{
+			std::uint32_t a, b;
+			// half-edge on the other side
+			std::uint32_t twin;
+		};
+	}
+
+	// buffers of the triangulation, kept between builds as hull_workspace
+	struct delaunay_workspace
+	{
+		std::vector<std::uint64_t> keys;
+		std::vector<std::uint32_t> order;
+		std::vector<std::uint32_t> alias;
+
+		// triangles with the ghost ones around the hull
+		std::vector<std::uint32_t> vertices;
+		std::vector<std::uint32_t> opposite;
+		std::vector<std::uint8_t> constrained;
+		std::vector<std::uint32_t> mark;
+		std::vector<std::uint32_t> unused;
+		std::vector<std::uint32_t> vertex_edge;
+		std::vector<std::uint32_t> start;
+
+		std::vector<std::uint32_t> stack;
+		std::vector<std::uint32_t> created;
+		std::vector<detail::delaunay_edge> boundary;
+		std::vector<std::pair<std::uint32_t, std::uint32_t>> crossed;
+		std::vector<std::pair<std::uint32_t, std::uint32_t>> flipped;
+	};
+
+	namespace detail
+	{
+		/*
+			Bowyer-Watson insertion on a triangulation closed by ghost
+			triangles, which join each hull edge to a vertex at infinity, so
+			that points outside the hull need no super triangle. A ghost
+			triangle conflicts with the points in front of its edge and
+			inside it; the others with the points inside their circle
+		*/
+		template<typename P>
+		struct delaunay_builder
+		{
+			const P* points;
+			std::uint32_t ghost;
+			delaunay_workspace& w;
+			std::uint32_t stamp = 0;
+
+			static std::uint32_t next(const std::uint32_t e) {
+				return delaunay2::next(e);
+			}
+
+			static std::uint32_t prev(const std::uint32_t e) {
+				return delaunay2::prev(e);
+			}
+
+			int orient(const std::uint32_t a, const std::uint32_t b, const std::uint32_t c) const {
+				return math4games::orient2d(points[a], points[b], points[c]);
+			}
+
+			// (c - a) * (b - a) > 0
+			bool toward(const std::uint32_t a, const std::uint32_t b, const std::uint32_t c) const {
+				return (static_cast<double>(points[c].data[0]) - points[a].data[0]) * (static_cast<double>(points[b].data[0]) - points[a].data[0])
+					+ (static_cast<double>(points[c].data[1]) - points[a].data[1]) * (static_cast<double>(points[b].data[1]) - points[a].data[1]) > 0.0;
+			}
+
+			bool is_ghost(const std::uint32_t t) const {
+				const std::uint32_t* v = w.vertices.data() + t * 3;
+				return v[0] == ghost || v[1] == ghost || v[2] == ghost;
+			}
+
+			bool conflict(const std::uint32_t t, const std::uint32_t p) const {
+				const std::uint32_t* v = w.vertices.data() + t * 3;
+				if (v[0] == ghost)
+					return hull_conflict(v[1], v[2], p);
+				if (v[1] == ghost)
+					return hull_conflict(v[2], v[0], p);
+				if (v[2] == ghost)
+					return hull_conflict(v[0], v[1], p);
+				return math4games::incircle(points[v[0]], points[v[1]], points[v[2]], points[p]) > 0;
+			}
+
+			// the ghost triangle is on the left of a, b
+			bool hull_conflict(const std::uint32_t a, const std::uint32_t b, const std::uint32_t p) const {
+				const int o = orient(a, b, p);
+				if (o != 0)
+					return o > 0;
+				return toward(a, b, p) && toward(b, a, p);
+			}
+
+			void link(const std::uint32_t e, const std::uint32_t f) {
+				w.opposite[e] = f;
+				w.opposite[f] = e;
+			}
+
+			std::uint32_t add_triangle(const std::uint32_t a, const std::uint32_t b, const std::uint32_t c) {
+				std::uint32_t t;
+				if (w.unused.empty()) {
+					t = static_cast<std::uint32_t>(w.mark.size());
+					w.vertices.resize(w.vertices.size() + 3);
+					w.opposite.resize(w.opposite.size() + 3);
+					w.constrained.resize(w.constrained.size() + 3);
+					w.mark.push_back(0);
+				}
+				else {
+					t = w.unused.back();
+					w.unused.pop_back();
+				}
+				const std::uint32_t v[3] = { a, b, c };
+				for (unsigned int i = 0; i < 3; ++i) {
+					w.vertices[t * 3 + i] = v[i];
+					w.opposite[t * 3 + i] = delaunay_none;
+					w.constrained[t * 3 + i] = 0;
+					w.vertex_edge[v[i]] = t * 3 + i;
+				}
+				return t;
+			}
+
+			void remove_triangle(const std::uint32_t t) {
+				w.vertices[t * 3] = delaunay_none;
+				w.unused.push_back(t);
+			}
+
+			// triangle with p inside or on its edges, or the ghost one in
+			// front of p when p is outside the hull. The visibility walk
+			// ends on Delaunay triangulations
+			std::uint32_t locate(const std::uint32_t p, std::uint32_t t) const {
+				const std::uint32_t* v = w.vertices.data();
+				if (is_ghost(t)) {
+					const unsigned int i = v[t * 3 + 2] == ghost ? 0 : (v[t * 3] == ghost ? 1 : 2);
+					t = w.opposite[t * 3 + i] / 3;
+				}
+				for (;;) {
+					unsigned int i = 0;
+					for (; i < 3; ++i) {
+						const std::uint32_t e = t * 3 + i;
+						if (orient(v[e], v[next(e)], p) < 0)
+							break;
+					}
+					if (i == 3)
+						return t;
+					t = w.opposite[t * 3 + i] / 3;
+					if (is_ghost(t))
+						return t;
+				}
+			}
+
+			// the first triangle and the ghost ones around it
+			void initialize(const std::uint32_t a, const std::uint32_t b, const std::uint32_t c) {
+				const std::uint32_t t[4] = { add_triangle(a, b, c), add_triangle(b, a, ghost),
+					add_triangle(c, b, ghost), add_triangle(a, c, ghost) };
+				for (unsigned int i = 0; i < 4; ++i)
+					for (unsigned int j = 0; j < 4; ++j)
+						for (unsigned int e = 0; e < 3; ++e)
+							for (unsigned int f = 0; f < 3; ++f)
+								if (w.vertices[t[i] * 3 + e] == w.vertices[t[j] * 3 + (f + 1) % 3]
+									&& w.vertices[t[i] * 3 + (e + 1) % 3] == w.vertices[t[j] * 3 + f])
+									w.opposite[t[i] * 3 + e] = t[j] * 3 + f;
+			}
+
+			// insert p starting the search from t, returns a triangle of p or
+			// delaunay_none when p is a duplicate
+			std::uint32_t insert(const std::uint32_t p, const std::uint32_t t) {
+				const std::uint32_t found = locate(p, t);
+				if (!is_ghost(found)) {
+					for (unsigned int i = 0; i < 3; ++i) {
+						const std::uint32_t v = w.vertices[found * 3 + i];
+						if (points[v].data[0] == points[p].data[0] && points[v].data[1] == points[p].data[1]) {
+							w.alias[p] = v;
+							return delaunay_none;
+						}
+					}
+				}
+
+				// cavity of the triangles in conflict with p and its boundary
+				++stamp;
+				const std::uint32_t inside = stamp * 2, outside = stamp * 2 + 1;
+				w.stack.clear();
+				w.created.clear();
+				w.boundary.clear();
+				w.stack.push_back(found);
+				w.mark[found] = inside;
+				while (!w.stack.empty()) {
+					const std::uint32_t c = w.stack.back();
+					w.stack.pop_back();
+					w.created.push_back(c);
+					for (unsigned int i = 0; i < 3; ++i) {
+						const std::uint32_t e = c * 3 + i;
+						const std::uint32_t f = w.opposite[e];
+						const std::uint32_t n = f / 3;
+						if (w.mark[n] == inside)
+							continue;
+						if (w.mark[n] != outside && conflict(n, p)) {
+							w.mark[n] = inside;
+							w.stack.push_back(n);
+							continue;
+						}
+						w.mark[n] = outside;
+						w.boundary.push_back({ w.vertices[e], w.vertices[next(e)], f });
+					}
+				}
+				for (const std::uint32_t c : w.created)
+					remove_triangle(c);
+
+				// star of p on the boundary
+				w.created.clear();
+				std::uint32_t result = delaunay_none;
+				for (const delaunay_edge& edge : w.boundary) {
+					const std::uint32_t c = add_triangle(edge.a, edge.b, p);
+					link(c * 3, edge.twin);
+					w.start[edge.a] = c;
+					w.created.push_back(c);
+					if (edge.a != ghost && edge.b != ghost)
+						result = c;
+				}
+				for (const std::uint32_t c : w.created)
+					link(c * 3 + 1, w.start[w.vertices[c * 3 + 1]] * 3 + 2);
+				return result;
+			}
+
+			// half-edge from a to b, or delaunay_none
+			std::uint32_t find_edge(const std::uint32_t a, const std::uint32_t b) const {
+				const std::uint32_t first = w.vertex_edge[a];
+				std::uint32_t e = first;
+				do {
+					if (w.vertices[next(e)] == b)
+						return e;
+					e = w.opposite[prev(e)];
+				} while (e != first);
+				return delaunay_none;
+			}
+
+			// replace the diagonal c, d of the triangles c, d, x and d, c, y with
+			// x, y: e becomes y, x and its opposite x, y
+			void flip(const std::uint32_t e) {
+				const std::uint32_t f = w.opposite[e];
+				const std::uint32_t e1 = next(e), e2 = prev(e), f1 = next(f), f2 = prev(f);
+				const std::uint32_t c = w.vertices[e], d = w.vertices[e1], x = w.vertices[e2], y = w.vertices[f2];
+				const std::uint32_t opposite[4] = { w.opposite[e1], w.opposite[e2], w.opposite[f1], w.opposite[f2] };
+				const std::uint8_t constrained[4] = { w.constrained[e1], w.constrained[e2], w.constrained[f1], w.constrained[f2] };
+				w.vertices[e] = y;
+				w.vertices[e1] = x;
+				w.vertices[e2] = c;
+				w.vertices[f] = x;
+				w.vertices[f1] = y;
+				w.vertices[f2] = d;
+				link(e1, opposite[1]);
+				link(e2, opposite[2]);
+				link(f1, opposite[3]);
+				link(f2, opposite[0]);
+				w.constrained[e1] = constrained[1];
+				w.constrained[e2] = constrained[2];
+				w.constrained[f1] = constrained[3];
+				w.constrained[f2] = constrained[0];
+				w.vertex_edge[y] = e;
+				w.vertex_edge[x] = e1;
+				w.vertex_edge[c] = e2;
+				w.vertex_edge[d] = f2;
+			}
+
+			void constrain(const std::uint32_t e) {
+				w.constrained[e] = 1;
+				w.constrained[w.opposite[e]] = 1;
+			}
+
+			/*
+				force the edge u, v into the triangulation: the edges crossing it
+				are flipped away (Sloan), skipping for later those whose quad is
+				not convex, then the new edges are flipped back to Delaunay where
+				they are not constrained. A vertex on the segment splits it.
+				Returns false when the segment crosses a constrained edge
+			*/
+			bool insert_constraint(const std::uint32_t u, const std::uint32_t v) {
+				if (u == v)
+					return true;
+
+				// triangle of u crossed by the segment
+				const std::uint32_t first = w.vertex_edge[u];
+				std::uint32_t h = first, crossing = delaunay_none;
+				do {
+					if (!is_ghost(h / 3)) {
+						const std::uint32_t a = w.vertices[next(h)], b = w.vertices[prev(h)];
+						if (a == v) {
+							constrain(h);
+							return true;
+						}
+						if (b == v) {
+							constrain(prev(h));
+							return true;
+						}
+						const int oa = orient(u, v, a), ob = orient(u, v, b);
+						if (oa == 0 && toward(u, v, a))
+							return insert_constraint(u, a) && insert_constraint(a, v);
+						if (ob == 0 && toward(u, v, b))
+							return insert_constraint(u, b) && insert_constraint(b, v);
+						if (oa < 0 && ob > 0) {
+							crossing = next(h);
+							break;
+						}
+					}
+					h = w.opposite[prev(h)];
+				} while (h != first);
+				if (crossing == delaunay_none)
+					return false;
+
+				// crossed edges, from the right to the left of the segment, up to
+				// v or to a vertex on the segment
+				w.crossed.clear();
+				std::uint32_t end = v;
+				for (std::uint32_t e = crossing;;) {
+					if (w.constrained[e])
+						return false;
+					w.crossed.push_back({ w.vertices[e], w.vertices[next(e)] });
+					const std::uint32_t f = w.opposite[e];
+					const std::uint32_t x = w.vertices[prev(f)];
+					if (x == v)
+						break;
+					const int o = orient(u, v, x);
+					if (o == 0) {
+						end = x;
+						break;
+					}
+					e = o < 0 ? prev(f) : next(f);
+				}
+
+				// flip the crossed edges away, the pairs keep the edges as flips
+				// move them between half-edges
+				w.flipped.clear();
+				for (std::size_t i = 0; i < w.crossed.size(); ++i) {
+					const std::pair<std::uint32_t, std::uint32_t> edge = w.crossed[i];
+					const std::uint32_t e = find_edge(edge.first, edge.second);
+					const std::uint32_t x = w.vertices[prev(e)], y = w.vertices[prev(w.opposite[e])];
+					if (orient(x, y, edge.first) * orient(x, y, edge.second) >= 0) {
+						w.crossed.push_back(edge);
+						continue;
+					}
+					flip(e);
+					if (orient(u, end, x) * orient(u, end, y) < 0)
+						w.crossed.push_back({ x, y });
+					else
+						w.flipped.push_back({ x, y });
+				}
+				constrain(find_edge(u, end));
+
+				for (bool swapped = true; swapped;) {
+					swapped = false;
+					for (std::pair<std::uint32_t, std::uint32_t>& edge : w.flipped) {
+						const std::uint32_t e = find_edge(edge.first, edge.second);
+						if (w.constrained[e])
+							continue;
+						const std::uint32_t x = w.vertices[prev(e)], y = w.vertices[prev(w.opposite[e])];
+						if (math4games::incircle(points[edge.first], points[edge.second], points[x], points[y]) > 0) {
+							flip(e);
+							edge = { y, x };
+							swapped = true;
+						}
+					}
+				}
+				return end == v || insert_constraint(end, v);
+			}
+		};
+	}
+
+	/*
+		Delaunay triangulation of count points by incremental insertion in
+		the order of their Hilbert curve, so that each point is found with a
+		short walk from the previous one and touches memory close to it.
+		The predicates are exact for float coordinates, collinear and
+		cocircular points are handled, duplicates are triangulated once with
+		the first of them. edges holds edge_count pairs of point indices
+		forced into the triangulation, which is Delaunay elsewhere; they
+		must not cross each other. Returns false when the points are all
+		collinear (no triangles) or a constraint crosses a previous one
+	*/
+	template<typename P>
+	bool delaunay(const P* points, const std::size_t count, const std::uint32_t* edges, const std::size_t edge_count,
+		delaunay2& result, delaunay_workspace& workspace) {
+		result.clear();
+		if (count < 3)
+			return false;
+		const std::uint32_t n = static_cast<std::uint32_t>(count);
+
+		// Hilbert order on a 2^16 grid
+		std::vector<std::uint64_t>& keys = workspace.keys;
+		std::vector<std::uint32_t>& order = workspace.order;
+		keys.resize(count);
+		order.resize(count);
+		{
+			P min, max;
+			bounds(points, count, min, max);
+			base_vector<2, unsigned int> q;
+			for (std::size_t k = 0; k < count; ++k) {
+				quantize(points + k, &q, 1, min, max, 16);
+				keys[k] = hilbert_encode(q, 16);
+			}
+			radix_sort(keys.data(), order.data(), count, 32);
+		}
+
+		// first triangle
+		const std::uint32_t i0 = order[0];
+		std::uint32_t i1 = delaunay_none, i2 = delaunay_none;
+		detail::delaunay_builder<P> builder{ points, n, workspace };
+		for (std::size_t k = 1; k < count && i1 == delaunay_none; ++k)
+			if (points[order[k]].data[0] != points[i0].data[0] || points[order[k]].data[1] != points[i0].data[1])
+				i1 = order[k];
+		if (i1 == delaunay_none)
+			return false;
+		int side = 0;
+		for (std::size_t k = 1; k < count && side == 0; ++k) {
+			side = builder.orient(i0, i1, order[k]);
+			i2 = order[k];
+		}
+		if (side == 0)
+			return false;
+		if (side < 0)
+			std::swap(i1, i2);
+
+		workspace.vertices.clear();
+		workspace.opposite.clear();
+		workspace.constrained.clear();
+		workspace.mark.clear();
+		workspace.unused.clear();
+		workspace.vertex_edge.assign(count + 1, delaunay_none);
+		workspace.start.resize(count + 1);
+		workspace.alias.resize(count);
+		for (std::uint32_t k = 0; k < n; ++k)
+			workspace.alias[k] = k;
+
+		builder.initialize(i0, i1, i2);
+		std::uint32_t last = 0;
+		for (std::size_t k = 0; k < count; ++k) {
+			const std::uint32_t p = order[k];
+			if (p == i0 || p == i1 || p == i2)
+				continue;
+			const std::uint32_t t = builder.insert(p, last);
+			if (t != delaunay_none)
+				last = t;
+		}
+
+		bool inserted = true;
+		for (std::size_t k = 0; k < edge_count; ++k) {
+			const std::uint32_t u = edges[k * 2], v = edges[k * 2 + 1];
+			assert(u < n && v < n);
+			inserted = builder.insert_constraint(workspace.alias[u], workspace.alias[v]) && inserted;
+		}
+
+		// real triangles, renumbered without the ghost and unused ones
+		std::vector<std::uint32_t>& index = workspace.mark;
+		const std::uint32_t slots = static_cast<std::uint32_t>(index.size());
+		std::uint32_t triangles = 0;
+		for (std::uint32_t t = 0; t < slots; ++t)
+			index[t] = workspace.vertices[t * 3] == delaunay_none || builder.is_ghost(t) ? delaunay_none : triangles++;
+		result.triangles.resize(triangles * 3);
+		result.halfedges.resize(triangles * 3);
+		result.constrained.resize(triangles * 3);
+		for (std::uint32_t t = 0; t < slots; ++t) {
+			if (index[t] == delaunay_none)
+				continue;
+			for (unsigned int i = 0; i < 3; ++i) {
+				const std::uint32_t e = index[t] * 3 + i;
+				const std::uint32_t f = workspace.opposite[t * 3 + i];
+				result.triangles[e] = workspace.vertices[t * 3 + i];
+				result.halfedges[e] = index[f / 3] == delaunay_none ? delaunay_none : index[f / 3] * 3 + f % 3;
+				result.constrained[e] = workspace.constrained[t * 3 + i];
+			}
+		}
+		return inserted;
+	}
+
+	template<typename P>
+	bool delaunay(const P* points, const std::size_t count, delaunay2& result, delaunay_workspace& workspace) {
+		return delaunay(points, count, nullptr, 0, result, workspace);
+	}
+
+	// triangulations with a temporary workspace
+
+	template<typename P>
+	bool delaunay(const P* points, const std::size_t count, delaunay2& result) {
+		delaunay_workspace workspace;
+		return delaunay(points, count, nullptr, 0, result, workspace);
+	}
+
+	template<typename P>
+	bool delaunay(const P* points, const std::size_t count, const std::uint32_t* edges, const std::size_t edge_count,
+		delaunay2& result) {
+		delaunay_workspace workspace;
+		return delaunay(points, count, edges, edge_count, result, workspace);
+	}
+};
\ No newline at end of file
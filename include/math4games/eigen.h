@@ -0,0 +1,130 @@
+#pragma once
+
+/*
+	Eigen decomposition of symmetric matrices
+	Vito Domenico Tagliente
+	math library for games
+*/
+
+#include <cmath>
+#include <utility>
+#include "vector.h"
+#include "matrix.h"
+#include "quaternion.h"
+
+namespace math4games
+{
+	// result of a symmetric 3x3 eigen decomposition
+	template<typename T>
+	struct base_eigen3
+	{
+		// eigenvalues, sorted in decreasing order
+		base_vector<3, T> values;
+
+		// orthonormal right handed eigenbasis,
+		// the i-th column is the eigenvector of values[i]
+		base_matrix<3, 3, T> vectors;
+
+		// eigenbasis as a rotation
+		quaternion rotation() const {
+			return to_quaternion(vectors);
+		}
+	};
+
+	typedef base_eigen3<float> eigen3;
+	typedef base_eigen3<double> deigen3;
+
+	// cyclic Jacobi eigen solver for symmetric 3x3 matrices
+	// runs a fixed number of sweeps, so the cost does not depend on the input,
+	// and works on local storage only: no allocations, no bounds checked access.
+	// Only the upper triangle of m is read.
+	template<typename T>
+	base_eigen3<T> eigen_symmetric(const base_matrix<3, 3, T>& m, const unsigned int sweeps = 5) {
+		// a(i, j) = element at row i, column j
+		T a[3][3] = {
+			{ m.data[0], m.data[1], m.data[2] },
+			{ m.data[1], m.data[4], m.data[5] },
+			{ m.data[2], m.data[5], m.data[8] }
+		};
+		T v[3][3] = {
+			{ static_cast<T>(1.0), T{}, T{} },
+			{ T{}, static_cast<T>(1.0), T{} },
+			{ T{}, T{}, static_cast<T>(1.0) }
+		};
+		const unsigned int pairs[3][2] = { { 0, 1 }, { 0, 2 }, { 1, 2 } };
+
+		for (unsigned int sweep = 0; sweep < sweeps; ++sweep) {
+			for (unsigned int n = 0; n < 3; ++n) {
+				const unsigned int p = pairs[n][0];
+				const unsigned int q = pairs[n][1];
+				const T apq = a[p][q];
+
+				// rotation angle which annihilates a(p, q), identity if already zero
+				const T theta = (a[q][q] - a[p][p]) / (static_cast<T>(2.0) * (apq != T{} ? apq : static_cast<T>(1.0)));
+				const T t = apq != T{}
+					? std::copysign(static_cast<T>(1.0), theta) / (std::abs(theta) + std::sqrt(theta * theta + static_cast<T>(1.0)))
+					: T{};
+				const T c = static_cast<T>(1.0) / std::sqrt(t * t + static_cast<T>(1.0));
+				const T s = t * c;
+
+				// a = J^t * a * J
+				for (unsigned int k = 0; k < 3; ++k) {
+					const T akp = a[k][p];
+					const T akq = a[k][q];
+					a[k][p] = c * akp - s * akq;
+					a[k][q] = s * akp + c * akq;
+				}
+				for (unsigned int k = 0; k < 3; ++k) {
+					const T apk = a[p][k];
+					const T aqk = a[q][k];
+					a[p][k] = c * apk - s * aqk;
+					a[q][k] = s * apk + c * aqk;
+				}
+				// v = v * J
+				for (unsigned int k = 0; k < 3; ++k) {
+					const T vkp = v[k][p];
+					const T vkq = v[k][q];
+					v[k][p] = c * vkp - s * vkq;
+					v[k][q] = s * vkp + c * vkq;
+				}
+			}
+		}
+
+		// sort by decreasing eigenvalue, swapping the basis columns along
+		T d[3] = { a[0][0], a[1][1], a[2][2] };
+		auto sort_pair = [&d, &v](const unsigned int i, const unsigned int j) {
+			if (d[i] < d[j]) {
+				std::swap(d[i], d[j]);
+				for (unsigned int k = 0; k < 3; ++k)
+					std::swap(v[k][i], v[k][j]);
+			}
+		};
+		sort_pair(0, 1);
+		sort_pair(0, 2);
+		sort_pair(1, 2);
+
+		// make the basis right handed, so that it is a proper rotation
+		const T handedness =
+			v[0][0] * (v[1][1] * v[2][2] - v[1][2] * v[2][1]) -
+			v[0][1] * (v[1][0] * v[2][2] - v[1][2] * v[2][0]) +
+			v[0][2] * (v[1][0] * v[2][1] - v[1][1] * v[2][0]);
+		const T flip = handedness < T{} ? static_cast<T>(-1.0) : static_cast<T>(1.0);
+
+		base_eigen3<T> result;
+		for (unsigned int i = 0; i < 3; ++i) {
+			result.values[i] = d[i];
+			result.vectors.data[i * 3 + 0] = v[i][0];
+			result.vectors.data[i * 3 + 1] = v[i][1];
+			result.vectors.data[i * 3 + 2] = v[i][2] * flip;
+		}
+		return result;
+	}
+
+	// batch version: decomposes count matrices into results
+	template<typename T>
+	void eigen_symmetric(const base_matrix<3, 3, T>* matrices, base_eigen3<T>* results,
+		const std::size_t count, const unsigned int sweeps = 5) {
+		for (std::size_t i = 0; i < count; ++i)
+			results[i] = eigen_symmetric(matrices[i], sweeps);
+	}
+};
\ No newline at end of file
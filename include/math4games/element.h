@@ -0,0 +1,54 @@
+#pragma once
+
+/*
+	Element access
+	Vito Domenico Tagliente
+	math library for games
+*/
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <tuple>
+
+namespace math4games
+{
+	// element access policy of operator().
+	// Define MATH4GAMES_BOUNDS_CHECK to keep the std::array::at check,
+	// which throws std::out_of_range, in every build. Otherwise the index
+	// is asserted in debug builds and unchecked when NDEBUG is defined,
+	// so that loops over elements can be inlined and vectorized
+	namespace detail
+	{
+		template<typename A>
+		typename A::reference element(A& data, const std::size_t i) {
+#ifdef MATH4GAMES_BOUNDS_CHECK
+			return data.at(i);
+#else
+			assert(i < data.size());
+			return data[i];
+#endif
+		}
+
+		template<typename A>
+		typename A::const_reference element(const A& data, const std::size_t i) {
+#ifdef MATH4GAMES_BOUNDS_CHECK
+			return data.at(i);
+#else
+			assert(i < data.size());
+			return data[i];
+#endif
+		}
+	}
+
+	// number of components of a point or vector type with a std::array
+	// data member: base_point<N, float>, point3, vec3, ...
+	// Functions on arrays of points or vectors are templated on the
+	// element type: derived types as point3 have a different size from
+	// their base, so their arrays cannot be passed as base_point pointers
+	template<typename P>
+	struct components
+	{
+		static const std::size_t value = std::tuple_size<decltype(P::data)>::value;
+	};
+};
\ No newline at end of file
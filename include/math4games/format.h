@@ -0,0 +1,268 @@
+#pragma once
+
+/*
+	Text formatting and parsing
+	Vito Domenico Tagliente
+	math library for games
+*/
+
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <system_error>
+#include <vector>
+#include "vector.h"
+#include "point.h"
+#include "matrix.h"
+#include "quaternion.h"
+
+namespace math4games
+{
+	/*
+		Text representation: the components separated by a single space,
+		matrices row major, quaternions as x y z w. Floating point values
+		are written in the shortest form that parses back to the same value.
+		The functions mirror std::to_chars and std::from_chars: they write
+		into or read from caller buffers and never allocate.
+	*/
+
+	namespace detail
+	{
+		template<typename T>
+		std::to_chars_result format_scalars(char* first, char* last, const T* values, const std::size_t count) {
+			std::to_chars_result result{ first, std::errc() };
+			for (std::size_t i = 0; i < count; ++i) {
+				if (i > 0) {
+					if (result.ptr == last)
+						return { last, std::errc::value_too_large };
+					*result.ptr++ = ' ';
+				}
+				result = std::to_chars(result.ptr, last, values[i]);
+				if (result.ec != std::errc())
+					return result;
+			}
+			return result;
+		}
+
+		template<typename T>
+		std::from_chars_result parse_scalars(const char* first, const char* last, T* values, const std::size_t count) {
+			std::from_chars_result result{ first, std::errc() };
+			for (std::size_t i = 0; i < count; ++i) {
+				while (result.ptr != last && (*result.ptr == ' ' || *result.ptr == '\t'))
+					++result.ptr;
+				// from_chars does not accept a leading plus sign, skip it
+				// only before a number so that "+-1" or "+ 1" stay errors
+				if (result.ptr != last && *result.ptr == '+' && result.ptr + 1 != last
+					&& ((result.ptr[1] >= '0' && result.ptr[1] <= '9') || result.ptr[1] == '.'))
+					++result.ptr;
+				result = std::from_chars(result.ptr, last, values[i]);
+				if (result.ec != std::errc())
+					return result;
+			}
+			return result;
+		}
+	}
+
+	// formatting
+
+	template<std::size_t N, typename T>
+	std::to_chars_result to_chars(char* first, char* last, const base_vector<N, T>& v) {
+		return detail::format_scalars(first, last, v.data.data(), N);
+	}
+
+	template<std::size_t N, typename T>
+	std::to_chars_result to_chars(char* first, char* last, const base_point<N, T>& p) {
+		return detail::format_scalars(first, last, p.data.data(), N);
+	}
+
+	template<std::size_t N, std::size_t M, typename T>
+	std::to_chars_result to_chars(char* first, char* last, const base_matrix<N, M, T>& m) {
+		return detail::format_scalars(first, last, m.data.data(), N * M);
+	}
+
+	inline std::to_chars_result to_chars(char* first, char* last, const quaternion& q) {
+		const float values[4] = { q.v[0], q.v[1], q.v[2], q.w };
+		return detail::format_scalars(first, last, values, 4);
+	}
+
+	// parsing, leading spaces are skipped
+
+	template<std::size_t N, typename T>
+	std::from_chars_result from_chars(const char* first, const char* last, base_vector<N, T>& v) {
+		return detail::parse_scalars(first, last, v.data.data(), N);
+	}
+
+	template<std::size_t N, typename T>
+	std::from_chars_result from_chars(const char* first, const char* last, base_point<N, T>& p) {
+		return detail::parse_scalars(first, last, p.data.data(), N);
+	}
+
+	template<std::size_t N, std::size_t M, typename T>
+	std::from_chars_result from_chars(const char* first, const char* last, base_matrix<N, M, T>& m) {
+		return detail::parse_scalars(first, last, m.data.data(), N * M);
+	}
+
+	inline std::from_chars_result from_chars(const char* first, const char* last, quaternion& q) {
+		float values[4];
+		const std::from_chars_result result = detail::parse_scalars(first, last, values, 4);
+		if (result.ec == std::errc())
+			q = quaternion(values[0], values[1], values[2], values[3]);
+		return result;
+	}
+
+	// buffered writer of one value per line
+	struct text_writer
+	{
+		text_writer(std::FILE* file, const std::size_t buffer_size = 1 << 16)
+			: m_file(file), m_buffer(buffer_size), m_used(0), m_ok(file != nullptr) {}
+
+		~text_writer() {
+			flush();
+		}
+
+		text_writer(const text_writer&) = delete;
+		text_writer& operator= (const text_writer&) = delete;
+
+		template<typename T>
+		bool write(const T& value) {
+			for (int attempt = 0; attempt < 2; ++attempt) {
+				char* first = m_buffer.data() + m_used;
+				char* last = m_buffer.data() + m_buffer.size();
+				const std::to_chars_result result = to_chars(first, last, value);
+				if (result.ec == std::errc() && result.ptr != last) {
+					*result.ptr = '\n';
+					m_used = static_cast<std::size_t>(result.ptr + 1 - m_buffer.data());
+					return true;
+				}
+				// out of space, retry on an empty buffer
+				if (m_used == 0)
+					break;
+				flush();
+			}
+			return m_ok = false;
+		}
+
+		template<typename T>
+		bool write(const T* values, const std::size_t count) {
+			for (std::size_t i = 0; i < count; ++i) {
+				if (!write(values[i]))
+					return false;
+			}
+			return true;
+		}
+
+		bool flush() {
+			if (m_used > 0 && m_file != nullptr)
+				m_ok = std::fwrite(m_buffer.data(), 1, m_used, m_file) == m_used && m_ok;
+			m_used = 0;
+			return m_ok;
+		}
+
+		bool good() const {
+			return m_ok;
+		}
+
+	private:
+		std::FILE* m_file;
+		std::vector<char> m_buffer;
+		std::size_t m_used;
+		bool m_ok;
+	};
+
+	// buffered reader of one value per line, lines must fit in the buffer.
+	// A longer line, or a line with anything but spaces after the value,
+	// is an error: read returns false and good() becomes false
+	struct text_reader
+	{
+		text_reader(std::FILE* file, const std::size_t buffer_size = 1 << 16)
+			: m_file(file), m_buffer(buffer_size), m_begin(0), m_end(0), m_ok(true) {}
+
+		text_reader(const text_reader&) = delete;
+		text_reader& operator= (const text_reader&) = delete;
+
+		// false at the end of the file or on a malformed line
+		template<typename T>
+		bool read(T& value) {
+			const char* line;
+			std::size_t size;
+			if (!m_ok || !next_line(line, size))
+				return false;
+			const char* last = line + size;
+			const std::from_chars_result result = from_chars(line, last, value);
+			const char* rest = result.ptr;
+			while (rest != last && (*rest == ' ' || *rest == '\t'))
+				++rest;
+			return m_ok = result.ec == std::errc() && rest == last;
+		}
+
+		// read up to count values, return the number of values read
+		template<typename T>
+		std::size_t read(T* values, const std::size_t count) {
+			std::size_t i = 0;
+			while (i < count && read(values[i]))
+				++i;
+			return i;
+		}
+
+		// false after a malformed or too long line, true at the end of the file
+		bool good() const {
+			return m_ok;
+		}
+
+	private:
+		// next non empty line, without its terminator
+		bool next_line(const char*& line, std::size_t& size) {
+			for (;;) {
+				const char* first = m_buffer.data() + m_begin;
+				const char* newline = static_cast<const char*>(std::memchr(first, '\n', m_end - m_begin));
+				if (newline != nullptr) {
+					m_begin = static_cast<std::size_t>(newline - m_buffer.data()) + 1;
+				}
+				else if (refill()) {
+					continue;
+				}
+				else if (m_begin == 0 && m_end == m_buffer.size()) {
+					// a line longer than the buffer
+					m_begin = m_end;
+					return m_ok = false;
+				}
+				else if (m_begin < m_end) {
+					// last line without terminator
+					first = m_buffer.data() + m_begin;
+					newline = m_buffer.data() + m_end;
+					m_begin = m_end;
+				}
+				else {
+					return false;
+				}
+
+				line = first;
+				size = static_cast<std::size_t>(newline - first);
+				if (size > 0 && line[size - 1] == '\r')
+					--size;
+				if (size > 0)
+					return true;
+			}
+		}
+
+		// move the pending bytes to the front and read more, false at eof or when full
+		bool refill() {
+			if (m_file == nullptr)
+				return false;
+			std::memmove(m_buffer.data(), m_buffer.data() + m_begin, m_end - m_begin);
+			m_end -= m_begin;
+			m_begin = 0;
+			if (m_end == m_buffer.size())
+				return false;
+			const std::size_t n = std::fread(m_buffer.data() + m_end, 1, m_buffer.size() - m_end, m_file);
+			m_end += n;
+			return n > 0;
+		}
+
+		std::FILE* m_file;
+		std::vector<char> m_buffer;
+		std::size_t m_begin;
+		std::size_t m_end;
+		bool m_ok;
+	};
+};
\ No newline at end of file
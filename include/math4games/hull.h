@@ -0,0 +1,511 @@
+#pragma once
+
+/*
+	Convex hull
+	Vito Domenico Tagliente
+	math library for games
+*/
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "vector.h"
+#include "point.h"
+#include "sweep.h"
+#include "predicates.h"
+
+namespace math4games
+{
+	// hull edge line, the hull is behind it: normal * p <= distance
+	struct line2
+	{
+		vec2 normal;
+		float distance = 0.0f;
+
+		line2() = default;
+		line2(const vec2& _normal, const float _distance) : normal(_normal), distance(_distance) {}
+
+		// signed distance of p, positive outside
+		float signed_distance(const vec2& p) const {
+			return normal * p - distance;
+		}
+	};
+
+	// 2D hull, counter clockwise without collinear points. The k-th line
+	// is the edge from indices[k] to indices[k + 1]
+	struct hull2
+	{
+		std::vector<std::uint32_t> indices;
+		std::vector<line2> lines;
+
+		void clear() {
+			indices.clear();
+			lines.clear();
+		}
+	};
+
+	// 3D hull as triangles, counter clockwise seen from outside, with the
+	// plane of each one; vertices lists the points on the hull
+	struct hull3
+	{
+		std::vector<std::uint32_t> indices;
+		std::vector<plane> planes;
+		std::vector<std::uint32_t> vertices;
+
+		std::size_t faces() const {
+			return planes.size();
+		}
+
+		void clear() {
+			indices.clear();
+			planes.clear();
+			vertices.clear();
+		}
+	};
+
+	namespace detail
+	{
+		const std::uint32_t hull_none = 0xffffffffu;
+
+		struct hull_point2
+		{
+			float x, y;
+			std::uint32_t index;
+		};
+
+		struct hull_face
+		{
+			std::uint32_t v[3];
+			// face across the edge v[e], v[e + 1]
+			std::uint32_t neighbor[3];
+			// (v1 - v0) x (v2 - v0), rounded
+			double normal[3];
+			// outside set, linked through hull_workspace::next
+			std::uint32_t outside;
+			std::uint32_t furthest;
+			double furthest_distance;
+			std::uint32_t visit;
+			bool visible;
+		};
+
+		struct hull_horizon
+		{
+			std::uint32_t a, b, neighbor;
+		};
+	}
+
+	// buffers of the hull builders, kept between builds so that a
+	// workspace reused for every hull allocates only when an input is
+	// larger than the previous ones
+	struct hull_workspace
+	{
+		std::vector<detail::hull_point2> points2;
+		std::vector<std::uint32_t> chain;
+
+		std::vector<detail::hull_face> faces;
+		std::vector<std::uint32_t> unused;
+		std::vector<std::uint32_t> next;
+		std::vector<std::uint32_t> pending;
+		std::vector<std::uint32_t> visible;
+		std::vector<detail::hull_horizon> horizon;
+		std::vector<std::uint32_t> created;
+		std::vector<std::uint32_t> starts;
+	};
+
+	/*
+		Andrew's monotone chain. Points strictly inside the octagon of the
+		extremes along the axes and the diagonals are discarded first
+		(Akl-Toussaint), which leaves few points to sort. Returns false when
+		the points are all collinear, the hull then holds the end points
+	*/
+	template<typename P>
+	bool convex_hull(const P* points, const std::size_t count, hull2& result, hull_workspace& workspace) {
+		using detail::hull_point2;
+		result.clear();
+		if (count == 0)
+			return false;
+
+		// extremes along x, x + y, y, y - x and their opposites, in counter clockwise order
+		std::uint32_t extreme[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+		float best[8];
+		const float directions[8][2] = { { -1, 0 }, { -1, -1 }, { 0, -1 }, { 1, -1 }, { 1, 0 }, { 1, 1 }, { 0, 1 }, { -1, 1 } };
+		for (unsigned int i = 0; i < 8; ++i)
+			best[i] = directions[i][0] * points[0].data[0] + directions[i][1] * points[0].data[1];
+		for (std::size_t k = 1; k < count; ++k) {
+			const float x = points[k].data[0], y = points[k].data[1];
+			for (unsigned int i = 0; i < 8; ++i) {
+				const float d = directions[i][0] * x + directions[i][1] * y;
+				if (d > best[i]) {
+					best[i] = d;
+					extreme[i] = static_cast<std::uint32_t>(k);
+				}
+			}
+		}
+
+		// keep the points not strictly inside the octagon
+		std::vector<hull_point2>& sorted = workspace.points2;
+		sorted.clear();
+		for (std::size_t k = 0; k < count; ++k) {
+			const double x = points[k].data[0], y = points[k].data[1];
+			// an octagon without edges, all the points are the same, has no inside
+			bool inside = true, edges = false;
+			for (unsigned int i = 0; i < 8 && inside; ++i) {
+				const P& a = points[extreme[i]];
+				const P& b = points[extreme[(i + 1) % 8]];
+				if (a.data[0] == b.data[0] && a.data[1] == b.data[1])
+					continue;
+				edges = true;
+				inside = math4games::orient2d(a.data[0], a.data[1], b.data[0], b.data[1], x, y) > 0;
+			}
+			if (!inside || !edges)
+				sorted.push_back({ points[k].data[0], points[k].data[1], static_cast<std::uint32_t>(k) });
+		}
+		std::sort(sorted.begin(), sorted.end(), [](const hull_point2& a, const hull_point2& b) {
+			return a.x < b.x || (a.x == b.x && a.y < b.y);
+		});
+
+		// lower chain left to right, then upper chain right to left
+		std::vector<std::uint32_t>& chain = workspace.chain;
+		chain.clear();
+		auto turns_left = [&sorted, &chain](const hull_point2& c) {
+			const hull_point2& a = sorted[chain[chain.size() - 2]];
+			const hull_point2& b = sorted[chain.back()];
+			return math4games::orient2d(a.x, a.y, b.x, b.y, c.x, c.y) > 0;
+		};
+		for (std::size_t k = 0; k < sorted.size(); ++k) {
+			while (chain.size() >= 2 && !turns_left(sorted[k]))
+				chain.pop_back();
+			chain.push_back(static_cast<std::uint32_t>(k));
+		}
+		const std::size_t lower = chain.size() + 1;
+		for (std::size_t k = sorted.size() - 1; k-- > 0;) {
+			while (chain.size() >= lower && !turns_left(sorted[k]))
+				chain.pop_back();
+			chain.push_back(static_cast<std::uint32_t>(k));
+		}
+		// the last point closes the loop
+		if (chain.size() > 1)
+			chain.pop_back();
+		// all the points are the same
+		if (chain.size() == 2 && sorted[chain[0]].x == sorted[chain[1]].x && sorted[chain[0]].y == sorted[chain[1]].y)
+			chain.pop_back();
+
+		const std::size_t n = chain.size();
+		for (std::size_t k = 0; k < n; ++k)
+			result.indices.push_back(sorted[chain[k]].index);
+		if (n < 3)
+			return false;
+		for (std::size_t k = 0; k < n; ++k) {
+			const hull_point2& a = sorted[chain[k]];
+			const hull_point2& b = sorted[chain[(k + 1) % n]];
+			// outward normal of a counter clockwise edge
+			const double nx = b.y - a.y, ny = a.x - b.x;
+			const double length = std::sqrt(nx * nx + ny * ny);
+			result.lines.push_back(line2(vec2(static_cast<float>(nx / length), static_cast<float>(ny / length)),
+				static_cast<float>((nx * a.x + ny * a.y) / length)));
+		}
+		return true;
+	}
+
+	namespace detail
+	{
+		// sign of the position of p relative to face f, and the rounded
+		// distance scaled by the normal length in distance
+		template<typename P>
+		int hull_side(const hull_face& f, const P* points, const P& p, double& distance) {
+			const P& a = points[f.v[0]];
+			double r[3], bound = 0.0;
+			distance = 0.0;
+			for (unsigned int i = 0; i < 3; ++i) {
+				r[i] = static_cast<double>(p.data[i]) - a.data[i];
+				distance += f.normal[i] * r[i];
+				bound += std::fabs(f.normal[i] * r[i]);
+			}
+			// one rounding in each normal component and three in the dot product
+			bound *= 8.0 * DBL_EPSILON;
+			if (distance > bound)
+				return 1;
+			if (distance < -bound)
+				return -1;
+			return math4games::orient3d(a, points[f.v[1]], points[f.v[2]], p);
+		}
+
+		// face a, b, c, taken from the unused ones when possible
+		template<typename P>
+		std::uint32_t hull_add_face(std::vector<hull_face>& faces, std::vector<std::uint32_t>& unused, const P* points,
+			const std::uint32_t a, const std::uint32_t b, const std::uint32_t c) {
+			hull_face f;
+			f.v[0] = a;
+			f.v[1] = b;
+			f.v[2] = c;
+			f.neighbor[0] = f.neighbor[1] = f.neighbor[2] = hull_none;
+			double u[3], w[3];
+			for (unsigned int i = 0; i < 3; ++i) {
+				u[i] = static_cast<double>(points[b].data[i]) - points[a].data[i];
+				w[i] = static_cast<double>(points[c].data[i]) - points[a].data[i];
+			}
+			f.normal[0] = u[1] * w[2] - u[2] * w[1];
+			f.normal[1] = u[2] * w[0] - u[0] * w[2];
+			f.normal[2] = u[0] * w[1] - u[1] * w[0];
+			f.outside = hull_none;
+			f.furthest = hull_none;
+			f.furthest_distance = 0.0;
+			f.visit = 0;
+			f.visible = false;
+			if (unused.empty()) {
+				faces.push_back(f);
+				return static_cast<std::uint32_t>(faces.size() - 1);
+			}
+			const std::uint32_t index = unused.back();
+			unused.pop_back();
+			faces[index] = f;
+			return index;
+		}
+
+		// put p in the outside set of the first face it is strictly in front of
+		template<typename P>
+		void hull_assign(std::vector<hull_face>& faces, std::vector<std::uint32_t>& next, const P* points,
+			const std::uint32_t p, const std::uint32_t* candidates, const std::size_t count) {
+			for (std::size_t i = 0; i < count; ++i) {
+				hull_face& f = faces[candidates[i]];
+				double d;
+				if (hull_side(f, points, points[p], d) > 0) {
+					next[p] = f.outside;
+					f.outside = p;
+					if (f.furthest == hull_none || d > f.furthest_distance) {
+						f.furthest_distance = d;
+						f.furthest = p;
+					}
+					return;
+				}
+			}
+		}
+	}
+
+	/*
+		Quickhull: starting from a tetrahedron, each step takes the furthest
+		point outside a face, removes the faces it sees and connects their
+		horizon to it. Visibility uses the exact orientation sign, so the
+		seen faces always form a disk and the hull stays convex on coplanar,
+		duplicate and nearly degenerate inputs. Points on a face are not hull
+		vertices and coplanar regions come out as several triangles. Returns
+		false when the points are all coplanar
+	*/
+	template<typename P>
+	bool convex_hull(const P* points, const std::size_t count, hull3& result, hull_workspace& workspace) {
+		using detail::hull_face;
+		using detail::hull_none;
+		result.clear();
+		if (count < 4)
+			return false;
+
+		// initial tetrahedron: the furthest extremes along the axes, then the
+		// furthest points from their line and from the plane of the three
+		std::uint32_t extreme[6] = { 0, 0, 0, 0, 0, 0 };
+		for (unsigned int i = 0; i < 3; ++i) {
+			for (std::size_t k = 1; k < count; ++k) {
+				if (points[k].data[i] < points[extreme[i * 2]].data[i])
+					extreme[i * 2] = static_cast<std::uint32_t>(k);
+				if (points[k].data[i] > points[extreme[i * 2 + 1]].data[i])
+					extreme[i * 2 + 1] = static_cast<std::uint32_t>(k);
+			}
+		}
+		auto difference = [points](const std::uint32_t a, const std::size_t b, double (&d)[3]) {
+			for (unsigned int i = 0; i < 3; ++i)
+				d[i] = static_cast<double>(points[b].data[i]) - points[a].data[i];
+		};
+		std::uint32_t v0 = extreme[0], v1 = extreme[1];
+		double best = 0.0;
+		for (unsigned int i = 0; i < 6; ++i)
+			for (unsigned int j = i + 1; j < 6; ++j) {
+				double d[3];
+				difference(extreme[i], extreme[j], d);
+				const double d2 = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+				if (d2 > best) {
+					best = d2;
+					v0 = extreme[i];
+					v1 = extreme[j];
+				}
+			}
+		if (best == 0.0)
+			return false;
+
+		std::uint32_t v2 = hull_none;
+		best = 0.0;
+		double line[3];
+		difference(v0, v1, line);
+		for (std::size_t k = 0; k < count; ++k) {
+			double e[3];
+			difference(v0, k, e);
+			const double c[3] = { line[1] * e[2] - line[2] * e[1], line[2] * e[0] - line[0] * e[2], line[0] * e[1] - line[1] * e[0] };
+			const double r = c[0] * c[0] + c[1] * c[1] + c[2] * c[2];
+			if (r > best) {
+				best = r;
+				v2 = static_cast<std::uint32_t>(k);
+			}
+		}
+		if (v2 == hull_none)
+			return false;
+
+		std::vector<hull_face>& faces = workspace.faces;
+		std::vector<std::uint32_t>& unused = workspace.unused;
+		faces.clear();
+		unused.clear();
+		detail::hull_add_face(faces, unused, points, v0, v1, v2);
+		std::uint32_t v3 = hull_none;
+		best = 0.0;
+		for (std::size_t k = 0; k < count; ++k) {
+			double d;
+			detail::hull_side(faces[0], points, points[k], d);
+			if (std::fabs(d) > best) {
+				best = std::fabs(d);
+				v3 = static_cast<std::uint32_t>(k);
+			}
+		}
+		double d3;
+		const int side = v3 == hull_none ? 0 : detail::hull_side(faces[0], points, points[v3], d3);
+		if (side == 0)
+			return false;
+
+		// faces oriented away from the vertex they miss
+		faces.clear();
+		{
+			const std::uint32_t tetrahedron[4][3] = { { v0, v1, v2 }, { v0, v3, v1 }, { v1, v3, v2 }, { v2, v3, v0 } };
+			for (unsigned int i = 0; i < 4; ++i) {
+				if (side < 0)
+					detail::hull_add_face(faces, unused, points, tetrahedron[i][0], tetrahedron[i][1], tetrahedron[i][2]);
+				else
+					detail::hull_add_face(faces, unused, points, tetrahedron[i][0], tetrahedron[i][2], tetrahedron[i][1]);
+			}
+		}
+		for (std::uint32_t f = 0; f < 4; ++f)
+			for (unsigned int e = 0; e < 3; ++e)
+				for (std::uint32_t g = 0; g < 4; ++g)
+					for (unsigned int h = 0; h < 3; ++h)
+						if (faces[g].v[h] == faces[f].v[(e + 1) % 3] && faces[g].v[(h + 1) % 3] == faces[f].v[e])
+							faces[f].neighbor[e] = g;
+
+		std::vector<std::uint32_t>& next = workspace.next;
+		next.assign(count, hull_none);
+		const std::uint32_t initial[4] = { 0, 1, 2, 3 };
+		for (std::size_t k = 0; k < count; ++k) {
+			const std::uint32_t p = static_cast<std::uint32_t>(k);
+			if (p != v0 && p != v1 && p != v2 && p != v3)
+				detail::hull_assign(faces, next, points, p, initial, 4);
+		}
+
+		std::vector<std::uint32_t>& pending = workspace.pending;
+		std::vector<std::uint32_t>& visible = workspace.visible;
+		std::vector<detail::hull_horizon>& horizon = workspace.horizon;
+		std::vector<std::uint32_t>& created = workspace.created;
+		std::vector<std::uint32_t>& starts = workspace.starts;
+		starts.assign(count, hull_none);
+		pending.assign(initial, initial + 4);
+		std::uint32_t visit = 0;
+
+		while (!pending.empty()) {
+			const std::uint32_t first = pending.back();
+			pending.pop_back();
+			// removed faces have no outside points
+			if (faces[first].outside == hull_none)
+				continue;
+			const std::uint32_t eye = faces[first].furthest;
+
+			// faces seen from the eye and the horizon around them
+			++visit;
+			visible.clear();
+			horizon.clear();
+			visible.push_back(first);
+			faces[first].visit = visit;
+			faces[first].visible = true;
+			for (std::size_t i = 0; i < visible.size(); ++i) {
+				const std::uint32_t f = visible[i];
+				for (unsigned int e = 0; e < 3; ++e) {
+					const std::uint32_t n = faces[f].neighbor[e];
+					hull_face& neighbor = faces[n];
+					if (neighbor.visit != visit) {
+						neighbor.visit = visit;
+						double d;
+						neighbor.visible = detail::hull_side(neighbor, points, points[eye], d) > 0;
+						if (neighbor.visible)
+							visible.push_back(n);
+					}
+					if (!neighbor.visible)
+						horizon.push_back({ faces[f].v[e], faces[f].v[(e + 1) % 3], n });
+				}
+			}
+
+			// cone of new faces from the horizon to the eye, the seen faces
+			// are recycled only after their points moved
+			created.clear();
+			for (const detail::hull_horizon& edge : horizon) {
+				const std::uint32_t f = detail::hull_add_face(faces, unused, points, edge.a, edge.b, eye);
+				faces[f].neighbor[0] = edge.neighbor;
+				hull_face& neighbor = faces[edge.neighbor];
+				for (unsigned int e = 0; e < 3; ++e)
+					if (neighbor.v[e] == edge.b && neighbor.v[(e + 1) % 3] == edge.a)
+						neighbor.neighbor[e] = f;
+				starts[edge.a] = f;
+				created.push_back(f);
+			}
+			for (const std::uint32_t f : created) {
+				// the face starting where this one ends shares the edge to the eye
+				const std::uint32_t g = starts[faces[f].v[1]];
+				faces[f].neighbor[1] = g;
+				faces[g].neighbor[2] = f;
+			}
+
+			for (const std::uint32_t f : visible) {
+				std::uint32_t p = faces[f].outside;
+				while (p != hull_none) {
+					const std::uint32_t following = next[p];
+					if (p != eye)
+						detail::hull_assign(faces, next, points, p, created.data(), created.size());
+					p = following;
+				}
+				faces[f].outside = hull_none;
+				faces[f].visible = false;
+				faces[f].v[0] = hull_none;
+				unused.push_back(f);
+			}
+			for (const std::uint32_t f : created)
+				if (faces[f].outside != hull_none)
+					pending.push_back(f);
+		}
+
+		// collect the faces and their vertices
+		for (const hull_face& f : faces) {
+			if (f.v[0] == hull_none)
+				continue;
+			for (unsigned int i = 0; i < 3; ++i) {
+				result.indices.push_back(f.v[i]);
+				if (starts[f.v[i]] != hull_none - 1) {
+					starts[f.v[i]] = hull_none - 1;
+					result.vertices.push_back(f.v[i]);
+				}
+			}
+			const double length = std::sqrt(f.normal[0] * f.normal[0] + f.normal[1] * f.normal[1] + f.normal[2] * f.normal[2]);
+			const P& a = points[f.v[0]];
+			const double n[3] = { f.normal[0] / length, f.normal[1] / length, f.normal[2] / length };
+			result.planes.push_back(plane(vec3(static_cast<float>(n[0]), static_cast<float>(n[1]), static_cast<float>(n[2])),
+				static_cast<float>(n[0] * a.data[0] + n[1] * a.data[1] + n[2] * a.data[2])));
+		}
+		return true;
+	}
+
+	// hulls with a temporary workspace
+	template<typename P>
+	bool convex_hull(const P* points, const std::size_t count, hull2& result) {
+		hull_workspace workspace;
+		return convex_hull(points, count, result, workspace);
+	}
+
+	template<typename P>
+	bool convex_hull(const P* points, const std::size_t count, hull3& result) {
+		hull_workspace workspace;
+		return convex_hull(points, count, result, workspace);
+	}
+};
\ No newline at end of file
@@ -7,11 +7,35 @@ vitodomenicotagliente@gmail.com
 */
 
 #include "common.h"
+#include "element.h"
 #include "vector.h"
 #include "point.h"
 #include "matrix.h"
 #include "transformation.h"
 #include "quaternion.h"
+#include "eigen.h"
+#include "svd.h"
+#include "soa.h"
+#include "animation.h"
+#include "spline.h"
+#include "memory.h"
+#include "binary.h"
+#include "format.h"
+#include "world.h"
+#include "parallel.h"
+#include "spatial.h"
+#include "random.h"
+#include "noise.h"
+#include "convex.h"
+#include "sweep.h"
+#include "particles.h"
+#include "skinning.h"
+#include "camera.h"
+#include "predicates.h"
+#include "hull.h"
+#include "delaunay.h"
+#include "snapshot.h"
+#include "bulk.h"
 #include "debug.h"
 
 // namespace alias
@@ -10,6 +10,19 @@
 
 namespace math4games
 {
+	// forward declarations
+	template<std::size_t N, std::size_t M, class T>
+	struct base_matrix;
+
+	template<std::size_t N, std::size_t M, typename T>
+	T determinant(const base_matrix<N, M, T>& m);
+
+	template<typename T>
+	T determinant(const base_matrix<2, 2, T>& m);
+
+	template<typename T>
+	T determinant(const base_matrix<3, 3, T>& m);
+
 	template<std::size_t N, std::size_t M, class T>
 	struct base_matrix
 	{
@@ -19,7 +32,7 @@ namespace math4games
 		const std::size_t columns = M;
 
 		// store data into a managed array
-		std::array<T, N * M> data;
+		alignas(storage_alignment<N * M, T>::value) std::array<T, N * M> data;
 
 		// default constructor
 		base_matrix() {
@@ -83,11 +96,13 @@ namespace math4games
 
 		// get (i,j) element
 		T& operator() (const unsigned int i, const unsigned int j) {
-			return data.at(i + j * columns);
+			MATH4GAMES_COUNT("element access", profile::type_name<T>(N, M), 0);
+			return detail::element(data, i + j * M);
 		}
 
 		T operator() (const unsigned int i, const unsigned int j) const {
-			return data.at(i + j * columns);
+			MATH4GAMES_COUNT("element access", profile::type_name<T>(N, M), 0);
+			return detail::element(data, i + j * M);
 		}
 		
 		// determinant 
@@ -101,10 +116,10 @@ namespace math4games
 			assert(x < columns && y < rows);
 			base_matrix<N - 1, M - 1, T> result;
 
-			for (unsigned int j = 0, _j = 0; j < rows; ++j)
+			for (unsigned int j = 0, _j = 0; j < N; ++j)
 			{
 				if (j == y) continue;
-				for (unsigned int i = 0, _i = 0; i < columns; ++i)
+				for (unsigned int i = 0, _i = 0; i < M; ++i)
 				{
 					if (i == x) continue;
 					result(_i, _j) = (*this)(i, j);
@@ -117,9 +132,10 @@ namespace math4games
 
 		// transpose matrix
 		base_matrix<M, N, T> transpose() const {
+			MATH4GAMES_COUNT("transpose", profile::type_name<T>(N, M), 0);
 			base_matrix<M, N, T> MT;
-			for (unsigned int j = 0; j < rows; j++) {
-				for (unsigned int i = 0; i < columns; i++) {
+			for (unsigned int j = 0; j < N; j++) {
+				for (unsigned int i = 0; i < M; i++) {
 					MT(i, j) = (*this)(j, i);
 				}
 			}
@@ -128,8 +144,9 @@ namespace math4games
 
 		// inverse matrix
 		base_matrix<N, M, T> inverse(bool& invertible) const {
+			MATH4GAMES_COUNT("inverse", profile::type_name<T>(N, M), N * M + 1);
 			invertible = false;
-			T d = determinant(*this);
+			T d = math4games::determinant(*this);
 			if (d != static_cast<T>(0.0)) {
 				invertible = true;
 				return adjugate() / d;
@@ -139,11 +156,12 @@ namespace math4games
 
 		// adjugate matrix
 		base_matrix<N, M, T> adjugate() const {
+			MATH4GAMES_COUNT("adjugate", profile::type_name<T>(N, M), N * M);
 			base_matrix<N, M, T> result;
 			for (unsigned int j = 0; j < rows; ++j) {
 				for (unsigned int i = 0; i < columns; ++i) {
 					base_matrix<N - 1, M - 1, T> currentMinor = minor(i, j);
-					result(j, i) = static_cast<T>(std::pow(-1, i + 1))*currentMinor.determinant();
+					result(j, i) = static_cast<T>(std::pow(-1, i + j))*currentMinor.determinant();
 				}
 			}
 			return result;
@@ -231,6 +249,7 @@ namespace math4games
 	// matrix x matrix operation
 	template<std::size_t N, std::size_t M, std::size_t K, typename T>
 	base_matrix<N, K, T> operator* (const base_matrix<N, M, T>& m1, const base_matrix<M, K, T>& m2) {
+		MATH4GAMES_COUNT("matrix * matrix", profile::type_name<T>(N, M) + " * " + profile::type_name<T>(M, K), 2 * N * M * K);
 		base_matrix<N, K, T> result;
 		for (unsigned int j = 0; j < N; ++j) {
 			for (unsigned int y = 0; y < K; ++y) {
@@ -247,6 +266,7 @@ namespace math4games
 	// matrix x column vector operation 
 	template<std::size_t N, std::size_t M, typename T>
 	base_vector<N, T> operator* (const base_matrix<N, M, T>& m, const base_vector<M, T>& v) {
+		MATH4GAMES_COUNT("matrix * vector", profile::type_name<T>(N, M), 2 * N * M);
 		base_vector<N, T> result;
 		for (unsigned int j = 0; j < N; ++j) {
 			T value{};
@@ -262,12 +282,13 @@ namespace math4games
 	template<std::size_t N, std::size_t M, typename T>
 	T determinant(const base_matrix<N, M, T>& m)
 	{
+		MATH4GAMES_COUNT("determinant", profile::type_name<T>(N, M), 2 * M);
 		/* Laplace law */
 		int j = 0;
 		T result{};
 		for (unsigned int i = 0; i < M; ++i) {
 			auto minor = m.minor(i, j);
-			result += std::pow(-1, i + j)*determinant_algorithm(minor);
+			result += static_cast<T>(std::pow(-1, i + j))*m(i, j)*determinant(minor);
 		}
 		return result;
 	}
@@ -305,10 +326,14 @@ namespace math4games
 	template<typename T>
 	T determinant(const base_matrix<3, 3, T>& m)
 	{
+		MATH4GAMES_COUNT("determinant", profile::type_name<T>(3, 3), 17);
 		// Sarrus law
-		return (m.data[0] * m.data[4] * m.data[8]) -
-			(m.data[1] * m.data[5] * m.data[6]) -
-			(m.data[2] * m.data[3] * m.data[7]);
+		return (m.data[0] * m.data[4] * m.data[8]) +
+			(m.data[1] * m.data[5] * m.data[6]) +
+			(m.data[2] * m.data[3] * m.data[7]) -
+			(m.data[2] * m.data[4] * m.data[6]) -
+			(m.data[1] * m.data[3] * m.data[8]) -
+			(m.data[0] * m.data[5] * m.data[7]);
 	}
 
 	// undefined order zero matrix
@@ -337,6 +362,7 @@ namespace math4games
 		using base_matrix<2, 2, T>::base_matrix;
 
 		base_matrix2() :base_matrix<2, 2, T>() {}
+		base_matrix2(const base_matrix2&) = default;
 
 		base_matrix2& operator= (const base_matrix2& other) {
 			base_matrix<2, 2, T>::data = other.data;
@@ -358,6 +384,7 @@ namespace math4games
 		using base_matrix<3, 3, T>::base_matrix;
 
 		base_matrix3() :base_matrix<3, 3, T>() {}
+		base_matrix3(const base_matrix3&) = default;
 
 		base_matrix3& operator= (const base_matrix3& other) {
 			base_matrix<3, 3, T>::data = other.data;
@@ -386,6 +413,7 @@ namespace math4games
 		using base_matrix<4, 4, T>::base_matrix;
 
 		base_matrix4() :base_matrix<4, 4, T>() {}
+		base_matrix4(const base_matrix4&) = default;
 
 		base_matrix4& operator= (const base_matrix4& other) {
 			base_matrix<4, 4, T>::data = other.data;
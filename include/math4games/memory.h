@@ -0,0 +1,123 @@
+#pragma once
+
+/*
+	Aligned storage and scratch allocation
+	Vito Domenico Tagliente
+	math library for games
+*/
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace math4games
+{
+	// default alignment for simd friendly storage, one cache line
+	const std::size_t simd_alignment = 64;
+
+	// std allocator returning Alignment aligned storage
+	template<typename T, std::size_t Alignment = simd_alignment>
+	struct aligned_allocator
+	{
+		static_assert(Alignment >= alignof(T), "alignment lower than the type alignment");
+		static_assert((Alignment & (Alignment - 1)) == 0, "alignment must be a power of two");
+
+		typedef T value_type;
+
+		template<typename U>
+		struct rebind
+		{
+			typedef aligned_allocator<U, Alignment> other;
+		};
+
+		aligned_allocator() = default;
+
+		template<typename U>
+		aligned_allocator(const aligned_allocator<U, Alignment>&) {}
+
+		T* allocate(const std::size_t n) {
+			return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+		}
+
+		void deallocate(T* p, const std::size_t) {
+			::operator delete(p, std::align_val_t(Alignment));
+		}
+
+		template<typename U>
+		bool operator== (const aligned_allocator<U, Alignment>&) const {
+			return true;
+		}
+
+		template<typename U>
+		bool operator!= (const aligned_allocator<U, Alignment>&) const {
+			return false;
+		}
+	};
+
+	// vector with aligned storage, e.g. aligned_vector<vec4> or aligned_vector<float>
+	template<typename T, std::size_t Alignment = simd_alignment>
+	using aligned_vector = std::vector<T, aligned_allocator<T, Alignment>>;
+
+	// bump allocator for per frame scratch arrays.
+	// Allocation moves an offset into a fixed buffer, reset() releases
+	// everything at once in O(1). Objects are never destroyed, so only
+	// trivially destructible types (all the math types) can be allocated
+	struct arena
+	{
+		arena(const std::size_t capacity)
+			: m_capacity(capacity), m_offset(0) {
+			m_buffer = static_cast<unsigned char*>(::operator new(capacity, std::align_val_t(simd_alignment)));
+		}
+
+		~arena() {
+			::operator delete(m_buffer, std::align_val_t(simd_alignment));
+		}
+
+		arena(const arena&) = delete;
+		arena& operator= (const arena&) = delete;
+
+		// raw storage, nullptr when the arena is exhausted
+		void* allocate(const std::size_t size, const std::size_t alignment = simd_alignment) {
+			assert((alignment & (alignment - 1)) == 0 && alignment <= simd_alignment);
+			const std::size_t offset = (m_offset + alignment - 1) & ~(alignment - 1);
+			if (offset + size > m_capacity)
+				return nullptr;
+			m_offset = offset + size;
+			return m_buffer + offset;
+		}
+
+		// count default constructed objects, nullptr when the arena is exhausted
+		template<typename T>
+		T* allocate(const std::size_t count, const std::size_t alignment = simd_alignment) {
+			static_assert(std::is_trivially_destructible<T>::value, "arena objects are never destroyed");
+			T* p = static_cast<T*>(allocate(count * sizeof(T), alignment < alignof(T) ? alignof(T) : alignment));
+			if (p != nullptr) {
+				for (std::size_t i = 0; i < count; ++i)
+					new (p + i) T();
+			}
+			return p;
+		}
+
+		// release every allocation
+		void reset() {
+			m_offset = 0;
+		}
+
+		// bytes in use
+		std::size_t size() const {
+			return m_offset;
+		}
+
+		std::size_t capacity() const {
+			return m_capacity;
+		}
+
+	private:
+		unsigned char* m_buffer;
+		std::size_t m_capacity;
+		std::size_t m_offset;
+	};
+};
\ No newline at end of file
@@ -0,0 +1,503 @@
+#pragma once
+
+/*
+	Gradient noise
+	Vito Domenico Tagliente
+	math library for games
+*/
+
+#include <cmath>
+#include <cstdint>
+#include "vector.h"
+#include "soa.h"
+#include "parallel.h"
+
+namespace math4games
+{
+	/*
+		Perlin and simplex noise in 2, 3 and 4 dimensions, with analytic
+		gradients. Lattice gradients come from an integer hash of the cell
+		and the seed instead of a permutation table, so the noise has no
+		period and, given the same floating point settings (no fast math,
+		same fp contraction), the same output on every machine.
+		Values are roughly in [-1, 1].
+
+		The kernels evaluate Lanes points at once, every step is a loop
+		over the lanes without data dependent branches so that the
+		compiler vectorizes it. Single points are evaluated with one lane,
+		the bulk functions of fractal_noise use 8.
+	*/
+
+	enum class noise_type
+	{
+		perlin,
+		simplex
+	};
+
+	namespace detail
+	{
+		// lattice hashing: the coordinates are multiplied by per axis
+		// constants, xored with the seed and then mixed
+		const std::uint32_t lattice_primes[4] = { 0x8da6b343u, 0xd8163841u, 0xcb1ab31fu, 0x165667b1u };
+
+		inline std::uint32_t lattice_seed(const std::uint32_t seed) {
+			return seed * 0x27d4eb2du;
+		}
+
+		inline std::uint32_t lattice_mix(std::uint32_t h) {
+			h ^= h >> 16;
+			h *= 0x7feb352du;
+			h ^= h >> 15;
+			h *= 0x846ca68bu;
+			h ^= h >> 16;
+			return h;
+		}
+
+		// lattice gradients, picked by the top bits of the hash: the 8
+		// directions of the square, the 12 edges of the cube (4 repeated to
+		// fill 16) and the 32 edges of the tesseract. A table lookup is much
+		// cheaper than building the components from the hash bits
+		const float lattice_gradients2[8][2] = {
+			{ 1, 1 }, { -1, 1 }, { 1, -1 }, { -1, -1 },
+			{ 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 }
+		};
+
+		const float lattice_gradients3[16][3] = {
+			{ 1, 1, 0 }, { -1, 1, 0 }, { 1, -1, 0 }, { -1, -1, 0 },
+			{ 1, 0, 1 }, { -1, 0, 1 }, { 1, 0, -1 }, { -1, 0, -1 },
+			{ 0, 1, 1 }, { 0, -1, 1 }, { 0, 1, -1 }, { 0, -1, -1 },
+			{ 1, 1, 0 }, { -1, 1, 0 }, { 0, -1, 1 }, { 0, -1, -1 }
+		};
+
+		const float lattice_gradients4[32][4] = {
+			{ 0, 1, 1, 1 }, { 0, 1, 1, -1 }, { 0, 1, -1, 1 }, { 0, 1, -1, -1 },
+			{ 0, -1, 1, 1 }, { 0, -1, 1, -1 }, { 0, -1, -1, 1 }, { 0, -1, -1, -1 },
+			{ 1, 0, 1, 1 }, { 1, 0, 1, -1 }, { 1, 0, -1, 1 }, { 1, 0, -1, -1 },
+			{ -1, 0, 1, 1 }, { -1, 0, 1, -1 }, { -1, 0, -1, 1 }, { -1, 0, -1, -1 },
+			{ 1, 1, 0, 1 }, { 1, 1, 0, -1 }, { 1, -1, 0, 1 }, { 1, -1, 0, -1 },
+			{ -1, 1, 0, 1 }, { -1, 1, 0, -1 }, { -1, -1, 0, 1 }, { -1, -1, 0, -1 },
+			{ 1, 1, 1, 0 }, { 1, 1, -1, 0 }, { 1, -1, 1, 0 }, { 1, -1, -1, 0 },
+			{ -1, 1, 1, 0 }, { -1, 1, -1, 0 }, { -1, -1, 1, 0 }, { -1, -1, -1, 0 }
+		};
+
+		template<std::size_t D> const float* lattice_gradient(std::uint32_t h);
+		template<> inline const float* lattice_gradient<2>(const std::uint32_t h) { return lattice_gradients2[h >> 29]; }
+		template<> inline const float* lattice_gradient<3>(const std::uint32_t h) { return lattice_gradients3[h >> 28]; }
+		template<> inline const float* lattice_gradient<4>(const std::uint32_t h) { return lattice_gradients4[h >> 27]; }
+
+		// normalization to about [-1, 1]
+		template<std::size_t D> struct noise_scale;
+		template<> struct noise_scale<2> { static constexpr float perlin = 1.0f; static constexpr float simplex = 70.0f; };
+		template<> struct noise_scale<3> { static constexpr float perlin = 1.0f; static constexpr float simplex = 76.0f; };
+		template<> struct noise_scale<4> { static constexpr float perlin = 0.88f; static constexpr float simplex = 62.0f; };
+
+		// multilinear blend of the 2^D corner ramps with the quintic fade
+		template<std::size_t D, bool Gradient, std::size_t Lanes>
+		void perlin(const float (&p)[D][Lanes], float (&value)[Lanes], float (&gradient)[D][Lanes], const std::uint32_t seed) {
+			// per axis terms of the low and high lattice coordinate: hash,
+			// offset from the coordinate, fade weight and its derivative
+			std::uint32_t axis_hash[D][2][Lanes];
+			float offset[D][2][Lanes], weight[D][2][Lanes], dweight[D][2][Lanes];
+			for (std::size_t i = 0; i < D; ++i) {
+				for (std::size_t l = 0; l < Lanes; ++l) {
+					const float fl = std::floor(p[i][l]);
+					const std::uint32_t cell = static_cast<std::uint32_t>(static_cast<int>(fl));
+					const float t = p[i][l] - fl;
+					const float u = t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+					const float du = 30.0f * t * t * (t * (t - 2.0f) + 1.0f);
+					axis_hash[i][0][l] = cell * lattice_primes[i];
+					axis_hash[i][1][l] = (cell + 1) * lattice_primes[i];
+					offset[i][0][l] = t;
+					offset[i][1][l] = t - 1.0f;
+					weight[i][0][l] = 1.0f - u;
+					weight[i][1][l] = u;
+					dweight[i][0][l] = -du;
+					dweight[i][1][l] = du;
+					if (Gradient)
+						gradient[i][l] = 0.0f;
+				}
+			}
+
+			const std::uint32_t seed_hash = lattice_seed(seed);
+			for (std::size_t l = 0; l < Lanes; ++l)
+				value[l] = 0.0f;
+
+			// the corner is the same for every lane, only its table rows change
+			for (std::uint32_t c = 0; c < (1u << D); ++c) {
+				std::uint32_t h[Lanes];
+				float w[Lanes], dot[Lanes];
+				float g[D][Lanes];
+				for (std::size_t l = 0; l < Lanes; ++l) {
+					h[l] = seed_hash;
+					w[l] = 1.0f;
+					dot[l] = 0.0f;
+				}
+				for (std::size_t i = 0; i < D; ++i) {
+					const std::uint32_t high = (c >> i) & 1;
+					for (std::size_t l = 0; l < Lanes; ++l) {
+						h[l] ^= axis_hash[i][high][l];
+						w[l] *= weight[i][high][l];
+					}
+				}
+				for (std::size_t l = 0; l < Lanes; ++l) {
+					const float* gradient_row = lattice_gradient<D>(lattice_mix(h[l]));
+					for (std::size_t i = 0; i < D; ++i)
+						g[i][l] = gradient_row[i];
+				}
+				for (std::size_t i = 0; i < D; ++i) {
+					const std::uint32_t high = (c >> i) & 1;
+					for (std::size_t l = 0; l < Lanes; ++l)
+						dot[l] += g[i][l] * offset[i][high][l];
+				}
+				for (std::size_t l = 0; l < Lanes; ++l)
+					value[l] += w[l] * dot[l];
+
+				if (Gradient) {
+					for (std::size_t j = 0; j < D; ++j) {
+						float dw[Lanes];
+						for (std::size_t l = 0; l < Lanes; ++l)
+							dw[l] = dweight[j][(c >> j) & 1][l];
+						for (std::size_t i = 0; i < D; ++i) {
+							if (i == j)
+								continue;
+							const std::uint32_t high = (c >> i) & 1;
+							for (std::size_t l = 0; l < Lanes; ++l)
+								dw[l] *= weight[i][high][l];
+						}
+						for (std::size_t l = 0; l < Lanes; ++l)
+							gradient[j][l] += w[l] * g[j][l] + dw[l] * dot[l];
+					}
+				}
+			}
+
+			for (std::size_t l = 0; l < Lanes; ++l) {
+				value[l] *= noise_scale<D>::perlin;
+				if (Gradient) {
+					for (std::size_t i = 0; i < D; ++i)
+						gradient[i][l] *= noise_scale<D>::perlin;
+				}
+			}
+		}
+
+		// skew factors (sqrt(D + 1) - 1) / D and (1 - 1 / sqrt(D + 1)) / D.
+		// The corner kernels have squared radius 0.5, which keeps the
+		// noise continuous in every dimension
+		template<std::size_t D> struct simplex_factors;
+		template<> struct simplex_factors<2> { static constexpr float f = 0.36602540f; static constexpr float g = 0.21132487f; };
+		template<> struct simplex_factors<3> { static constexpr float f = 0.33333333f; static constexpr float g = 0.16666667f; };
+		template<> struct simplex_factors<4> { static constexpr float f = 0.30901699f; static constexpr float g = 0.13819660f; };
+
+		// sum of the radial kernels (0.5 - |d|^2)^4 (g . d) of the D + 1 simplex corners
+		template<std::size_t D, bool Gradient, std::size_t Lanes>
+		void simplex(const float (&p)[D][Lanes], float (&value)[Lanes], float (&gradient)[D][Lanes], const std::uint32_t seed) {
+			typedef simplex_factors<D> factors;
+
+			// skew to the lattice of hypercubes and find the cell
+			float s[Lanes], t[Lanes];
+			for (std::size_t l = 0; l < Lanes; ++l) {
+				s[l] = 0.0f;
+				t[l] = 0.0f;
+				value[l] = 0.0f;
+			}
+			for (std::size_t i = 0; i < D; ++i) {
+				for (std::size_t l = 0; l < Lanes; ++l)
+					s[l] += p[i][l];
+			}
+			int cell[D][Lanes];
+			for (std::size_t i = 0; i < D; ++i) {
+				for (std::size_t l = 0; l < Lanes; ++l) {
+					cell[i][l] = static_cast<int>(std::floor(p[i][l] + s[l] * factors::f));
+					t[l] += static_cast<float>(cell[i][l]);
+				}
+			}
+			float x0[D][Lanes];
+			for (std::size_t i = 0; i < D; ++i) {
+				for (std::size_t l = 0; l < Lanes; ++l)
+					x0[i][l] = p[i][l] - (static_cast<float>(cell[i][l]) - t[l] * factors::g);
+			}
+
+			// rank of each axis, the simplex walks the axes from the largest offset
+			std::uint32_t rank[D][Lanes] = {};
+			for (std::size_t i = 0; i < D; ++i) {
+				for (std::size_t j = i + 1; j < D; ++j) {
+					for (std::size_t l = 0; l < Lanes; ++l) {
+						const std::uint32_t greater = x0[i][l] > x0[j][l];
+						rank[i][l] += greater;
+						rank[j][l] += 1 - greater;
+					}
+				}
+			}
+
+			if (Gradient) {
+				for (std::size_t i = 0; i < D; ++i) {
+					for (std::size_t l = 0; l < Lanes; ++l)
+						gradient[i][l] = 0.0f;
+				}
+			}
+
+			const std::uint32_t seed_hash = lattice_seed(seed);
+			for (std::uint32_t k = 0; k <= D; ++k) {
+				std::uint32_t h[Lanes];
+				float r[Lanes], dot[Lanes];
+				float d[D][Lanes];
+				for (std::size_t l = 0; l < Lanes; ++l) {
+					h[l] = seed_hash;
+					r[l] = 0.5f;
+					dot[l] = 0.0f;
+				}
+				for (std::size_t i = 0; i < D; ++i) {
+					for (std::size_t l = 0; l < Lanes; ++l) {
+						const std::uint32_t offset = rank[i][l] + k >= D;
+						h[l] ^= static_cast<std::uint32_t>(cell[i][l] + static_cast<int>(offset)) * lattice_primes[i];
+						d[i][l] = x0[i][l] - static_cast<float>(offset) + static_cast<float>(k) * factors::g;
+						r[l] -= d[i][l] * d[i][l];
+					}
+				}
+				float g[D][Lanes];
+				for (std::size_t l = 0; l < Lanes; ++l) {
+					h[l] = lattice_mix(h[l]);
+					r[l] = r[l] > 0.0f ? r[l] : 0.0f;
+				}
+				for (std::size_t l = 0; l < Lanes; ++l) {
+					const float* gradient_row = lattice_gradient<D>(h[l]);
+					for (std::size_t i = 0; i < D; ++i)
+						g[i][l] = gradient_row[i];
+				}
+				for (std::size_t i = 0; i < D; ++i) {
+					for (std::size_t l = 0; l < Lanes; ++l)
+						dot[l] += g[i][l] * d[i][l];
+				}
+				for (std::size_t l = 0; l < Lanes; ++l) {
+					const float r2 = r[l] * r[l];
+					const float r4 = r2 * r2;
+					value[l] += r4 * dot[l];
+					if (Gradient) {
+						const float radial = -8.0f * r2 * r[l] * dot[l];
+						for (std::size_t i = 0; i < D; ++i)
+							gradient[i][l] += r4 * g[i][l] + radial * d[i][l];
+					}
+				}
+			}
+
+			for (std::size_t l = 0; l < Lanes; ++l) {
+				value[l] *= noise_scale<D>::simplex;
+				if (Gradient) {
+					for (std::size_t i = 0; i < D; ++i)
+						gradient[i][l] *= noise_scale<D>::simplex;
+				}
+			}
+		}
+
+		template<std::size_t D, bool Gradient, std::size_t Lanes>
+		void noise(const noise_type type, const float (&p)[D][Lanes], float (&value)[Lanes], float (&gradient)[D][Lanes], const std::uint32_t seed) {
+			static_assert(D >= 2 && D <= 4, "noise is defined in 2, 3 and 4 dimensions");
+			if (type == noise_type::perlin)
+				perlin<D, Gradient>(p, value, gradient, seed);
+			else
+				simplex<D, Gradient>(p, value, gradient, seed);
+		}
+
+		// single point
+		template<std::size_t D, bool Gradient>
+		float noise(const noise_type type, const base_vector<D, float>& p, float* gradient, const std::uint32_t seed) {
+			float q[D][1], value[1], g[D][1];
+			for (std::size_t i = 0; i < D; ++i)
+				q[i][0] = p.data[i];
+			noise<D, Gradient>(type, q, value, g, seed);
+			if (Gradient) {
+				for (std::size_t i = 0; i < D; ++i)
+					gradient[i] = g[i][0];
+			}
+			return value[0];
+		}
+	}
+
+	// Perlin noise at p
+	template<std::size_t D>
+	float perlin(const base_vector<D, float>& p, const std::uint32_t seed = 0) {
+		return detail::noise<D, false>(noise_type::perlin, p, nullptr, seed);
+	}
+
+	// Perlin noise and its gradient at p
+	template<std::size_t D>
+	float perlin(const base_vector<D, float>& p, base_vector<D, float>& gradient, const std::uint32_t seed = 0) {
+		return detail::noise<D, true>(noise_type::perlin, p, gradient.data.data(), seed);
+	}
+
+	// simplex noise at p
+	template<std::size_t D>
+	float simplex(const base_vector<D, float>& p, const std::uint32_t seed = 0) {
+		return detail::noise<D, false>(noise_type::simplex, p, nullptr, seed);
+	}
+
+	// simplex noise and its gradient at p
+	template<std::size_t D>
+	float simplex(const base_vector<D, float>& p, base_vector<D, float>& gradient, const std::uint32_t seed = 0) {
+		return detail::noise<D, true>(noise_type::simplex, p, gradient.data.data(), seed);
+	}
+
+	// fractal layering of octaves
+	enum class fractal_type
+	{
+		fbm,	// sum of octaves, in about [-1, 1]
+		ridged	// sum of (1 - |octave|)^2, in [0, 1]
+	};
+
+	// octaves of noise at increasing frequency and decreasing amplitude,
+	// octave i has frequency * lacunarity^i, amplitude gain^i and seed + i.
+	// The result is divided by the sum of the amplitudes
+	template<std::size_t D>
+	struct fractal_noise
+	{
+		// lanes of the bulk evaluations
+		static const std::size_t lanes = 8;
+
+		noise_type type = noise_type::simplex;
+		fractal_type fractal = fractal_type::fbm;
+		unsigned int octaves = 5;
+		float frequency = 1.0f;
+		float lacunarity = 2.0f;
+		float gain = 0.5f;
+		std::uint32_t seed = 0;
+
+		float operator() (const base_vector<D, float>& p) const {
+			float q[D][1], value[1], gradient[D][1];
+			load(q, 0, p);
+			sample<false>(q, value, gradient);
+			return value[0];
+		}
+
+		float operator() (const base_vector<D, float>& p, base_vector<D, float>& gradient) const {
+			float q[D][1], value[1], g[D][1];
+			load(q, 0, p);
+			sample<true>(q, value, g);
+			for (std::size_t i = 0; i < D; ++i)
+				gradient.data[i] = g[i][0];
+			return value[0];
+		}
+
+		// values, and optionally gradients, at count points, arrays of
+		// any vector or point type with D components
+		template<typename P, typename G = base_vector<D, float>>
+		void evaluate(const P* points, float* values, const std::size_t count,
+			G* gradients = nullptr, const unsigned int threads = 1) const {
+			static_assert(components<P>::value == D && components<G>::value == D, "points and gradients have D components");
+			run(count, [points](float (&p)[D][lanes], const std::size_t k, const std::size_t l) {
+				load(p, l, points[k]);
+			}, values, gradients, threads);
+		}
+
+		void evaluate(const soa_vector<D, float>& points, float* values, const unsigned int threads = 1) const {
+			run(points.count, [&points](float (&p)[D][lanes], const std::size_t k, const std::size_t l) {
+				for (std::size_t i = 0; i < D; ++i)
+					p[i][l] = points.data[i][k];
+			}, values, static_cast<base_vector<D, float>*>(nullptr), threads);
+		}
+
+		// values, and optionally gradients, at the nodes origin + index * step
+		// of a regular grid of size nodes, stored with the x index fastest
+		template<typename G = base_vector<D, float>>
+		void evaluate_grid(const base_vector<D, float>& origin, const base_vector<D, float>& step,
+			const base_vector<D, unsigned int>& size, float* values,
+			G* gradients = nullptr, const unsigned int threads = 1) const {
+			static_assert(components<G>::value == D, "gradients have D components");
+			std::size_t count = 1;
+			for (std::size_t i = 0; i < D; ++i)
+				count *= size.data[i];
+			run(count, [&](float (&p)[D][lanes], const std::size_t k, const std::size_t l) {
+				std::size_t index = k;
+				for (std::size_t i = 0; i < D; ++i) {
+					p[i][l] = origin.data[i] + step.data[i] * static_cast<float>(index % size.data[i]);
+					index /= size.data[i];
+				}
+			}, values, gradients, threads);
+		}
+
+	private:
+		template<std::size_t Lanes, typename P>
+		static void load(float (&p)[D][Lanes], const std::size_t l, const P& v) {
+			for (std::size_t i = 0; i < D; ++i)
+				p[i][l] = v.data[i];
+		}
+
+		// evaluate count points in blocks of lanes, load(p, k, l) writes point k in lane l
+		template<typename Load, typename G>
+		void run(const std::size_t count, Load load, float* values, G* gradients, const unsigned int threads) const {
+			parallel_for(count, [&](const unsigned int, const std::size_t begin, const std::size_t end) {
+				float p[D][lanes], value[lanes], gradient[D][lanes];
+				for (std::size_t k = begin; k < end; k += lanes) {
+					// a short last block repeats its first point in the spare lanes
+					const std::size_t n = end - k < lanes ? end - k : lanes;
+					for (std::size_t l = 0; l < lanes; ++l)
+						load(p, k + (l < n ? l : 0), l);
+					if (gradients != nullptr)
+						sample<true>(p, value, gradient);
+					else
+						sample<false>(p, value, gradient);
+					for (std::size_t l = 0; l < n; ++l) {
+						values[k + l] = value[l];
+						if (gradients != nullptr) {
+							for (std::size_t i = 0; i < D; ++i)
+								gradients[k + l].data[i] = gradient[i][l];
+						}
+					}
+				}
+			}, threads);
+		}
+
+		template<bool Gradient, std::size_t Lanes>
+		void sample(const float (&p)[D][Lanes], float (&value)[Lanes], float (&gradient)[D][Lanes]) const {
+			float q[D][Lanes], n[Lanes], g[D][Lanes];
+			float amplitude = 1.0f;
+			float total = 0.0f;
+			float f = frequency;
+			for (std::size_t l = 0; l < Lanes; ++l) {
+				value[l] = 0.0f;
+				if (Gradient) {
+					for (std::size_t i = 0; i < D; ++i)
+						gradient[i][l] = 0.0f;
+				}
+			}
+
+			for (unsigned int o = 0; o < octaves; ++o) {
+				for (std::size_t i = 0; i < D; ++i) {
+					for (std::size_t l = 0; l < Lanes; ++l)
+						q[i][l] = p[i][l] * f;
+				}
+				detail::noise<D, Gradient>(type, q, n, g, seed + o);
+				for (std::size_t l = 0; l < Lanes; ++l) {
+					if (fractal == fractal_type::fbm) {
+						value[l] += amplitude * n[l];
+						if (Gradient) {
+							for (std::size_t i = 0; i < D; ++i)
+								gradient[i][l] += amplitude * f * g[i][l];
+						}
+					}
+					else {
+						const float r = 1.0f - std::fabs(n[l]);
+						value[l] += amplitude * r * r;
+						if (Gradient) {
+							const float dr = -2.0f * r * (n[l] < 0.0f ? -1.0f : 1.0f) * amplitude * f;
+							for (std::size_t i = 0; i < D; ++i)
+								gradient[i][l] += dr * g[i][l];
+						}
+					}
+				}
+				total += amplitude;
+				amplitude *= gain;
+				f *= lacunarity;
+			}
+
+			if (total > 0.0f) {
+				const float inverse = 1.0f / total;
+				for (std::size_t l = 0; l < Lanes; ++l) {
+					value[l] *= inverse;
+					if (Gradient) {
+						for (std::size_t i = 0; i < D; ++i)
+							gradient[i][l] *= inverse;
+					}
+				}
+			}
+		}
+	};
+};
\ No newline at end of file
@@ -0,0 +1,52 @@
+#pragma once
+
+/*
+	Parallel loops
+	Vito Domenico Tagliente
+	math library for games
+*/
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace math4games
+{
+	// num of worker threads to use, 0 means one per hardware thread
+	inline unsigned int thread_count(const unsigned int threads = 0) {
+		if (threads > 0)
+			return threads;
+		const unsigned int n = std::thread::hardware_concurrency();
+		return n > 0 ? n : 1;
+	}
+
+	// split [0, count) in one contiguous range per thread and call
+	// task(thread, begin, end) for each, on the calling thread too.
+	// Ranges shorter than grain, at least 1, are merged, so small loops
+	// run serially: the threads are started on each call
+	template<typename Task>
+	void parallel_for(const std::size_t count, Task task, const unsigned int threads = 0, const std::size_t grain = 1024) {
+		if (count == 0)
+			return;
+		const std::size_t min_range = std::max<std::size_t>(grain, 1);
+		const std::size_t by_grain = (count + min_range - 1) / min_range;
+		const std::size_t n = std::min<std::size_t>(thread_count(threads), by_grain);
+		if (n <= 1) {
+			task(0u, std::size_t(0), count);
+			return;
+		}
+
+		const std::size_t chunk = (count + n - 1) / n;
+		std::vector<std::thread> workers;
+		workers.reserve(n - 1);
+		for (std::size_t t = 1; t < n; ++t) {
+			const std::size_t begin = std::min(count, t * chunk);
+			const std::size_t end = std::min(count, begin + chunk);
+			workers.emplace_back(task, static_cast<unsigned int>(t), begin, end);
+		}
+		task(0u, std::size_t(0), std::min(count, chunk));
+		for (std::thread& worker : workers)
+			worker.join();
+	}
+};
\ No newline at end of file
@@ -0,0 +1,369 @@
+#pragma once
+
+/*
+	Particle simulation
+	Vito Domenico Tagliente
+	math library for games
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include "vector.h"
+#include "soa.h"
+#include "memory.h"
+#include "parallel.h"
+#include "sweep.h"
+
+namespace math4games
+{
+	/*
+		Particles stored as structure of arrays: one aligned float array
+		per component of position, previous position, velocity and
+		acceleration, plus the inverse mass. The operations run on blocks of
+		particles with plain loops over the components, no vec3 temporaries,
+		which the compiler vectorizes, split across threads with
+		parallel_for. simulate() runs a whole step in one pass.
+
+		Forces accumulate as accelerations (force times inverse mass) and
+		the integrators clear them. Particles with inverse mass 0 are
+		pinned. The integrators keep previous, the position before the
+		step, and velocity in sync, so the collision responses work with
+		both.
+	*/
+
+	struct particle_system
+	{
+		aligned_vector<float> position[3];
+		aligned_vector<float> previous[3];
+		aligned_vector<float> velocity[3];
+		aligned_vector<float> acceleration[3];
+		aligned_vector<float> inverse_mass;
+
+		// num of particles
+		std::size_t size() const {
+			return inverse_mass.size();
+		}
+
+		// new particles are at the origin, at rest, with unit mass
+		void resize(const std::size_t count) {
+			for (unsigned int i = 0; i < 3; ++i) {
+				position[i].resize(count, 0.0f);
+				previous[i].resize(count, 0.0f);
+				velocity[i].resize(count, 0.0f);
+				acceleration[i].resize(count, 0.0f);
+			}
+			inverse_mass.resize(count, 1.0f);
+		}
+
+		void set(const std::size_t k, const base_vector<3, float>& p, const base_vector<3, float>& v, const float w = 1.0f) {
+			for (unsigned int i = 0; i < 3; ++i) {
+				position[i][k] = p.data[i];
+				previous[i][k] = p.data[i];
+				velocity[i][k] = v.data[i];
+			}
+			inverse_mass[k] = w;
+		}
+
+		// soa views
+		soa_vec3 positions() {
+			return view(position);
+		}
+
+		soa_vec3 velocities() {
+			return view(velocity);
+		}
+
+		soa_vec3 accelerations() {
+			return view(acceleration);
+		}
+
+	private:
+		soa_vec3 view(aligned_vector<float> (&arrays)[3]) {
+			soa_vec3 result;
+			for (unsigned int i = 0; i < 3; ++i)
+				result.data[i] = arrays[i].data();
+			result.count = size();
+			return result;
+		}
+	};
+
+	// point that attracts the particles with strength / (d^2 + softening^2),
+	// the softening keeps the acceleration finite near the point
+	struct attractor
+	{
+		base_vector<3, float> position;
+		float strength = 1.0f;
+		float softening = 0.1f;
+	};
+
+	namespace detail
+	{
+		/*
+			a block of particles copied into local arrays: the stages work on
+			the copy with branch free loops over the lanes, which vectorize
+			without aliasing checks, and the block is written back once
+		*/
+		template<std::size_t Lanes>
+		struct particle_lanes
+		{
+			float x[3][Lanes];
+			float x0[3][Lanes];
+			float v[3][Lanes];
+			float a[3][Lanes];
+			float w[Lanes];
+
+			// the lanes past count are pinned particles at the origin
+			void load(particle_system& p, const std::size_t first, const std::size_t count) {
+				for (unsigned int i = 0; i < 3; ++i) {
+					copy(x[i], p.position[i].data() + first, count);
+					copy(x0[i], p.previous[i].data() + first, count);
+					copy(v[i], p.velocity[i].data() + first, count);
+					copy(a[i], p.acceleration[i].data() + first, count);
+				}
+				copy(w, p.inverse_mass.data() + first, count);
+			}
+
+			void store(particle_system& p, const std::size_t first, const std::size_t count) const {
+				for (unsigned int i = 0; i < 3; ++i) {
+					std::copy(x[i], x[i] + count, p.position[i].data() + first);
+					std::copy(x0[i], x0[i] + count, p.previous[i].data() + first);
+					std::copy(v[i], v[i] + count, p.velocity[i].data() + first);
+					std::copy(a[i], a[i] + count, p.acceleration[i].data() + first);
+				}
+			}
+
+			void gravity(const base_vector<3, float>& g) {
+				for (unsigned int i = 0; i < 3; ++i)
+					for (std::size_t l = 0; l < Lanes; ++l)
+						a[i][l] += g.data[i];
+			}
+
+			// force -coefficient * velocity
+			void drag(const float coefficient) {
+				for (unsigned int i = 0; i < 3; ++i)
+					for (std::size_t l = 0; l < Lanes; ++l)
+						a[i][l] -= coefficient * v[i][l] * w[l];
+			}
+
+			void attract(const attractor& attractor) {
+				const float soft = attractor.softening * attractor.softening;
+				float d[3][Lanes], s[Lanes];
+				for (unsigned int i = 0; i < 3; ++i)
+					for (std::size_t l = 0; l < Lanes; ++l)
+						d[i][l] = attractor.position.data[i] - x[i][l];
+				for (std::size_t l = 0; l < Lanes; ++l) {
+					const float d2 = d[0][l] * d[0][l] + d[1][l] * d[1][l] + d[2][l] * d[2][l] + soft;
+					// strength / d^2 along the unit direction d / |d|
+					s[l] = attractor.strength / (d2 * std::sqrt(d2));
+				}
+				for (unsigned int i = 0; i < 3; ++i)
+					for (std::size_t l = 0; l < Lanes; ++l)
+						a[i][l] += d[i][l] * s[l];
+			}
+
+			// semi-implicit Euler: v += a dt, x += v dt
+			void euler(const float dt) {
+				for (unsigned int i = 0; i < 3; ++i)
+					for (std::size_t l = 0; l < Lanes; ++l) {
+						const float moving = w[l] > 0.0f ? 1.0f : 0.0f;
+						v[i][l] = (v[i][l] + a[i][l] * dt) * moving;
+						x0[i][l] = x[i][l];
+						x[i][l] += v[i][l] * dt;
+						a[i][l] = 0.0f;
+					}
+			}
+
+			// position Verlet: x += (x - previous) * damping + a dt^2, the velocity is the finite difference
+			void verlet(const float dt, const float damping) {
+				const float dt2 = dt * dt;
+				const float inverse_dt = 1.0f / dt;
+				for (unsigned int i = 0; i < 3; ++i)
+					for (std::size_t l = 0; l < Lanes; ++l) {
+						const float moving = w[l] > 0.0f ? 1.0f : 0.0f;
+						const float step = ((x[i][l] - x0[i][l]) * damping + a[i][l] * dt2) * moving;
+						x0[i][l] = x[i][l];
+						x[i][l] += step;
+						v[i][l] = step * inverse_dt;
+						a[i][l] = 0.0f;
+					}
+			}
+
+			/*
+				collision responses: the position is projected out of the
+				solid, the normal part of the velocity is reflected and scaled
+				by restitution, the tangential one by 1 - friction. The step
+				x - previous, taken before the projection, gets the same
+				response, so that Verlet moves on with the reflected velocity
+			*/
+
+			// keep the particles inside the box
+			void bounds(const aabb& box, const float restitution, const float friction) {
+				float contact[3][Lanes], step[3][Lanes], any[Lanes];
+				for (std::size_t l = 0; l < Lanes; ++l)
+					any[l] = 0.0f;
+				for (unsigned int i = 0; i < 3; ++i) {
+					const float lo = box.min.data[i], hi = box.max.data[i];
+					for (std::size_t l = 0; l < Lanes; ++l) {
+						step[i][l] = x[i][l] - x0[i][l];
+						// only a particle moving out of the box bounces
+						const unsigned int out = (unsigned(x[i][l] < lo) & unsigned(v[i][l] < 0.0f))
+							| (unsigned(x[i][l] > hi) & unsigned(v[i][l] > 0.0f));
+						contact[i][l] = out ? 1.0f : 0.0f;
+						any[l] = std::max(any[l], contact[i][l]);
+						x[i][l] = std::min(std::max(x[i][l], lo), hi);
+					}
+				}
+				for (unsigned int i = 0; i < 3; ++i)
+					for (std::size_t l = 0; l < Lanes; ++l) {
+						const float tangent = 1.0f - any[l] * friction;
+						const float scale = tangent + contact[i][l] * (-restitution - tangent);
+						v[i][l] *= scale;
+						x0[i][l] = x[i][l] - step[i][l] * scale;
+					}
+			}
+
+			// keep the particles in front of the plane
+			void collide(const plane& plane, const float restitution, const float friction) {
+				const float n[3] = { plane.normal.x, plane.normal.y, plane.normal.z };
+				const float distance = plane.distance;
+				const float slide = 1.0f - friction, bounce = -restitution;
+				float step[3][Lanes], vn[Lanes], sn[Lanes], tangent[Lanes], normal[Lanes];
+				for (unsigned int i = 0; i < 3; ++i)
+					for (std::size_t l = 0; l < Lanes; ++l)
+						step[i][l] = x[i][l] - x0[i][l];
+				for (std::size_t l = 0; l < Lanes; ++l) {
+					const float s = n[0] * x[0][l] + n[1] * x[1][l] + n[2] * x[2][l] - distance;
+					const float depth = s < 0.0f ? s : 0.0f;
+					x[0][l] -= n[0] * depth;
+					x[1][l] -= n[1] * depth;
+					x[2][l] -= n[2] * depth;
+					vn[l] = n[0] * v[0][l] + n[1] * v[1][l] + n[2] * v[2][l];
+					sn[l] = n[0] * step[0][l] + n[1] * step[1][l] + n[2] * step[2][l];
+					// in contact when below the plane and moving into it
+					const bool contact = std::max(s, vn[l]) < 0.0f;
+					tangent[l] = contact ? slide : 1.0f;
+					normal[l] = contact ? bounce : 1.0f;
+				}
+				// v = v_t * tangent + v_n * normal, same for the step
+				for (unsigned int i = 0; i < 3; ++i)
+					for (std::size_t l = 0; l < Lanes; ++l) {
+						v[i][l] = (v[i][l] - n[i] * vn[l]) * tangent[l] + n[i] * vn[l] * normal[l];
+						x0[i][l] = x[i][l] - ((step[i][l] - n[i] * sn[l]) * tangent[l] + n[i] * sn[l] * normal[l]);
+					}
+			}
+
+		private:
+			static void copy(float* lanes, const float* source, const std::size_t count) {
+				std::copy(source, source + count, lanes);
+				std::fill(lanes + count, lanes + Lanes, 0.0f);
+			}
+		};
+
+		// runs stages(lanes) over every block of particles, in parallel
+		template<typename Stages>
+		void particle_for(particle_system& particles, Stages stages, const unsigned int threads) {
+			constexpr std::size_t lanes = 64;
+			parallel_for(particles.size(), [&particles, &stages](const unsigned int, const std::size_t begin, const std::size_t end) {
+				particle_lanes<lanes> block;
+				for (std::size_t first = begin; first < end; first += lanes) {
+					const std::size_t count = end - first < lanes ? end - first : lanes;
+					block.load(particles, first, count);
+					stages(block);
+					block.store(particles, first, count);
+				}
+			}, threads, 16384);
+		}
+	}
+
+	// forces, accumulated until the next integration
+
+	inline void apply_gravity(particle_system& particles, const base_vector<3, float>& gravity, const unsigned int threads = 0) {
+		detail::particle_for(particles, [&gravity](auto& block) { block.gravity(gravity); }, threads);
+	}
+
+	inline void apply_drag(particle_system& particles, const float coefficient, const unsigned int threads = 0) {
+		detail::particle_for(particles, [coefficient](auto& block) { block.drag(coefficient); }, threads);
+	}
+
+	inline void apply_attractors(particle_system& particles, const attractor* attractors, const std::size_t count,
+		const unsigned int threads = 0) {
+		detail::particle_for(particles, [attractors, count](auto& block) {
+			for (std::size_t j = 0; j < count; ++j)
+				block.attract(attractors[j]);
+		}, threads);
+	}
+
+	// integrators, they clear the accumulated accelerations
+
+	inline void integrate_euler(particle_system& particles, const float dt, const unsigned int threads = 0) {
+		detail::particle_for(particles, [dt](auto& block) { block.euler(dt); }, threads);
+	}
+
+	// damping in [0, 1] scales the velocity carried over each step
+	inline void integrate_verlet(particle_system& particles, const float dt, const float damping = 1.0f, const unsigned int threads = 0) {
+		detail::particle_for(particles, [dt, damping](auto& block) { block.verlet(dt, damping); }, threads);
+	}
+
+	// collision responses
+
+	inline void collide(particle_system& particles, const aabb& bounds, const float restitution = 0.5f,
+		const float friction = 0.0f, const unsigned int threads = 0) {
+		detail::particle_for(particles, [&](auto& block) { block.bounds(bounds, restitution, friction); }, threads);
+	}
+
+	inline void collide(particle_system& particles, const plane& plane, const float restitution = 0.5f,
+		const float friction = 0.0f, const unsigned int threads = 0) {
+		detail::particle_for(particles, [&](auto& block) { block.collide(plane, restitution, friction); }, threads);
+	}
+
+	enum class particle_integrator
+	{
+		euler,
+		verlet
+	};
+
+	// everything that happens to the particles in one simulate() step
+	struct particle_settings
+	{
+		particle_integrator integrator = particle_integrator::euler;
+		base_vector<3, float> gravity = { 0.0f, -9.81f, 0.0f };
+		float drag = 0.0f;
+		// verlet only
+		float damping = 1.0f;
+		const attractor* attractors = nullptr;
+		std::size_t attractor_count = 0;
+		const plane* planes = nullptr;
+		std::size_t plane_count = 0;
+		// the particles are kept inside bounds when bounded
+		bool bounded = false;
+		aabb bounds;
+		float restitution = 0.5f;
+		float friction = 0.0f;
+	};
+
+	/*
+		forces, integration and collisions in a single pass: each block is
+		loaded once, goes through all the stages and is stored back, instead
+		of streaming the whole arrays through memory once per stage as the
+		separate functions do
+	*/
+	inline void simulate(particle_system& particles, const particle_settings& settings, const float dt,
+		const unsigned int threads = 0) {
+		detail::particle_for(particles, [&settings, dt](auto& block) {
+			block.gravity(settings.gravity);
+			if (settings.drag != 0.0f)
+				block.drag(settings.drag);
+			for (std::size_t j = 0; j < settings.attractor_count; ++j)
+				block.attract(settings.attractors[j]);
+			if (settings.integrator == particle_integrator::euler)
+				block.euler(dt);
+			else
+				block.verlet(dt, settings.damping);
+			for (std::size_t j = 0; j < settings.plane_count; ++j)
+				block.collide(settings.planes[j], settings.restitution, settings.friction);
+			if (settings.bounded)
+				block.bounds(settings.bounds, settings.restitution, settings.friction);
+		}, threads);
+	}
+};
\ No newline at end of file
@@ -10,6 +10,8 @@
 #include <cassert>
 #include <initializer_list>
 #include <array>
+#include "element.h"
+#include "profile.h"
 
 namespace math4games
 {
@@ -42,6 +44,9 @@ namespace math4games
 			}
 		}
 		
+		// declared with the copy assignment below
+		base_point(const base_point&) = default;
+
 		// templated copy constructor
 		template<std::size_t M>
 		base_point(const base_point<M, T>& other)
@@ -71,12 +76,14 @@ namespace math4games
 
 		T& operator() (const unsigned int i)
 		{
-			return data.at(i);
+			MATH4GAMES_COUNT("element access", profile::type_name<T>(N), 0);
+			return detail::element(data, i);
 		}
 
 		T operator() (const unsigned int i) const
 		{
-			return data.at(i);
+			MATH4GAMES_COUNT("element access", profile::type_name<T>(N), 0);
+			return detail::element(data, i);
 		}
 
 		base_point<N, T>& operator= (const base_point<N, T>& other) {
@@ -111,6 +118,10 @@ namespace math4games
 
 		base_point2() :base_point<2, T>() {}
 
+		// copy constructors, the component references must bind to this data
+		base_point2(const base_point2& other) :base_point<2, T>(other) {}
+		base_point2(const base_point<2, T>& other) :base_point<2, T>(other) {}
+
 		T& x = base_point<2, T>::data[0];
 		T& y = base_point<2, T>::data[1];
 
@@ -122,6 +133,7 @@ namespace math4games
 
 		base_point2& operator= (const base_point2& other) {
 			base_point<2, T>::data = other.data;
+			return (*this);
 		}
 	};
 
@@ -134,6 +146,10 @@ namespace math4games
 
 		base_point3() :base_point<3, T>() {}
 
+		// copy constructors, the component references must bind to this data
+		base_point3(const base_point3& other) :base_point<3, T>(other) {}
+		base_point3(const base_point<3, T>& other) :base_point<3, T>(other) {}
+
 		T& x = base_point<3, T>::data[0];
 		T& y = base_point<3, T>::data[1];
 		T& z = base_point<3, T>::data[2];
@@ -147,6 +163,7 @@ namespace math4games
 
 		base_point3& operator= (const base_point3& other) {
 			base_point<3, T>::data = other.data;
+			return (*this);
 		}
 	};
 
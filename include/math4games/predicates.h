@@ -0,0 +1,423 @@
+#pragma once
+
+/*
+	Geometric predicates
+	Vito Domenico Tagliente
+	math library for games
+*/
+
+#include <array>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+#include "profile.h"
+
+namespace math4games
+{
+	/*
+		Exact signs of the orientation and in circle/sphere determinants for
+		float and double coordinates (without overflow or underflow):
+
+		orient2d(a, b, c) > 0 when a, b, c turn counter clockwise
+		orient3d(a, b, c, d) > 0 when d is above the plane of a, b, c, which
+			are counter clockwise seen from above: (b - a) x (c - a) * (d - a)
+		incircle(a, b, c, d) > 0 when d is inside the circle through the
+			counter clockwise a, b, c
+		insphere(a, b, c, d, e) > 0 when e is inside the sphere through a,
+			b, c, d with orient3d(a, b, c, d) > 0
+
+		Each one evaluates the determinant in double and returns its sign
+		when it is larger than the error bound of the evaluation (Shewchuk),
+		which is the case but for nearly degenerate inputs. Otherwise it is
+		recomputed with expansions, sums of non overlapping doubles, from the
+		coordinate differences: on the stack with single doubles when the
+		differences are exact, as for nearby coordinates, else with their
+		rounding errors. With MATH4GAMES_PROFILE the calls of each predicate
+		and of its exact stage are counted, their ratio is the filter hit rate
+	*/
+
+	namespace detail
+	{
+		const double predicate_epsilon = DBL_EPSILON * 0.5;
+		const double orient2d_bound = (3.0 + 16.0 * predicate_epsilon) * predicate_epsilon;
+		const double orient3d_bound = (7.0 + 56.0 * predicate_epsilon) * predicate_epsilon;
+		const double incircle_bound = (10.0 + 96.0 * predicate_epsilon) * predicate_epsilon;
+		const double insphere_bound = (16.0 + 224.0 * predicate_epsilon) * predicate_epsilon;
+
+		// error free transformations: x + y is exactly the result
+
+		inline void two_sum(const double a, const double b, double& x, double& y) {
+			x = a + b;
+			const double bv = x - a;
+			const double av = x - bv;
+			y = (a - av) + (b - bv);
+		}
+
+		// |a| >= |b|
+		inline void fast_two_sum(const double a, const double b, double& x, double& y) {
+			x = a + b;
+			y = b - (x - a);
+		}
+
+		inline void two_diff(const double a, const double b, double& x, double& y) {
+			x = a - b;
+			const double bv = a - x;
+			const double av = x + bv;
+			y = (a - av) + (bv - b);
+		}
+
+		inline void two_product(const double a, const double b, double& x, double& y) {
+			x = a * b;
+			y = std::fma(a, b, -x);
+		}
+
+		inline void expansion_storage(std::vector<double>& terms, const std::size_t size) {
+			terms.resize(size);
+		}
+
+		template<std::size_t N>
+		void expansion_storage(std::array<double, N>&, const std::size_t) {}
+
+		/*
+			non overlapping doubles by increasing magnitude, without zeros
+			but for the zero expansion {0}. N is the largest size the terms
+			can reach; the biggest ones, only in the exact insphere with
+			inexact differences, are allocated on the heap
+		*/
+		template<std::size_t N>
+		struct expansion
+		{
+			typename std::conditional<(N <= 2048), std::array<double, N>, std::vector<double>>::type terms;
+			std::size_t size = 1;
+
+			expansion() {
+				expansion_storage(terms, N);
+				terms[0] = 0.0;
+			}
+
+			int sign() const {
+				const double last = terms[size - 1];
+				return last > 0.0 ? 1 : (last < 0.0 ? -1 : 0);
+			}
+
+			// append a term, dropping zeros
+			void push(const double x) {
+				if (x != 0.0)
+					terms[size++] = x;
+			}
+
+			void finish(const double x) {
+				if (x != 0.0 || size == 0)
+					terms[size++] = x;
+			}
+		};
+
+		// a - b exactly, with its rounding error when there is one
+		inline expansion<2> difference(const double a, const double b) {
+			expansion<2> result;
+			double x, y;
+			two_diff(a, b, x, y);
+			result.size = 0;
+			result.push(y);
+			result.finish(x);
+			return result;
+		}
+
+		template<std::size_t N>
+		expansion<N> operator-(const expansion<N>& e) {
+			expansion<N> result;
+			result.size = e.size;
+			for (std::size_t i = 0; i < e.size; ++i)
+				result.terms[i] = -e.terms[i];
+			return result;
+		}
+
+		// h = e + f, merging the terms by magnitude (Shewchuk's fast expansion sum)
+		template<typename E>
+		void expansion_sum(const double* e, const std::size_t n, const double* f, const std::size_t m, E& h) {
+			h.size = 0;
+			std::size_t i = 0, j = 0;
+			auto take = [&]() {
+				if (j == m || (i < n && std::fabs(e[i]) < std::fabs(f[j])))
+					return e[i++];
+				return f[j++];
+			};
+			double q = take();
+			while (i < n || j < m) {
+				double x, y;
+				two_sum(q, take(), x, y);
+				h.push(y);
+				q = x;
+			}
+			h.finish(q);
+		}
+
+		template<std::size_t N, std::size_t M>
+		expansion<N + M> operator+(const expansion<N>& e, const expansion<M>& f) {
+			expansion<N + M> result;
+			expansion_sum(e.terms.data(), e.size, f.terms.data(), f.size, result);
+			return result;
+		}
+
+		template<std::size_t N, std::size_t M>
+		expansion<N + M> operator-(const expansion<N>& e, const expansion<M>& f) {
+			return e + -f;
+		}
+
+		// e * b, term by term
+		template<std::size_t N>
+		expansion<N * 2> operator*(const expansion<N>& e, const double b) {
+			expansion<N * 2> result;
+			result.size = 0;
+			double q, y;
+			two_product(e.terms[0], b, q, y);
+			result.push(y);
+			for (std::size_t i = 1; i < e.size; ++i) {
+				double high, low, sum;
+				two_product(e.terms[i], b, high, low);
+				two_sum(q, low, sum, y);
+				result.push(y);
+				fast_two_sum(high, sum, q, y);
+				result.push(y);
+			}
+			result.finish(q);
+			return result;
+		}
+
+		// sum of e times each term of f, alternating two buffers so that the
+		// last sum lands in the result
+		template<std::size_t N, std::size_t M>
+		expansion<N * M * 2> operator*(const expansion<N>& e, const expansion<M>& f) {
+			expansion<N * M * 2> result, buffer;
+			expansion<N * M * 2>* target = f.size % 2 == 1 ? &result : &buffer;
+			expansion<N * M * 2>* source = f.size % 2 == 1 ? &buffer : &result;
+			const expansion<N * 2> first = e * f.terms[0];
+			target->size = first.size;
+			for (std::size_t i = 0; i < first.size; ++i)
+				target->terms[i] = first.terms[i];
+			for (std::size_t j = 1; j < f.size; ++j) {
+				std::swap(target, source);
+				const expansion<N * 2> scaled = e * f.terms[j];
+				expansion_sum(source->terms.data(), source->size, scaled.terms.data(), scaled.size, *target);
+			}
+			return result;
+		}
+
+		// the determinants from the coordinate differences d, rows of 2 or 3
+
+		template<typename E>
+		int orient2d_exact(const E* d) {
+			return (d[0] * d[3] - d[1] * d[2]).sign();
+		}
+
+		template<typename E>
+		auto determinant3(const E* u, const E* v, const E* w) {
+			return u[0] * (v[1] * w[2] - v[2] * w[1]) + u[1] * (v[2] * w[0] - v[0] * w[2]) + u[2] * (v[0] * w[1] - v[1] * w[0]);
+		}
+
+		template<typename E>
+		int orient3d_exact(const E* d) {
+			return -determinant3(d, d + 3, d + 6).sign();
+		}
+
+		template<typename E>
+		int incircle_exact(const E* d) {
+			const E* a = d;
+			const E* b = d + 2;
+			const E* c = d + 4;
+			return ((a[0] * a[0] + a[1] * a[1]) * (b[0] * c[1] - b[1] * c[0])
+				+ (b[0] * b[0] + b[1] * b[1]) * (c[0] * a[1] - c[1] * a[0])
+				+ (c[0] * c[0] + c[1] * c[1]) * (a[0] * b[1] - a[1] * b[0])).sign();
+		}
+
+		template<typename E>
+		int insphere_exact(const E* d) {
+			const E* a = d;
+			const E* b = d + 3;
+			const E* c = d + 6;
+			const E* e = d + 9;
+			// cofactor expansion along the lifted column
+			return ((a[0] * a[0] + a[1] * a[1] + a[2] * a[2]) * determinant3(b, c, e)
+				- (b[0] * b[0] + b[1] * b[1] + b[2] * b[2]) * determinant3(a, c, e)
+				+ (c[0] * c[0] + c[1] * c[1] + c[2] * c[2]) * determinant3(a, b, e)
+				- (e[0] * e[0] + e[1] * e[1] + e[2] * e[2]) * determinant3(a, b, c)).sign();
+		}
+
+		// exact stages: the differences p[i] - q[i % D] as single doubles when
+		// they are all exact, else as two term expansions
+		template<std::size_t Count, std::size_t D, typename Determinant>
+		int exact_sign(const double* p, const double* q, Determinant determinant) {
+			expansion<1> single[Count];
+			bool exact = true;
+			for (std::size_t i = 0; i < Count; ++i) {
+				double x, y;
+				two_diff(p[i], q[i % D], x, y);
+				single[i].terms[0] = x;
+				exact = exact && y == 0.0;
+			}
+			if (exact)
+				return determinant(single);
+			expansion<2> rounded[Count];
+			for (std::size_t i = 0; i < Count; ++i)
+				rounded[i] = difference(p[i], q[i % D]);
+			return determinant(rounded);
+		}
+
+		inline int sign(const double x) {
+			return x > 0.0 ? 1 : (x < 0.0 ? -1 : 0);
+		}
+
+		inline int orient2d(const double* a, const double* b, const double* c) {
+			MATH4GAMES_COUNT("orient2d", "double", 7);
+			const double left = (a[0] - c[0]) * (b[1] - c[1]);
+			const double right = (a[1] - c[1]) * (b[0] - c[0]);
+			const double det = left - right;
+			if (std::fabs(det) > orient2d_bound * (std::fabs(left) + std::fabs(right)))
+				return sign(det);
+			MATH4GAMES_COUNT("orient2d exact", "double", 0);
+			const double p[4] = { a[0], a[1], b[0], b[1] };
+			return exact_sign<4, 2>(p, c, [](const auto* d) { return orient2d_exact(d); });
+		}
+
+		inline int orient3d(const double* a, const double* b, const double* c, const double* d) {
+			MATH4GAMES_COUNT("orient3d", "double", 23);
+			double u[3], v[3], w[3];
+			for (unsigned int i = 0; i < 3; ++i) {
+				u[i] = a[i] - d[i];
+				v[i] = b[i] - d[i];
+				w[i] = c[i] - d[i];
+			}
+			const double vw[2] = { v[1] * w[2], v[2] * w[1] };
+			const double wu[2] = { w[1] * u[2], w[2] * u[1] };
+			const double uv[2] = { u[1] * v[2], u[2] * v[1] };
+			const double det = -(u[0] * (vw[0] - vw[1]) + v[0] * (wu[0] - wu[1]) + w[0] * (uv[0] - uv[1]));
+			const double permanent = (std::fabs(vw[0]) + std::fabs(vw[1])) * std::fabs(u[0])
+				+ (std::fabs(wu[0]) + std::fabs(wu[1])) * std::fabs(v[0])
+				+ (std::fabs(uv[0]) + std::fabs(uv[1])) * std::fabs(w[0]);
+			if (std::fabs(det) > orient3d_bound * permanent)
+				return sign(det);
+			MATH4GAMES_COUNT("orient3d exact", "double", 0);
+			const double p[9] = { a[0], a[1], a[2], b[0], b[1], b[2], c[0], c[1], c[2] };
+			return exact_sign<9, 3>(p, d, [](const auto* e) { return orient3d_exact(e); });
+		}
+
+		inline int incircle(const double* a, const double* b, const double* c, const double* d) {
+			MATH4GAMES_COUNT("incircle", "double", 29);
+			double u[3][2];
+			const double* p[3] = { a, b, c };
+			for (unsigned int k = 0; k < 3; ++k) {
+				u[k][0] = p[k][0] - d[0];
+				u[k][1] = p[k][1] - d[1];
+			}
+			double det = 0.0, permanent = 0.0;
+			for (unsigned int k = 0; k < 3; ++k) {
+				const double* s = u[(k + 1) % 3];
+				const double* t = u[(k + 2) % 3];
+				const double lift = u[k][0] * u[k][0] + u[k][1] * u[k][1];
+				const double left = s[0] * t[1], right = t[0] * s[1];
+				det += lift * (left - right);
+				permanent += lift * (std::fabs(left) + std::fabs(right));
+			}
+			if (std::fabs(det) > incircle_bound * permanent)
+				return sign(det);
+			MATH4GAMES_COUNT("incircle exact", "double", 0);
+			const double q[6] = { a[0], a[1], b[0], b[1], c[0], c[1] };
+			return exact_sign<6, 2>(q, d, [](const auto* e) { return incircle_exact(e); });
+		}
+
+		inline int insphere(const double* a, const double* b, const double* c, const double* d, const double* e) {
+			MATH4GAMES_COUNT("insphere", "double", 80);
+			double u[4][3];
+			const double* p[4] = { a, b, c, d };
+			for (unsigned int k = 0; k < 4; ++k)
+				for (unsigned int i = 0; i < 3; ++i)
+					u[k][i] = p[k][i] - e[i];
+			// lifts times the 3x3 determinants of the other rows, with signs
+			const unsigned int rows[4][3] = { { 1, 2, 3 }, { 0, 2, 3 }, { 0, 1, 3 }, { 0, 1, 2 } };
+			double det = 0.0, permanent = 0.0;
+			for (unsigned int k = 0; k < 4; ++k) {
+				const double* r = u[rows[k][0]];
+				const double* s = u[rows[k][1]];
+				const double* t = u[rows[k][2]];
+				double minor = 0.0, absolute = 0.0;
+				for (unsigned int i = 0; i < 3; ++i) {
+					const unsigned int j = (i + 1) % 3, l = (i + 2) % 3;
+					const double left = s[j] * t[l], right = s[l] * t[j];
+					minor += r[i] * (left - right);
+					absolute += std::fabs(r[i]) * (std::fabs(left) + std::fabs(right));
+				}
+				const double lift = u[k][0] * u[k][0] + u[k][1] * u[k][1] + u[k][2] * u[k][2];
+				det += (k % 2 == 0 ? lift : -lift) * minor;
+				permanent += lift * absolute;
+			}
+			if (std::fabs(det) > insphere_bound * permanent)
+				return sign(det);
+			MATH4GAMES_COUNT("insphere exact", "double", 0);
+			const double q[12] = { a[0], a[1], a[2], b[0], b[1], b[2], c[0], c[1], c[2], d[0], d[1], d[2] };
+			return exact_sign<12, 3>(q, e, [](const auto* f) { return insphere_exact(f); });
+		}
+
+		template<std::size_t N, typename P>
+		void coordinates(const P& p, double (&result)[N]) {
+			for (std::size_t i = 0; i < N; ++i)
+				result[i] = static_cast<double>(p.data[i]);
+		}
+	}
+
+	// predicates on coordinates
+
+	inline int orient2d(const double ax, const double ay, const double bx, const double by, const double cx, const double cy) {
+		const double a[2] = { ax, ay }, b[2] = { bx, by }, c[2] = { cx, cy };
+		return detail::orient2d(a, b, c);
+	}
+
+	inline int incircle(const double ax, const double ay, const double bx, const double by,
+		const double cx, const double cy, const double dx, const double dy) {
+		const double a[2] = { ax, ay }, b[2] = { bx, by }, c[2] = { cx, cy }, d[2] = { dx, dy };
+		return detail::incircle(a, b, c, d);
+	}
+
+	// predicates on vectors and points, of floats or doubles
+
+	template<typename P>
+	int orient2d(const P& a, const P& b, const P& c) {
+		double p[3][2];
+		detail::coordinates(a, p[0]);
+		detail::coordinates(b, p[1]);
+		detail::coordinates(c, p[2]);
+		return detail::orient2d(p[0], p[1], p[2]);
+	}
+
+	template<typename P>
+	int orient3d(const P& a, const P& b, const P& c, const P& d) {
+		double p[4][3];
+		detail::coordinates(a, p[0]);
+		detail::coordinates(b, p[1]);
+		detail::coordinates(c, p[2]);
+		detail::coordinates(d, p[3]);
+		return detail::orient3d(p[0], p[1], p[2], p[3]);
+	}
+
+	template<typename P>
+	int incircle(const P& a, const P& b, const P& c, const P& d) {
+		double p[4][2];
+		detail::coordinates(a, p[0]);
+		detail::coordinates(b, p[1]);
+		detail::coordinates(c, p[2]);
+		detail::coordinates(d, p[3]);
+		return detail::incircle(p[0], p[1], p[2], p[3]);
+	}
+
+	template<typename P>
+	int insphere(const P& a, const P& b, const P& c, const P& d, const P& e) {
+		double p[5][3];
+		detail::coordinates(a, p[0]);
+		detail::coordinates(b, p[1]);
+		detail::coordinates(c, p[2]);
+		detail::coordinates(d, p[3]);
+		detail::coordinates(e, p[4]);
+		return detail::insphere(p[0], p[1], p[2], p[3], p[4]);
+	}
+};
\ No newline at end of file
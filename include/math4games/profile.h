@@ -0,0 +1,174 @@
+#pragma once
+
+/*
+	Operation counters
+	Vito Domenico Tagliente
+	math library for games
+*/
+
+/*
+	Define MATH4GAMES_PROFILE to count, per thread, the calls and the
+	estimated floating point operations of the main math operations
+	(matrix products, inverse, normalize, quaternion to matrix, element
+	access, ...) for each type they are instantiated with.
+	Without the define the counting macro expands to nothing and none of
+	the code below is compiled.
+
+	profile::dump(std::cout) prints the counters of every thread and their
+	total, profile::reset() clears them.
+*/
+
+#ifdef MATH4GAMES_PROFILE
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace math4games
+{
+	namespace profile
+	{
+		// counters of one call site
+		struct counter
+		{
+			std::uint64_t calls = 0;
+			std::uint64_t flops = 0;
+		};
+
+		// counters of one thread, indexed by site. The mutex is only
+		// contended by reset and dump, which read every thread
+		struct thread_counters
+		{
+			std::size_t thread = 0;
+			std::mutex mutex;
+			std::vector<counter> counters;
+		};
+
+		// process wide state
+		struct registry
+		{
+			std::mutex mutex;
+			// operation and type name of each site
+			std::vector<std::pair<std::string, std::string>> sites;
+			// every thread that counted something, kept after the thread exits
+			std::vector<std::shared_ptr<thread_counters>> threads;
+
+			static registry& instance() {
+				static registry r;
+				return r;
+			}
+		};
+
+		// register a call site, done once per site and instantiation
+		inline std::size_t site(const char* operation, const std::string& type) {
+			registry& r = registry::instance();
+			std::lock_guard<std::mutex> lock(r.mutex);
+			r.sites.emplace_back(operation, type);
+			return r.sites.size() - 1;
+		}
+
+		inline thread_counters& local() {
+			thread_local std::shared_ptr<thread_counters> counters;
+			if (!counters) {
+				counters = std::make_shared<thread_counters>();
+				registry& r = registry::instance();
+				std::lock_guard<std::mutex> lock(r.mutex);
+				counters->thread = r.threads.size();
+				r.threads.push_back(counters);
+			}
+			return *counters;
+		}
+
+		inline void count(const std::size_t site, const std::uint64_t flops) {
+			thread_counters& t = local();
+			std::lock_guard<std::mutex> lock(t.mutex);
+			if (site >= t.counters.size())
+				t.counters.resize(site + 1);
+			t.counters[site].calls++;
+			t.counters[site].flops += flops;
+		}
+
+		// type names used in the reports
+		template<typename T> inline const char* scalar_name() { return "?"; }
+		template<> inline const char* scalar_name<float>() { return "float"; }
+		template<> inline const char* scalar_name<double>() { return "double"; }
+		template<> inline const char* scalar_name<int>() { return "int"; }
+		template<> inline const char* scalar_name<unsigned int>() { return "unsigned"; }
+
+		template<typename T>
+		std::string type_name(const std::size_t n) {
+			return std::string("vector") + std::to_string(n) + " " + scalar_name<T>();
+		}
+
+		template<typename T>
+		std::string type_name(const std::size_t n, const std::size_t m) {
+			return std::string("matrix") + std::to_string(n) + "x" + std::to_string(m) + " " + scalar_name<T>();
+		}
+
+		// clear the counters of every thread
+		inline void reset() {
+			registry& r = registry::instance();
+			std::lock_guard<std::mutex> lock(r.mutex);
+			for (auto& t : r.threads) {
+				std::lock_guard<std::mutex> thread_lock(t->mutex);
+				std::fill(t->counters.begin(), t->counters.end(), counter());
+			}
+		}
+
+		// print the counters of each thread and the totals, by decreasing flops.
+		// Running threads keep counting, each one is copied under its mutex
+		inline void dump(std::ostream& os) {
+			registry& r = registry::instance();
+			std::lock_guard<std::mutex> lock(r.mutex);
+
+			auto print = [&os, &r](const std::vector<counter>& counters) {
+				std::vector<std::size_t> order;
+				for (std::size_t i = 0; i < counters.size(); ++i) {
+					if (counters[i].calls > 0)
+						order.push_back(i);
+				}
+				std::sort(order.begin(), order.end(), [&counters](const std::size_t a, const std::size_t b) {
+					return counters[a].flops > counters[b].flops;
+				});
+				for (const std::size_t i : order) {
+					os << "  " << r.sites[i].first << " [" << r.sites[i].second << "]"
+						<< " calls " << counters[i].calls << " flops " << counters[i].flops << '\n';
+				}
+			};
+
+			std::vector<counter> total(r.sites.size());
+			for (const auto& t : r.threads) {
+				std::vector<counter> counters;
+				{
+					std::lock_guard<std::mutex> thread_lock(t->mutex);
+					counters = t->counters;
+				}
+				os << "thread " << t->thread << '\n';
+				print(counters);
+				for (std::size_t i = 0; i < counters.size(); ++i) {
+					total[i].calls += counters[i].calls;
+					total[i].flops += counters[i].flops;
+				}
+			}
+			os << "total" << '\n';
+			print(total);
+		}
+	}
+};
+
+// count one call of operation on type, with an estimate of its flops
+#define MATH4GAMES_COUNT(operation, type, flops) \
+	do { \
+		static const std::size_t math4games_site = ::math4games::profile::site(operation, type); \
+		::math4games::profile::count(math4games_site, flops); \
+	} while (0)
+
+#else
+
+#define MATH4GAMES_COUNT(operation, type, flops) ((void)0)
+
+#endif
\ No newline at end of file
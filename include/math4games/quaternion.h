@@ -6,7 +6,9 @@
 	math library for games
 */
 
+#include "common.h"
 #include "vector.h"
+#include "matrix.h"
 #include <cmath>
 
 namespace math4games
@@ -23,13 +25,12 @@ namespace math4games
 			w = 0.0f;
 		}
 
+		// declared with the copy assignment below
+		quaternion(const quaternion&) = default;
+
 		quaternion(const vector3& vector, const float scalar = 0.0f) {
-			const float half_angle = 0.5f * radians(scalar);
-			const float s = std::sin(half_angle);
-			v[0] = v.x * s;
-			v[1] = v.y * s;
-			v[2] = v.z * s;
-			w = std::cos(half_angle);
+			v = vector;
+			w = scalar;
 		}
 
 		quaternion(const float x, const float y, const float z, const float _w = 0.0f) {
@@ -39,6 +40,13 @@ namespace math4games
 			w = _w;
 		}
 
+		// rotation of theta degrees about a unit axis
+		static quaternion axis_angle(const vector3& axis, const float theta) {
+			const float half_angle = 0.5f * radians(theta);
+			const float s = std::sin(half_angle);
+			return quaternion(axis.x * s, axis.y * s, axis.z * s, std::cos(half_angle));
+		}
+
 		// operator overloading
 
 		quaternion operator- () {
@@ -66,7 +74,7 @@ namespace math4games
 		}
 
 		float length() const {
-			return std::sqrt(std::powf(w, 2) + std::powf(v.magnitude(), 2));
+			return std::sqrt(std::pow(w, 2) + std::pow(v.magnitude(), 2));
 		}
 
 		quaternion normalize() const {
@@ -83,6 +91,7 @@ namespace math4games
 		}
 
 		quaternion operator*(const quaternion& q) {
+			MATH4GAMES_COUNT("quaternion * quaternion", "quaternion", 28);
 			return quaternion(
 				w*q.v + q.w*v + v.cross(q.v),
 				w*q.w - (v*q.v)
@@ -109,6 +118,7 @@ namespace math4games
 		}
 
 		matrix4 matrix() const {
+			MATH4GAMES_COUNT("quaternion::matrix", "quaternion", 30);
 			const float xy = v.x*v.y;
 			const float xz = v.x*v.z;
 			const float yz = v.y*v.z;
@@ -138,7 +148,43 @@ namespace math4games
 		}
 	};
 
-	quaternion operator* (const float scalar, const quaternion& q) {
+	inline quaternion operator* (const float scalar, const quaternion& q) {
 		return q * scalar;
 	}
+
+	// rotation matrix to quaternion (Shepperd method)
+	// the matrix is expected to be orthonormal and to act on column vectors
+	template<typename T>
+	quaternion to_quaternion(const base_matrix<3, 3, T>& m) {
+		// r(i, j) = element at row i, column j
+		auto r = [&m](const unsigned int i, const unsigned int j) {
+			return static_cast<float>(m.data[i * 3 + j]);
+		};
+
+		const float trace = r(0, 0) + r(1, 1) + r(2, 2);
+		if (trace > 0.0f) {
+			const float s = 0.5f / std::sqrt(trace + 1.0f);
+			return quaternion((r(2, 1) - r(1, 2)) * s, (r(0, 2) - r(2, 0)) * s, (r(1, 0) - r(0, 1)) * s, 0.25f / s);
+		}
+		if (r(0, 0) > r(1, 1) && r(0, 0) > r(2, 2)) {
+			const float s = 2.0f * std::sqrt(1.0f + r(0, 0) - r(1, 1) - r(2, 2));
+			return quaternion(0.25f * s, (r(0, 1) + r(1, 0)) / s, (r(0, 2) + r(2, 0)) / s, (r(2, 1) - r(1, 2)) / s);
+		}
+		if (r(1, 1) > r(2, 2)) {
+			const float s = 2.0f * std::sqrt(1.0f + r(1, 1) - r(0, 0) - r(2, 2));
+			return quaternion((r(0, 1) + r(1, 0)) / s, 0.25f * s, (r(1, 2) + r(2, 1)) / s, (r(0, 2) - r(2, 0)) / s);
+		}
+		const float s = 2.0f * std::sqrt(1.0f + r(2, 2) - r(0, 0) - r(1, 1));
+		return quaternion((r(0, 2) + r(2, 0)) / s, (r(1, 2) + r(2, 1)) / s, 0.25f * s, (r(1, 0) - r(0, 1)) / s);
+	}
+
+	// unit quaternion to rotation matrix acting on column vectors
+	inline matrix3 to_matrix3(const quaternion& q) {
+		const float x = q.v[0], y = q.v[1], z = q.v[2], w = q.w;
+		return matrix3({
+			1.0f - 2 * (y*y + z*z),	2 * (x*y - w*z),		2 * (x*z + w*y),
+			2 * (x*y + w*z),		1.0f - 2 * (x*x + z*z),	2 * (y*z - w*x),
+			2 * (x*z - w*y),		2 * (y*z + w*x),		1.0f - 2 * (x*x + y*y)
+		});
+	}
 };
\ No newline at end of file
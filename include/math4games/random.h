@@ -0,0 +1,452 @@
+#pragma once
+
+/*
+	Random and low discrepancy sampling
+	Vito Domenico Tagliente
+	math library for games
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include "common.h"
+#include "vector.h"
+#include "point.h"
+#include "quaternion.h"
+#include "soa.h"
+
+namespace math4games
+{
+	/*
+		rng runs Lanes independent xoshiro128+ generators side by side,
+		the state is stored as one array per state word so that a step
+		of all the lanes is a plain loop the compiler vectorizes.
+		The bulk generators below draw Lanes uniforms at a time and write
+		into caller arrays, either arrays of vectors or soa views.
+	*/
+	template<std::size_t Lanes = 8>
+	struct rng
+	{
+		rng(const std::uint64_t seed = 0x9e3779b97f4a7c15ull) {
+			this->seed(seed);
+		}
+
+		// seed every lane from a splitmix64 sequence
+		void seed(std::uint64_t seed) {
+			for (std::size_t l = 0; l < Lanes; ++l) {
+				for (unsigned int i = 0; i < 4; ++i) {
+					seed += 0x9e3779b97f4a7c15ull;
+					std::uint64_t z = seed;
+					z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+					z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+					m_state[i][l] = static_cast<std::uint32_t>((z ^ (z >> 31)) >> 32);
+				}
+			}
+			m_index = Lanes;
+		}
+
+		// one 32 bit value per lane
+		void next(std::uint32_t (&out)[Lanes]) {
+			std::uint32_t (&s)[4][Lanes] = m_state;
+			for (std::size_t l = 0; l < Lanes; ++l) {
+				out[l] = s[0][l] + s[3][l];
+				const std::uint32_t t = s[1][l] << 9;
+				s[2][l] ^= s[0][l];
+				s[3][l] ^= s[1][l];
+				s[1][l] ^= s[2][l];
+				s[0][l] ^= s[3][l];
+				s[2][l] ^= t;
+				s[3][l] = (s[3][l] << 11) | (s[3][l] >> 21);
+			}
+		}
+
+		// one uniform float in [0, 1) per lane, from the 24 high bits
+		void uniform(float (&out)[Lanes]) {
+			std::uint32_t bits[Lanes];
+			next(bits);
+			for (std::size_t l = 0; l < Lanes; ++l)
+				out[l] = static_cast<float>(bits[l] >> 8) * (1.0f / 16777216.0f);
+		}
+
+		// single uniform float in [0, 1)
+		float uniform() {
+			if (m_index == Lanes) {
+				uniform(m_block);
+				m_index = 0;
+			}
+			return m_block[m_index++];
+		}
+
+		// uniform float in [min, max)
+		float uniform(const float min, const float max) {
+			return min + (max - min) * uniform();
+		}
+
+		// count uniform floats in [0, 1)
+		void uniform(float* out, const std::size_t count) {
+			float block[Lanes];
+			for (std::size_t k = 0; k < count; k += Lanes) {
+				uniform(block);
+				const std::size_t n = count - k < Lanes ? count - k : Lanes;
+				for (std::size_t l = 0; l < n; ++l)
+					out[k + l] = block[l];
+			}
+		}
+
+	private:
+		std::uint32_t m_state[4][Lanes];
+		float m_block[Lanes];
+		std::size_t m_index;
+	};
+
+	namespace detail
+	{
+		// sine and cosine of the angle 2 pi u, u in [0, 1), without calls
+		// into libm so that the sampling loops vectorize. Taylor series
+		// around pi / 4 of the angle inside the quadrant, error below 1e-7
+		inline void sincos_turns(const float u, float& s, float& c) {
+			const float x = 4.0f * u;
+			const int quadrant = static_cast<int>(x) & 3;
+			const float b = (x - static_cast<float>(static_cast<int>(x)) - 0.5f) * (0.5f * pi);
+			const float b2 = b * b;
+			const float sb = b * (1.0f + b2 * (-1.0f / 6.0f + b2 * (1.0f / 120.0f + b2 * (-1.0f / 5040.0f + b2 * (1.0f / 362880.0f)))));
+			const float cb = 1.0f + b2 * (-0.5f + b2 * (1.0f / 24.0f + b2 * (-1.0f / 720.0f + b2 * (1.0f / 40320.0f + b2 * (-1.0f / 3628800.0f)))));
+			const float h = 0.70710678f;
+			const float s0 = (sb + cb) * h;
+			const float c0 = (cb - sb) * h;
+			s = quadrant == 0 ? s0 : quadrant == 1 ? c0 : quadrant == 2 ? -s0 : -c0;
+			c = quadrant == 0 ? c0 : quadrant == 1 ? -s0 : quadrant == 2 ? -c0 : s0;
+		}
+
+		// draw D uniforms per sample, Lanes samples at a time, compute the
+		// samples with kernel(u, out) and hand them to store(k, out)
+		template<std::size_t N, std::size_t D, std::size_t Lanes, typename Kernel, typename Store>
+		void generate(rng<Lanes>& g, const std::size_t count, Kernel kernel, Store store) {
+			float u[D][Lanes];
+			float out[N][Lanes];
+			for (std::size_t k = 0; k < count; k += Lanes) {
+				for (std::size_t d = 0; d < D; ++d)
+					g.uniform(u[d]);
+				kernel(u, out);
+				const std::size_t n = count - k < Lanes ? count - k : Lanes;
+				for (std::size_t l = 0; l < n; ++l)
+					store(k + l, out, l);
+			}
+		}
+
+		// store into an array of vectors or points
+		template<std::size_t N, std::size_t Lanes, typename V>
+		struct array_writer
+		{
+			V* values;
+
+			void operator() (const std::size_t k, const float (&out)[N][Lanes], const std::size_t l) const {
+				for (std::size_t i = 0; i < N; ++i)
+					values[k].data[i] = out[i][l];
+			}
+		};
+
+		template<std::size_t N, std::size_t Lanes>
+		struct soa_writer
+		{
+			soa_vector<N, float>* values;
+
+			void operator() (const std::size_t k, const float (&out)[N][Lanes], const std::size_t l) const {
+				for (std::size_t i = 0; i < N; ++i)
+					values->data[i][k] = out[i][l];
+			}
+		};
+
+		// sampling kernels, from uniforms u to samples. They are function
+		// objects so that generate() inlines them
+
+		struct unit2_kernel
+		{
+			template<std::size_t Lanes>
+			void operator() (const float (&u)[1][Lanes], float (&out)[2][Lanes]) const {
+				for (std::size_t l = 0; l < Lanes; ++l)
+					sincos_turns(u[0][l], out[1][l], out[0][l]);
+			}
+		};
+
+		struct unit3_kernel
+		{
+			template<std::size_t Lanes>
+			void operator() (const float (&u)[2][Lanes], float (&out)[3][Lanes]) const {
+				for (std::size_t l = 0; l < Lanes; ++l) {
+					const float z = 1.0f - 2.0f * u[0][l];
+					const float r = std::sqrt(std::max(0.0f, 1.0f - z * z));
+					float sin_phi, cos_phi;
+					sincos_turns(u[1][l], sin_phi, cos_phi);
+					out[0][l] = r * cos_phi;
+					out[1][l] = r * sin_phi;
+					out[2][l] = z;
+				}
+			}
+		};
+
+		struct disk_kernel
+		{
+			template<std::size_t Lanes>
+			void operator() (const float (&u)[2][Lanes], float (&out)[2][Lanes]) const {
+				for (std::size_t l = 0; l < Lanes; ++l) {
+					const float r = std::sqrt(u[0][l]);
+					float sin_phi, cos_phi;
+					sincos_turns(u[1][l], sin_phi, cos_phi);
+					out[0][l] = r * cos_phi;
+					out[1][l] = r * sin_phi;
+				}
+			}
+		};
+
+		struct ball_kernel
+		{
+			template<std::size_t Lanes>
+			void operator() (const float (&u)[3][Lanes], float (&out)[3][Lanes]) const {
+				for (std::size_t l = 0; l < Lanes; ++l) {
+					const float z = 1.0f - 2.0f * u[0][l];
+					const float r = std::sqrt(std::max(0.0f, 1.0f - z * z));
+					const float radius = std::cbrt(u[2][l]);
+					float sin_phi, cos_phi;
+					sincos_turns(u[1][l], sin_phi, cos_phi);
+					out[0][l] = radius * r * cos_phi;
+					out[1][l] = radius * r * sin_phi;
+					out[2][l] = radius * z;
+				}
+			}
+		};
+
+		// Malley's method: a uniform disk sample, by the polar mapping of
+		// disk_kernel, lifted to the hemisphere around +z
+		struct cosine_hemisphere_kernel
+		{
+			template<std::size_t Lanes>
+			void operator() (const float (&u)[2][Lanes], float (&out)[3][Lanes]) const {
+				for (std::size_t l = 0; l < Lanes; ++l) {
+					const float r = std::sqrt(u[0][l]);
+					float sin_phi, cos_phi;
+					sincos_turns(u[1][l], sin_phi, cos_phi);
+					out[0][l] = r * cos_phi;
+					out[1][l] = r * sin_phi;
+					out[2][l] = std::sqrt(std::max(0.0f, 1.0f - u[0][l]));
+				}
+			}
+		};
+
+		// Shoemake's uniform rotation, x y z w
+		struct rotation_kernel
+		{
+			template<std::size_t Lanes>
+			void operator() (const float (&u)[3][Lanes], float (&out)[4][Lanes]) const {
+				for (std::size_t l = 0; l < Lanes; ++l) {
+					const float a = std::sqrt(1.0f - u[0][l]);
+					const float b = std::sqrt(u[0][l]);
+					float s1, c1, s2, c2;
+					sincos_turns(u[1][l], s1, c1);
+					sincos_turns(u[2][l], s2, c2);
+					out[0][l] = a * s1;
+					out[1][l] = a * c1;
+					out[2][l] = b * s2;
+					out[3][l] = b * c2;
+				}
+			}
+		};
+	}
+
+	namespace detail
+	{
+		// kernel of the unit vectors with N components, and its uniforms
+		template<std::size_t N>
+		struct unit_sampler;
+
+		template<>
+		struct unit_sampler<2>
+		{
+			typedef unit2_kernel kernel;
+			static const std::size_t uniforms = 1;
+		};
+
+		template<>
+		struct unit_sampler<3>
+		{
+			typedef unit3_kernel kernel;
+			static const std::size_t uniforms = 2;
+		};
+	}
+
+	// the functions below take arrays of any float vector or point type,
+	// see components
+
+	// unit vectors uniformly distributed on the circle or on the sphere,
+	// by the components of V
+	template<std::size_t Lanes, typename V>
+	void random_unit(rng<Lanes>& g, V* results, const std::size_t count) {
+		const std::size_t N = components<V>::value;
+		typedef detail::unit_sampler<N> sampler;
+		detail::generate<N, sampler::uniforms>(g, count, typename sampler::kernel(), detail::array_writer<N, Lanes, V>{ results });
+	}
+
+	template<std::size_t Lanes>
+	void random_unit(rng<Lanes>& g, soa_vector<2, float>& results) {
+		detail::generate<2, 1>(g, results.count, detail::unit2_kernel(), detail::soa_writer<2, Lanes>{ &results });
+	}
+
+	template<std::size_t Lanes>
+	void random_unit(rng<Lanes>& g, soa_vector<3, float>& results) {
+		detail::generate<3, 2>(g, results.count, detail::unit3_kernel(), detail::soa_writer<3, Lanes>{ &results });
+	}
+
+	// points uniformly distributed inside the unit disk
+	template<std::size_t Lanes, typename P>
+	void random_disk(rng<Lanes>& g, P* results, const std::size_t count) {
+		static_assert(components<P>::value == 2, "disk samples have 2 components");
+		detail::generate<2, 2>(g, count, detail::disk_kernel(), detail::array_writer<2, Lanes, P>{ results });
+	}
+
+	template<std::size_t Lanes>
+	void random_disk(rng<Lanes>& g, soa_vector<2, float>& results) {
+		detail::generate<2, 2>(g, results.count, detail::disk_kernel(), detail::soa_writer<2, Lanes>{ &results });
+	}
+
+	// points uniformly distributed inside the unit sphere
+	template<std::size_t Lanes, typename P>
+	void random_sphere(rng<Lanes>& g, P* results, const std::size_t count) {
+		static_assert(components<P>::value == 3, "sphere samples have 3 components");
+		detail::generate<3, 3>(g, count, detail::ball_kernel(), detail::array_writer<3, Lanes, P>{ results });
+	}
+
+	template<std::size_t Lanes>
+	void random_sphere(rng<Lanes>& g, soa_vector<3, float>& results) {
+		detail::generate<3, 3>(g, results.count, detail::ball_kernel(), detail::soa_writer<3, Lanes>{ &results });
+	}
+
+	// points uniformly distributed inside the box [min, max)
+	template<std::size_t Lanes, typename P>
+	void random_box(rng<Lanes>& g, P* results, const std::size_t count, const P& min, const P& max) {
+		float u[Lanes];
+		for (std::size_t i = 0; i < components<P>::value; ++i) {
+			const float origin = min.data[i];
+			const float extent = max.data[i] - min.data[i];
+			for (std::size_t k = 0; k < count; k += Lanes) {
+				g.uniform(u);
+				const std::size_t n = count - k < Lanes ? count - k : Lanes;
+				for (std::size_t l = 0; l < n; ++l)
+					results[k + l].data[i] = origin + extent * u[l];
+			}
+		}
+	}
+
+	// directions on the hemisphere around +z with density cos(theta) / pi
+	template<std::size_t Lanes, typename V>
+	void random_cosine_hemisphere(rng<Lanes>& g, V* results, const std::size_t count) {
+		static_assert(components<V>::value == 3, "hemisphere directions have 3 components");
+		detail::generate<3, 2>(g, count, detail::cosine_hemisphere_kernel(), detail::array_writer<3, Lanes, V>{ results });
+	}
+
+	template<std::size_t Lanes>
+	void random_cosine_hemisphere(rng<Lanes>& g, soa_vector<3, float>& results) {
+		detail::generate<3, 2>(g, results.count, detail::cosine_hemisphere_kernel(), detail::soa_writer<3, Lanes>{ &results });
+	}
+
+	// uniformly distributed rotations
+	template<std::size_t Lanes>
+	void random_rotation(rng<Lanes>& g, quaternion* results, const std::size_t count) {
+		detail::generate<4, 3>(g, count, detail::rotation_kernel(),
+			[results](const std::size_t k, const float (&out)[4][Lanes], const std::size_t l) {
+				results[k] = quaternion(out[0][l], out[1][l], out[2][l], out[3][l]);
+			});
+	}
+
+	/*
+		Low discrepancy sequences: deterministic points in [0, 1)^N that
+		cover the domain more evenly than random ones, for quasi Monte
+		Carlo integration. Sample i depends only on i, so ranges of a
+		sequence can be generated independently.
+	*/
+
+	// radical inverse of index in the given base
+	inline float radical_inverse(std::uint32_t index, const std::uint32_t base) {
+		const float inverse_base = 1.0f / static_cast<float>(base);
+		float f = inverse_base;
+		float result = 0.0f;
+		while (index > 0) {
+			result += static_cast<float>(index % base) * f;
+			index /= base;
+			f *= inverse_base;
+		}
+		// keep the result below one despite rounding
+		return std::min(result, 0.99999994f);
+	}
+
+	// Halton points first, first + 1, ..., with bases 2, 3, 5, 7
+	template<typename V>
+	void halton(const std::uint32_t first, V* results, const std::size_t count) {
+		const std::size_t N = components<V>::value;
+		static_assert(N > 0 && N <= 4, "halton sequences up to 4 dimensions");
+		const std::uint32_t bases[4] = { 2, 3, 5, 7 };
+		for (std::size_t k = 0; k < count; ++k) {
+			for (std::size_t i = 0; i < N; ++i)
+				results[k].data[i] = radical_inverse(first + static_cast<std::uint32_t>(k), bases[i]);
+		}
+	}
+
+	namespace detail
+	{
+		// Sobol direction numbers of the first 5 dimensions, from the
+		// primitive polynomials and initial values of Joe and Kuo
+		struct sobol_directions
+		{
+			std::uint32_t v[5][32];
+
+			sobol_directions() {
+				const unsigned int s[5] = { 0, 1, 2, 3, 3 };
+				const unsigned int a[5] = { 0, 0, 1, 1, 2 };
+				const std::uint32_t m[5][3] = { { 0, 0, 0 }, { 1, 0, 0 }, { 1, 3, 0 }, { 1, 3, 1 }, { 1, 1, 1 } };
+				for (unsigned int i = 0; i < 32; ++i)
+					v[0][i] = 1u << (31 - i);
+				for (unsigned int d = 1; d < 5; ++d) {
+					for (unsigned int i = 0; i < 32; ++i) {
+						if (i < s[d]) {
+							v[d][i] = m[d][i] << (31 - i);
+							continue;
+						}
+						v[d][i] = v[d][i - s[d]] ^ (v[d][i - s[d]] >> s[d]);
+						for (unsigned int k = 1; k < s[d]; ++k) {
+							if ((a[d] >> (s[d] - 1 - k)) & 1)
+								v[d][i] ^= v[d][i - k];
+						}
+					}
+				}
+			}
+
+			static const sobol_directions& instance() {
+				static const sobol_directions directions;
+				return directions;
+			}
+		};
+	}
+
+	// dimension d of the index-th Sobol point, d < 5
+	inline float sobol(std::uint32_t index, const unsigned int dimension) {
+		assert(dimension < 5);
+		const std::uint32_t* v = detail::sobol_directions::instance().v[dimension];
+		std::uint32_t x = 0;
+		for (unsigned int i = 0; index > 0; index >>= 1, ++i) {
+			if (index & 1)
+				x ^= v[i];
+		}
+		return static_cast<float>(x >> 8) * (1.0f / 16777216.0f);
+	}
+
+	// Sobol points first, first + 1, ...
+	template<typename V>
+	void sobol(const std::uint32_t first, V* results, const std::size_t count) {
+		const std::size_t N = components<V>::value;
+		static_assert(N > 0 && N <= 5, "sobol sequences up to 5 dimensions");
+		for (std::size_t k = 0; k < count; ++k) {
+			for (unsigned int i = 0; i < N; ++i)
+				results[k].data[i] = sobol(first + static_cast<std::uint32_t>(k), i);
+		}
+	}
+};
\ No newline at end of file
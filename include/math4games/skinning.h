@@ -0,0 +1,150 @@
+#pragma once
+
+/*
+	Linear blend skinning
+	Vito Domenico Tagliente
+	math library for games
+*/
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include "vector.h"
+#include "matrix.h"
+#include "soa.h"
+#include "parallel.h"
+
+namespace math4games
+{
+	// bone indices and weights of a vertex, the weights sum to 1 and the
+	// unused influences have weight 0
+	template<std::size_t Influences>
+	struct skin_influences
+	{
+		std::uint16_t bones[Influences];
+		float weights[Influences];
+	};
+
+	typedef skin_influences<4> skin_influences4;
+	typedef skin_influences<8> skin_influences8;
+
+	// bone matrix in the affine 3x4 form, the last column is the translation.
+	// Its data is the first three rows of the row major matrix4, so the
+	// skinning functions take palettes of both
+	typedef base_matrix<3, 4, float> bone_matrix;
+
+	// palette[i] = bones[i] * inverse_bind[i], for affine transforms
+	template<std::size_t Rows>
+	void skin_palette(const base_matrix<4, 4, float>* bones, const base_matrix<4, 4, float>* inverse_bind,
+		base_matrix<Rows, 4, float>* palette, const std::size_t count) {
+		static_assert(Rows == 3 || Rows == 4, "the palette holds 3x4 or 4x4 matrices");
+		for (std::size_t k = 0; k < count; ++k) {
+			const float* a = bones[k].data.data();
+			const float* b = inverse_bind[k].data.data();
+			float* m = palette[k].data.data();
+			for (unsigned int i = 0; i < 3; ++i) {
+				for (unsigned int j = 0; j < 4; ++j)
+					m[i * 4 + j] = a[i * 4] * b[j] + a[i * 4 + 1] * b[4 + j] + a[i * 4 + 2] * b[8 + j];
+				m[i * 4 + 3] += a[i * 4 + 3];
+			}
+			if (Rows == 4) {
+				m[12] = m[13] = m[14] = 0.0f;
+				m[15] = 1.0f;
+			}
+		}
+	}
+
+	namespace detail
+	{
+		// weighted sum of the first three rows of the bone matrices
+		template<std::size_t Rows, std::size_t Influences>
+		inline void blend_bones(const base_matrix<Rows, 4, float>* palette, const skin_influences<Influences>& influence,
+			float (&m)[12]) {
+			static_assert(Rows == 3 || Rows == 4, "the palette holds 3x4 or 4x4 matrices");
+			for (unsigned int e = 0; e < 12; ++e)
+				m[e] = 0.0f;
+			for (std::size_t j = 0; j < Influences; ++j) {
+				const float w = influence.weights[j];
+				const float* b = palette[influence.bones[j]].data.data();
+				for (unsigned int e = 0; e < 12; ++e)
+					m[e] += w * b[e];
+			}
+		}
+
+		// skin the vertices [begin, end), normals are skipped when null
+		template<std::size_t Rows, std::size_t Influences>
+		void skin_range(const base_matrix<Rows, 4, float>* palette, const skin_influences<Influences>* influences,
+			const soa_vector<3, float>& positions, const soa_vector<3, float>* normals,
+			soa_vector<3, float>& skinned_positions, soa_vector<3, float>* skinned_normals,
+			const std::size_t begin, const std::size_t end) {
+			const float* p[3] = { positions.data[0], positions.data[1], positions.data[2] };
+			float* q[3] = { skinned_positions.data[0], skinned_positions.data[1], skinned_positions.data[2] };
+			const float* n[3] = { nullptr, nullptr, nullptr };
+			float* r[3] = { nullptr, nullptr, nullptr };
+			if (normals) {
+				for (unsigned int i = 0; i < 3; ++i) {
+					n[i] = normals->data[i];
+					r[i] = skinned_normals->data[i];
+				}
+			}
+			float m[12];
+			for (std::size_t k = begin; k < end; ++k) {
+				blend_bones(palette, influences[k], m);
+				const float x = p[0][k], y = p[1][k], z = p[2][k];
+				for (unsigned int i = 0; i < 3; ++i)
+					q[i][k] = m[i * 4] * x + m[i * 4 + 1] * y + m[i * 4 + 2] * z + m[i * 4 + 3];
+				if (normals) {
+					const float nx = n[0][k], ny = n[1][k], nz = n[2][k];
+					float t[3];
+					for (unsigned int i = 0; i < 3; ++i)
+						t[i] = m[i * 4] * nx + m[i * 4 + 1] * ny + m[i * 4 + 2] * nz;
+					const float length2 = t[0] * t[0] + t[1] * t[1] + t[2] * t[2];
+					const float s = length2 > 0.0f ? 1.0f / std::sqrt(length2) : 0.0f;
+					for (unsigned int i = 0; i < 3; ++i)
+						r[i][k] = t[i] * s;
+				}
+			}
+		}
+	}
+
+	// skin a single position
+	template<std::size_t Rows, std::size_t Influences>
+	base_vector<3, float> skin(const base_matrix<Rows, 4, float>* palette, const skin_influences<Influences>& influence,
+		const base_vector<3, float>& position) {
+		float m[12];
+		detail::blend_bones(palette, influence, m);
+		const float x = position.data[0], y = position.data[1], z = position.data[2];
+		return base_vector<3, float>({
+			m[0] * x + m[1] * y + m[2] * z + m[3],
+			m[4] * x + m[5] * y + m[6] * z + m[7],
+			m[8] * x + m[9] * y + m[10] * z + m[11]
+		});
+	}
+
+	/*
+		bulk skinning of positions.count vertices: each vertex blends its
+		bone matrices once, as three rows of four floats that the compiler
+		vectorizes, and transforms position and normal with the result.
+		Skinned normals are renormalized, they use the blended matrix
+		itself, which is exact for bones without non uniform scale
+	*/
+	template<std::size_t Rows, std::size_t Influences>
+	void skin(const base_matrix<Rows, 4, float>* palette, const skin_influences<Influences>* influences,
+		const soa_vector<3, float>& positions, soa_vector<3, float>& skinned_positions, const unsigned int threads = 0) {
+		assert(skinned_positions.count >= positions.count);
+		parallel_for(positions.count, [&](const unsigned int, const std::size_t begin, const std::size_t end) {
+			detail::skin_range<Rows, Influences>(palette, influences, positions, nullptr, skinned_positions, nullptr, begin, end);
+		}, threads, 4096);
+	}
+
+	template<std::size_t Rows, std::size_t Influences>
+	void skin(const base_matrix<Rows, 4, float>* palette, const skin_influences<Influences>* influences,
+		const soa_vector<3, float>& positions, const soa_vector<3, float>& normals,
+		soa_vector<3, float>& skinned_positions, soa_vector<3, float>& skinned_normals, const unsigned int threads = 0) {
+		assert(skinned_positions.count >= positions.count && normals.count >= positions.count && skinned_normals.count >= positions.count);
+		parallel_for(positions.count, [&](const unsigned int, const std::size_t begin, const std::size_t end) {
+			detail::skin_range<Rows, Influences>(palette, influences, positions, &normals, skinned_positions, &skinned_normals, begin, end);
+		}, threads, 4096);
+	}
+};
\ No newline at end of file
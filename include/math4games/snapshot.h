@@ -0,0 +1,390 @@
+#pragma once
+
+/*
+	Transform snapshot codec
+	Vito Domenico Tagliente
+	math library for games
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "vector.h"
+#include "quaternion.h"
+
+namespace math4games
+{
+	namespace detail
+	{
+		// entities in a block of the vectorized loops
+		const std::size_t snapshot_lanes = 64;
+		// bound of the three smallest components of a unit quaternion
+		const float smallest_three_range = 0.70710678f;
+	}
+
+	// little endian bit stream, each value fills the bytes from their
+	// lowest bit. Values take 32 bits at most
+	struct bit_writer
+	{
+		explicit bit_writer(std::vector<std::uint8_t>& buffer) : m_buffer(buffer) {}
+
+		void write(const std::uint32_t value, const unsigned int bits) {
+			assert(bits <= 32 && (bits == 32 || (value >> bits) == 0));
+			m_accumulator |= static_cast<std::uint64_t>(value) << m_count;
+			m_count += bits;
+			if (m_count >= 32) {
+				put(4);
+				m_count -= 32;
+			}
+		}
+
+		// write the pending bits, the last byte is padded with zeros
+		void flush() {
+			put((m_count + 7) / 8);
+			m_count = 0;
+		}
+
+	private:
+		void put(const unsigned int bytes) {
+			for (unsigned int i = 0; i < bytes; ++i)
+				m_buffer.push_back(static_cast<std::uint8_t>(m_accumulator >> (i * 8)));
+			m_accumulator >>= bytes * 8;
+		}
+
+		std::vector<std::uint8_t>& m_buffer;
+		std::uint64_t m_accumulator = 0;
+		unsigned int m_count = 0;
+	};
+
+	struct bit_reader
+	{
+		bit_reader(const std::uint8_t* data, const std::size_t size) : m_data(data), m_size(size) {}
+
+		// the bits past the end of the data read as zeros and set overrun
+		std::uint32_t read(const unsigned int bits) {
+			assert(bits <= 32);
+			if (m_count < bits) {
+				for (unsigned int i = 0; i < 4; ++i, ++m_position) {
+					const std::uint64_t byte = m_position < m_size ? m_data[m_position] : 0;
+					m_accumulator |= byte << (m_count + i * 8);
+				}
+				m_count += 32;
+			}
+			const std::uint32_t value = static_cast<std::uint32_t>(m_accumulator & ((std::uint64_t(1) << bits) - 1));
+			m_accumulator >>= bits;
+			m_count -= bits;
+			m_read += bits;
+			return value;
+		}
+
+		bool overrun() const {
+			return m_read > m_size * 8;
+		}
+
+	private:
+		const std::uint8_t* m_data;
+		std::size_t m_size;
+		std::size_t m_position = 0;
+		std::uint64_t m_accumulator = 0;
+		unsigned int m_count = 0;
+		std::size_t m_read = 0;
+	};
+
+	// quantized transforms of the entities of a snapshot, which is also the
+	// baseline of the following ones
+	struct quantized_snapshot
+	{
+		std::vector<std::uint32_t> positions[3];
+		// index of the largest component in the top 2 bits, then the other
+		// three from the most significant bits (smallest three)
+		std::vector<std::uint32_t> rotations;
+
+		std::size_t size() const {
+			return rotations.size();
+		}
+
+		void resize(const std::size_t count) {
+			for (unsigned int i = 0; i < 3; ++i)
+				positions[i].resize(count);
+			rotations.resize(count);
+		}
+	};
+
+	/*
+		Codec of entity positions and orientations for replication.
+		Positions are quantized on a grid of the given precision within the
+		bounds, with the bits each axis needs (24 at most); orientations, unit
+		quaternions, drop the largest component and keep the other three in
+		[-1/sqrt(2), 1/sqrt(2)] with rotation_bits each (10 at most) below the 2 bits of the index of
+		the dropped one, so that a rotation is a 2 + 3 * rotation_bits word.
+
+		encode bit packs a quantized snapshot, against a baseline when there
+		is one: unchanged entities take 2 bits, position changes whose
+		zigzag deltas fit delta_bits take 3 * delta_bits. Quantization,
+		dequantization and the deltas work on blocks of lanes that the
+		compiler vectorizes, the bit stream is written in 32 bit words
+	*/
+	struct snapshot_codec
+	{
+		snapshot_codec(const base_vector<3, float>& min, const base_vector<3, float>& max, const float precision,
+			const unsigned int rotation_bits = 10, const unsigned int delta_bits = 8)
+			: m_rotation_bits(rotation_bits), m_delta_bits(delta_bits) {
+			assert(precision > 0.0f && rotation_bits >= 2 && rotation_bits <= 10 && delta_bits >= 1 && delta_bits <= 24);
+			for (unsigned int i = 0; i < 3; ++i) {
+				const float extent = max.data[i] - min.data[i];
+				assert(extent >= 0.0f);
+				unsigned int bits = 1;
+				while (bits < 24 && static_cast<float>((1u << bits) - 1) * precision < extent)
+					++bits;
+				m_min[i] = min.data[i];
+				m_position_bits[i] = bits;
+				m_levels[i] = static_cast<float>((1u << bits) - 1);
+				m_scale[i] = extent > 0.0f ? m_levels[i] / extent : 0.0f;
+				m_step[i] = extent / m_levels[i];
+			}
+			m_rotation_levels = static_cast<float>((1u << rotation_bits) - 1);
+		}
+
+		unsigned int position_bits(const unsigned int axis) const {
+			return m_position_bits[axis];
+		}
+
+		// largest error of the dequantized positions along axis, half a step
+		// plus the float rounding of quantize and dequantize
+		float position_error(const unsigned int axis) const {
+			return m_step[axis] * (0.5f + m_levels[axis] * 2.0f * std::numeric_limits<float>::epsilon());
+		}
+
+		// largest error of the three encoded quaternion components
+		float rotation_error() const {
+			return detail::smallest_three_range / m_rotation_levels;
+		}
+
+		template<typename V>
+		void quantize(const V* positions, const quaternion* rotations, const std::size_t count, quantized_snapshot& result) const {
+			result.resize(count);
+			const std::size_t lanes = detail::snapshot_lanes;
+			float p[4][lanes] = {};
+			for (std::size_t first = 0; first < count; first += lanes) {
+				const std::size_t n = std::min(lanes, count - first);
+
+				for (std::size_t k = 0; k < n; ++k)
+					for (unsigned int i = 0; i < 3; ++i)
+						p[i][k] = positions[first + k].data[i];
+				for (unsigned int i = 0; i < 3; ++i) {
+					const float min = m_min[i], scale = m_scale[i], levels = m_levels[i];
+					std::uint32_t* out = result.positions[i].data() + first;
+					std::uint32_t q[lanes];
+					for (std::size_t k = 0; k < lanes; ++k)
+						q[k] = static_cast<std::uint32_t>(static_cast<std::int32_t>(std::min(std::max((p[i][k] - min) * scale, 0.0f), levels) + 0.5f));
+					std::copy(q, q + n, out);
+				}
+
+				for (std::size_t k = 0; k < n; ++k) {
+					for (unsigned int i = 0; i < 3; ++i)
+						p[i][k] = rotations[first + k].v.data[i];
+					p[3][k] = rotations[first + k].w;
+				}
+				std::uint32_t q[lanes];
+				encode_rotations(p, q);
+				std::copy(q, q + n, result.rotations.data() + first);
+			}
+		}
+
+		template<typename V>
+		void dequantize(const quantized_snapshot& snapshot, V* positions, quaternion* rotations) const {
+			const std::size_t count = snapshot.size();
+			const std::size_t lanes = detail::snapshot_lanes;
+			float p[4][lanes] = {};
+			for (std::size_t first = 0; first < count; first += lanes) {
+				const std::size_t n = std::min(lanes, count - first);
+
+				for (unsigned int i = 0; i < 3; ++i) {
+					const std::uint32_t* in = snapshot.positions[i].data() + first;
+					std::uint32_t q[lanes] = {};
+					std::copy(in, in + n, q);
+					const float min = m_min[i], step = m_step[i];
+					for (std::size_t k = 0; k < lanes; ++k)
+						p[i][k] = min + static_cast<float>(static_cast<std::int32_t>(q[k])) * step;
+				}
+				for (std::size_t k = 0; k < n; ++k)
+					for (unsigned int i = 0; i < 3; ++i)
+						positions[first + k].data[i] = p[i][k];
+
+				std::uint32_t q[lanes] = {};
+				std::copy(snapshot.rotations.data() + first, snapshot.rotations.data() + first + n, q);
+				decode_rotations(q, p);
+				for (std::size_t k = 0; k < n; ++k)
+					rotations[first + k] = quaternion(p[0][k], p[1][k], p[2][k], p[3][k]);
+			}
+		}
+
+		/*
+			bit pack snapshot into buffer, replacing its content. The stream
+			starts with the entity count and the baseline count (0 without
+			one), then each entity of the baseline has a changed bit for the
+			position, followed by a bit choosing between the deltas and the
+			absolute values, and a changed bit for the rotation followed by
+			its word. Entities past the baseline are written in full
+		*/
+		void encode(const quantized_snapshot& snapshot, const quantized_snapshot* baseline, std::vector<std::uint8_t>& buffer) const {
+			const std::size_t count = snapshot.size();
+			const std::size_t base_count = baseline ? std::min(baseline->size(), count) : 0;
+			const unsigned int rotation_bits = 2 + m_rotation_bits * 3;
+			buffer.clear();
+			buffer.reserve(8 + count * (m_position_bits[0] + m_position_bits[1] + m_position_bits[2] + rotation_bits + 3) / 8 + 8);
+			bit_writer writer(buffer);
+			writer.write(static_cast<std::uint32_t>(count), 32);
+			writer.write(static_cast<std::uint32_t>(base_count), 32);
+
+			// deltas and their flags a block at a time
+			const std::size_t lanes = detail::snapshot_lanes;
+			const std::uint32_t small = 1u << m_delta_bits;
+			std::uint32_t zigzag[3][lanes];
+			bool moved[lanes], near[lanes], turned[lanes];
+			for (std::size_t first = 0; first < base_count; first += lanes) {
+				const std::size_t n = std::min(lanes, base_count - first);
+				for (std::size_t k = 0; k < n; ++k) {
+					for (unsigned int i = 0; i < 3; ++i) {
+						const std::int32_t d = static_cast<std::int32_t>(snapshot.positions[i][first + k] - baseline->positions[i][first + k]);
+						zigzag[i][k] = (static_cast<std::uint32_t>(d) << 1) ^ static_cast<std::uint32_t>(d >> 31);
+					}
+					turned[k] = snapshot.rotations[first + k] != baseline->rotations[first + k];
+				}
+				for (std::size_t k = 0; k < n; ++k) {
+					moved[k] = (zigzag[0][k] | zigzag[1][k] | zigzag[2][k]) != 0;
+					near[k] = std::max(std::max(zigzag[0][k], zigzag[1][k]), zigzag[2][k]) < small;
+				}
+
+				for (std::size_t k = 0; k < n; ++k) {
+					writer.write(moved[k], 1);
+					if (moved[k]) {
+						writer.write(near[k], 1);
+						for (unsigned int i = 0; i < 3; ++i) {
+							if (near[k])
+								writer.write(zigzag[i][k], m_delta_bits);
+							else
+								writer.write(snapshot.positions[i][first + k], m_position_bits[i]);
+						}
+					}
+					writer.write(turned[k], 1);
+					if (turned[k])
+						writer.write(snapshot.rotations[first + k], rotation_bits);
+				}
+			}
+			for (std::size_t k = base_count; k < count; ++k) {
+				for (unsigned int i = 0; i < 3; ++i)
+					writer.write(snapshot.positions[i][k], m_position_bits[i]);
+				writer.write(snapshot.rotations[k], rotation_bits);
+			}
+			writer.flush();
+		}
+
+		// unpack a snapshot encoded against baseline, false when the data is
+		// truncated or was encoded against a baseline of a different size
+		bool decode(const std::uint8_t* data, const std::size_t size, const quantized_snapshot* baseline, quantized_snapshot& result) const {
+			bit_reader reader(data, size);
+			const std::size_t count = reader.read(32);
+			const std::size_t base_count = reader.read(32);
+			if (reader.overrun() || base_count > count || base_count != (baseline ? std::min(baseline->size(), count) : 0))
+				return false;
+			// every entity takes 2 bits at least
+			if (count > size * 4)
+				return false;
+			result.resize(count);
+			const unsigned int rotation_bits = 2 + m_rotation_bits * 3;
+
+			for (std::size_t k = 0; k < base_count; ++k) {
+				if (reader.read(1)) {
+					const bool near = reader.read(1) != 0;
+					for (unsigned int i = 0; i < 3; ++i) {
+						if (near) {
+							const std::uint32_t z = reader.read(m_delta_bits);
+							result.positions[i][k] = baseline->positions[i][k] + ((z >> 1) ^ (0u - (z & 1u)));
+						}
+						else
+							result.positions[i][k] = reader.read(m_position_bits[i]);
+					}
+				}
+				else {
+					for (unsigned int i = 0; i < 3; ++i)
+						result.positions[i][k] = baseline->positions[i][k];
+				}
+				result.rotations[k] = reader.read(1) ? reader.read(rotation_bits) : baseline->rotations[k];
+			}
+			for (std::size_t k = base_count; k < count; ++k) {
+				for (unsigned int i = 0; i < 3; ++i)
+					result.positions[i][k] = reader.read(m_position_bits[i]);
+				result.rotations[k] = reader.read(rotation_bits);
+			}
+			return !reader.overrun();
+		}
+
+	private:
+		// smallest three words of the quaternions in the lanes x, y, z, w
+		void encode_rotations(const float (&p)[4][detail::snapshot_lanes], std::uint32_t (&result)[detail::snapshot_lanes]) const {
+			const float scale = m_rotation_levels / (2.0f * detail::smallest_three_range);
+			const float levels = m_rotation_levels, range = detail::smallest_three_range;
+			const unsigned int bits = m_rotation_bits;
+			for (std::size_t k = 0; k < detail::snapshot_lanes; ++k) {
+				const float x = p[0][k], y = p[1][k], z = p[2][k], w = p[3][k];
+				const float ax = std::fabs(x), ay = std::fabs(y), az = std::fabs(z), aw = std::fabs(w);
+				// index of the largest component, the first one on ties
+				std::uint32_t largest = 0;
+				float m = ax;
+				largest = ay > m ? 1u : largest;
+				m = std::max(m, ay);
+				largest = az > m ? 2u : largest;
+				m = std::max(m, az);
+				largest = aw > m ? 3u : largest;
+				const float l = largest == 0 ? x : (largest == 1 ? y : (largest == 2 ? z : w));
+				// q and -q are the same rotation, the dropped component is made positive
+				const float sign = l < 0.0f ? -1.0f : 1.0f;
+				const float a = largest == 0 ? y : x;
+				const float b = largest <= 1 ? z : y;
+				const float c = largest <= 2 ? w : z;
+				const float offset = range * scale + 0.5f;
+				const std::uint32_t qa = static_cast<std::uint32_t>(static_cast<std::int32_t>(std::min(std::max(a * sign * scale + offset, 0.0f), levels)));
+				const std::uint32_t qb = static_cast<std::uint32_t>(static_cast<std::int32_t>(std::min(std::max(b * sign * scale + offset, 0.0f), levels)));
+				const std::uint32_t qc = static_cast<std::uint32_t>(static_cast<std::int32_t>(std::min(std::max(c * sign * scale + offset, 0.0f), levels)));
+				result[k] = (largest << (bits * 3)) | (qa << (bits * 2)) | (qb << bits) | qc;
+			}
+		}
+
+		void decode_rotations(const std::uint32_t (&words)[detail::snapshot_lanes], float (&p)[4][detail::snapshot_lanes]) const {
+			const float step = 2.0f * detail::smallest_three_range / m_rotation_levels;
+			const float range = detail::smallest_three_range;
+			const unsigned int bits = m_rotation_bits;
+			const std::uint32_t mask = (1u << bits) - 1;
+			float a[detail::snapshot_lanes], b[detail::snapshot_lanes], c[detail::snapshot_lanes], l[detail::snapshot_lanes];
+			for (std::size_t k = 0; k < detail::snapshot_lanes; ++k) {
+				a[k] = static_cast<float>(static_cast<std::int32_t>((words[k] >> (bits * 2)) & mask)) * step - range;
+				b[k] = static_cast<float>(static_cast<std::int32_t>((words[k] >> bits) & mask)) * step - range;
+				c[k] = static_cast<float>(static_cast<std::int32_t>(words[k] & mask)) * step - range;
+				l[k] = std::max(1.0f - a[k] * a[k] - b[k] * b[k] - c[k] * c[k], 0.0f);
+			}
+			for (std::size_t k = 0; k < detail::snapshot_lanes; ++k)
+				l[k] = std::sqrt(l[k]);
+			for (std::size_t k = 0; k < detail::snapshot_lanes; ++k) {
+				const std::uint32_t largest = words[k] >> (bits * 3);
+				p[0][k] = largest == 0 ? l[k] : a[k];
+				p[1][k] = largest == 0 ? a[k] : (largest == 1 ? l[k] : b[k]);
+				p[2][k] = largest <= 1 ? b[k] : (largest == 2 ? l[k] : c[k]);
+				p[3][k] = largest == 3 ? l[k] : c[k];
+			}
+		}
+
+		float m_min[3];
+		float m_scale[3];
+		float m_step[3];
+		float m_levels[3];
+		unsigned int m_position_bits[3];
+		unsigned int m_rotation_bits;
+		unsigned int m_delta_bits;
+		float m_rotation_levels;
+	};
+};
\ No newline at end of file
@@ -0,0 +1,79 @@
+#pragma once
+
+/*
+	Structure of arrays views
+	Vito Domenico Tagliente
+	math library for games
+*/
+
+#include <array>
+#include "vector.h"
+#include "matrix.h"
+
+namespace math4games
+{
+	// view over count vectors stored as one array per component,
+	// the i-th component of the k-th vector is data[i][k]
+	template<std::size_t N, typename T>
+	struct soa_vector
+	{
+		// component arrays
+		std::array<T*, N> data;
+
+		// num of vectors
+		std::size_t count;
+
+		// gather the k-th vector
+		base_vector<N, T> get(const std::size_t k) const {
+			base_vector<N, T> v;
+			for (unsigned int i = 0; i < N; ++i)
+				v[i] = data[i][k];
+			return v;
+		}
+
+		// scatter the k-th vector
+		void set(const std::size_t k, const base_vector<N, T>& v) {
+			for (unsigned int i = 0; i < N; ++i)
+				data[i][k] = v[i];
+		}
+	};
+
+	// view over count matrices stored as one array per element,
+	// the element at row r and column c of the k-th matrix is data[r * M + c][k]
+	template<std::size_t N, std::size_t M, typename T>
+	struct soa_matrix
+	{
+		// element arrays
+		std::array<T*, N * M> data;
+
+		// num of matrices
+		std::size_t count;
+
+		// gather the k-th matrix
+		base_matrix<N, M, T> get(const std::size_t k) const {
+			base_matrix<N, M, T> m;
+			for (unsigned int i = 0; i < N * M; ++i)
+				m.data[i] = data[i][k];
+			return m;
+		}
+
+		// scatter the k-th matrix
+		void set(const std::size_t k, const base_matrix<N, M, T>& m) {
+			for (unsigned int i = 0; i < N * M; ++i)
+				data[i][k] = m.data[i];
+		}
+	};
+
+	// soa types
+	typedef soa_vector<2, float> soa_vec2;
+	typedef soa_vector<3, float> soa_vec3;
+	typedef soa_vector<4, float> soa_vec4;
+	typedef soa_matrix<3, 3, float> soa_mat3;
+	typedef soa_matrix<4, 4, float> soa_mat4;
+
+	typedef soa_vector<2, double> soa_dvec2;
+	typedef soa_vector<3, double> soa_dvec3;
+	typedef soa_vector<4, double> soa_dvec4;
+	typedef soa_matrix<3, 3, double> soa_dmat3;
+	typedef soa_matrix<4, 4, double> soa_dmat4;
+};
\ No newline at end of file
@@ -0,0 +1,332 @@
+#pragma once
+
+/*
+	Space filling curves and spatial sorting
+	Vito Domenico Tagliente
+	math library for games
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <tuple>
+#include <vector>
+#include "vector.h"
+#include "point.h"
+#include "soa.h"
+#include "parallel.h"
+
+// use the bmi2 bit deposit and extract instructions when available,
+// define MATH4GAMES_BMI2 to force them (e.g. msvc with /arch:AVX2)
+#if defined(__BMI2__) && !defined(MATH4GAMES_BMI2)
+#define MATH4GAMES_BMI2
+#endif
+
+#ifdef MATH4GAMES_BMI2
+#include <immintrin.h>
+#endif
+
+namespace math4games
+{
+	namespace detail
+	{
+		const std::uint64_t morton2_mask = 0x5555555555555555ull;
+		const std::uint64_t morton3_mask = 0x1249249249249249ull;
+
+		// insert a zero bit between the 32 low bits of x
+		inline std::uint64_t spread2(std::uint64_t x) {
+#ifdef MATH4GAMES_BMI2
+			return _pdep_u64(x, morton2_mask);
+#else
+			x &= 0xffffffffull;
+			x = (x | x << 16) & 0x0000ffff0000ffffull;
+			x = (x | x << 8) & 0x00ff00ff00ff00ffull;
+			x = (x | x << 4) & 0x0f0f0f0f0f0f0f0full;
+			x = (x | x << 2) & 0x3333333333333333ull;
+			x = (x | x << 1) & 0x5555555555555555ull;
+			return x;
+#endif
+		}
+
+		inline std::uint32_t compact2(std::uint64_t x) {
+#ifdef MATH4GAMES_BMI2
+			return static_cast<std::uint32_t>(_pext_u64(x, morton2_mask));
+#else
+			x &= 0x5555555555555555ull;
+			x = (x ^ (x >> 1)) & 0x3333333333333333ull;
+			x = (x ^ (x >> 2)) & 0x0f0f0f0f0f0f0f0full;
+			x = (x ^ (x >> 4)) & 0x00ff00ff00ff00ffull;
+			x = (x ^ (x >> 8)) & 0x0000ffff0000ffffull;
+			x = (x ^ (x >> 16)) & 0x00000000ffffffffull;
+			return static_cast<std::uint32_t>(x);
+#endif
+		}
+
+		// insert two zero bits between the 21 low bits of x
+		inline std::uint64_t spread3(std::uint64_t x) {
+#ifdef MATH4GAMES_BMI2
+			return _pdep_u64(x, morton3_mask);
+#else
+			x &= 0x1fffffull;
+			x = (x | x << 32) & 0x001f00000000ffffull;
+			x = (x | x << 16) & 0x001f0000ff0000ffull;
+			x = (x | x << 8) & 0x100f00f00f00f00full;
+			x = (x | x << 4) & 0x10c30c30c30c30c3ull;
+			x = (x | x << 2) & 0x1249249249249249ull;
+			return x;
+#endif
+		}
+
+		inline std::uint32_t compact3(std::uint64_t x) {
+#ifdef MATH4GAMES_BMI2
+			return static_cast<std::uint32_t>(_pext_u64(x, morton3_mask));
+#else
+			x &= 0x1249249249249249ull;
+			x = (x ^ (x >> 2)) & 0x10c30c30c30c30c3ull;
+			x = (x ^ (x >> 4)) & 0x100f00f00f00f00full;
+			x = (x ^ (x >> 8)) & 0x001f0000ff0000ffull;
+			x = (x ^ (x >> 16)) & 0x001f00000000ffffull;
+			x = (x ^ (x >> 32)) & 0x00000000001fffffull;
+			return static_cast<std::uint32_t>(x);
+#endif
+		}
+
+		// Skilling's transform of the coordinates, b bits each, into the
+		// transposed Hilbert index: bit k of the index is in x[k % D]
+		template<std::size_t D>
+		void hilbert_transpose(std::uint32_t (&x)[D], const unsigned int bits) {
+			const std::uint32_t m = 1u << (bits - 1);
+			for (std::uint32_t q = m; q > 1; q >>= 1) {
+				const std::uint32_t p = q - 1;
+				for (std::size_t i = 0; i < D; ++i) {
+					if (x[i] & q) {
+						x[0] ^= p;
+					}
+					else {
+						const std::uint32_t t = (x[0] ^ x[i]) & p;
+						x[0] ^= t;
+						x[i] ^= t;
+					}
+				}
+			}
+			// gray encode
+			for (std::size_t i = 1; i < D; ++i)
+				x[i] ^= x[i - 1];
+			std::uint32_t t = 0;
+			for (std::uint32_t q = m; q > 1; q >>= 1) {
+				if (x[D - 1] & q)
+					t ^= q - 1;
+			}
+			for (std::size_t i = 0; i < D; ++i)
+				x[i] ^= t;
+		}
+	}
+
+	/*
+		Morton (Z order) codes interleave the bits of the coordinates,
+		x in the lowest bit. 2D codes take 32 bits per axis, 3D codes
+		21 bits per axis. Signed vectors are biased to unsigned first:
+		by 2^31 in 2D and 2^20 in 3D.
+	*/
+
+	inline std::uint64_t morton_encode(const base_vector<2, unsigned int>& v) {
+		return detail::spread2(v.data[0]) | detail::spread2(v.data[1]) << 1;
+	}
+
+	inline std::uint64_t morton_encode(const base_vector<3, unsigned int>& v) {
+		return detail::spread3(v.data[0]) | detail::spread3(v.data[1]) << 1 | detail::spread3(v.data[2]) << 2;
+	}
+
+	inline std::uint64_t morton_encode(const base_vector<2, int>& v) {
+		return detail::spread2(static_cast<std::uint32_t>(v.data[0]) ^ 0x80000000u)
+			| detail::spread2(static_cast<std::uint32_t>(v.data[1]) ^ 0x80000000u) << 1;
+	}
+
+	inline std::uint64_t morton_encode(const base_vector<3, int>& v) {
+		std::uint64_t code = 0;
+		for (unsigned int i = 0; i < 3; ++i)
+			code |= detail::spread3(static_cast<std::uint32_t>(v.data[i] + (1 << 20))) << i;
+		return code;
+	}
+
+	inline base_vector<2, unsigned int> morton_decode2(const std::uint64_t code) {
+		base_vector<2, unsigned int> v;
+		v.data[0] = detail::compact2(code);
+		v.data[1] = detail::compact2(code >> 1);
+		return v;
+	}
+
+	inline base_vector<3, unsigned int> morton_decode3(const std::uint64_t code) {
+		base_vector<3, unsigned int> v;
+		v.data[0] = detail::compact3(code);
+		v.data[1] = detail::compact3(code >> 1);
+		v.data[2] = detail::compact3(code >> 2);
+		return v;
+	}
+
+	// Hilbert curve index of a point on a 2^bits grid per axis,
+	// bits up to 32 in 2D and 21 in 3D. Consecutive indices are always
+	// neighbour cells, which gives better locality than Morton codes
+	inline std::uint64_t hilbert_encode(const base_vector<2, unsigned int>& v, const unsigned int bits = 32) {
+		assert(bits > 0 && bits <= 32);
+		std::uint32_t x[2] = { v.data[0], v.data[1] };
+		detail::hilbert_transpose(x, bits);
+		return detail::spread2(x[1]) | detail::spread2(x[0]) << 1;
+	}
+
+	inline std::uint64_t hilbert_encode(const base_vector<3, unsigned int>& v, const unsigned int bits = 21) {
+		assert(bits > 0 && bits <= 21);
+		std::uint32_t x[3] = { v.data[0], v.data[1], v.data[2] };
+		detail::hilbert_transpose(x, bits);
+		return detail::spread3(x[2]) | detail::spread3(x[1]) << 1 | detail::spread3(x[0]) << 2;
+	}
+
+	// the functions below take arrays of any point or vector type,
+	// see components
+
+	// bounding box of count points
+	template<typename P>
+	void bounds(const P* points, const std::size_t count, P& min, P& max) {
+		assert(count > 0);
+		min.data = max.data = points[0].data;
+		for (std::size_t k = 1; k < count; ++k) {
+			for (unsigned int i = 0; i < components<P>::value; ++i) {
+				min.data[i] = std::min(min.data[i], points[k].data[i]);
+				max.data[i] = std::max(max.data[i], points[k].data[i]);
+			}
+		}
+	}
+
+	// map points inside [min, max] to the integer grid [0, 2^bits - 1], outside points are clamped
+	template<typename P, typename Q>
+	void quantize(const P* points, Q* results, const std::size_t count,
+		const P& min, const P& max, const unsigned int bits = 21) {
+		const std::size_t N = components<P>::value;
+		static_assert(components<Q>::value == N, "quantized points have the components of the points");
+		assert(bits > 0 && bits <= 32);
+		// in double, so that 2^32 - 1 cells are exact and rounding stays in range
+		const double cells = static_cast<double>((1ull << bits) - 1);
+		double scale[N];
+		for (unsigned int i = 0; i < N; ++i) {
+			const double extent = static_cast<double>(max.data[i]) - static_cast<double>(min.data[i]);
+			scale[i] = extent > 0.0 ? cells / extent : 0.0;
+		}
+		for (std::size_t k = 0; k < count; ++k) {
+			for (unsigned int i = 0; i < N; ++i) {
+				const double q = (static_cast<double>(points[k].data[i]) - static_cast<double>(min.data[i])) * scale[i];
+				results[k].data[i] = static_cast<unsigned int>(std::min(std::max(q, 0.0), cells) + 0.5);
+			}
+		}
+	}
+
+	// Morton and Hilbert keys of points inside the box [min, max]
+	template<typename P>
+	void morton_keys(const P* points, std::uint64_t* keys, const std::size_t count, const P& min, const P& max) {
+		const unsigned int bits = components<P>::value == 2 ? 32 : 21;
+		base_vector<components<P>::value, unsigned int> q;
+		for (std::size_t k = 0; k < count; ++k) {
+			quantize(points + k, &q, 1, min, max, bits);
+			keys[k] = morton_encode(q);
+		}
+	}
+
+	template<typename P>
+	void hilbert_keys(const P* points, std::uint64_t* keys, const std::size_t count, const P& min, const P& max) {
+		const unsigned int bits = components<P>::value == 2 ? 32 : 21;
+		base_vector<components<P>::value, unsigned int> q;
+		for (std::size_t k = 0; k < count; ++k) {
+			quantize(points + k, &q, 1, min, max, bits);
+			keys[k] = hilbert_encode(q, bits);
+		}
+	}
+
+	// stable lsd radix sort of 64 bit keys, 8 bits per pass, skipping the
+	// passes above key_bits. keys are sorted in place and order receives
+	// the permutation: sorted keys[i] is the original keys[order[i]].
+	// Each pass histograms and scatters one range of keys per thread
+	inline void radix_sort(std::uint64_t* keys, std::uint32_t* order, const std::size_t count,
+		const unsigned int key_bits = 64, const unsigned int threads = 0) {
+		const unsigned int workers = thread_count(threads);
+		std::vector<std::uint64_t> key_buffer(count);
+		std::vector<std::uint32_t> order_buffer(count);
+		std::vector<std::size_t> offsets(workers * 256);
+
+		for (std::size_t i = 0; i < count; ++i)
+			order[i] = static_cast<std::uint32_t>(i);
+
+		std::uint64_t* src_keys = keys;
+		std::uint64_t* dst_keys = key_buffer.data();
+		std::uint32_t* src_order = order;
+		std::uint32_t* dst_order = order_buffer.data();
+
+		for (unsigned int shift = 0; shift < key_bits && shift < 64; shift += 8) {
+			std::fill(offsets.begin(), offsets.end(), 0);
+			parallel_for(count, [&](const unsigned int t, const std::size_t begin, const std::size_t end) {
+				std::size_t* histogram = offsets.data() + t * 256;
+				for (std::size_t i = begin; i < end; ++i)
+					histogram[(src_keys[i] >> shift) & 0xff]++;
+			}, workers);
+
+			// exclusive prefix sum by digit, then by thread, keeps the sort stable
+			std::size_t sum = 0;
+			for (unsigned int digit = 0; digit < 256; ++digit) {
+				for (unsigned int t = 0; t < workers; ++t) {
+					const std::size_t n = offsets[t * 256 + digit];
+					offsets[t * 256 + digit] = sum;
+					sum += n;
+				}
+			}
+
+			parallel_for(count, [&](const unsigned int t, const std::size_t begin, const std::size_t end) {
+				std::size_t* offset = offsets.data() + t * 256;
+				for (std::size_t i = begin; i < end; ++i) {
+					const std::size_t j = offset[(src_keys[i] >> shift) & 0xff]++;
+					dst_keys[j] = src_keys[i];
+					dst_order[j] = src_order[i];
+				}
+			}, workers);
+
+			std::swap(src_keys, dst_keys);
+			std::swap(src_order, dst_order);
+		}
+
+		// odd num of passes, the result is in the buffers
+		if (src_keys != keys) {
+			std::copy(src_keys, src_keys + count, keys);
+			std::copy(src_order, src_order + count, order);
+		}
+	}
+
+	// results[i] = values[order[i]]
+	template<typename T>
+	void reorder(const T* values, T* results, const std::uint32_t* order, const std::size_t count) {
+		for (std::size_t i = 0; i < count; ++i)
+			results[i] = values[order[i]];
+	}
+
+	template<std::size_t N, typename T>
+	void reorder(const soa_vector<N, T>& values, soa_vector<N, T>& results, const std::uint32_t* order) {
+		assert(results.count >= values.count);
+		for (unsigned int c = 0; c < N; ++c) {
+			const T* in = values.data[c];
+			T* out = results.data[c];
+			for (std::size_t i = 0; i < values.count; ++i)
+				out[i] = in[order[i]];
+		}
+	}
+
+	// sort points along the Hilbert curve of their bounding box, order
+	// receives the permutation to apply to any data stored alongside them
+	template<typename P>
+	void spatial_sort(P* points, std::uint32_t* order, const std::size_t count, const unsigned int threads = 0) {
+		if (count == 0)
+			return;
+		P min, max;
+		bounds(points, count, min, max);
+		std::vector<std::uint64_t> keys(count);
+		hilbert_keys(points, keys.data(), count, min, max);
+		radix_sort(keys.data(), order, count, components<P>::value == 2 ? 64 : 63, threads);
+		std::vector<P> sorted(count);
+		reorder(points, sorted.data(), order, count);
+		std::copy(sorted.begin(), sorted.end(), points);
+	}
+};
\ No newline at end of file
@@ -0,0 +1,250 @@
+#pragma once
+
+/*
+	Spline curves
+	Vito Domenico Tagliente
+	math library for games
+*/
+
+#include <algorithm>
+#include <vector>
+#include "vector.h"
+
+namespace math4games
+{
+	// cubic curve segment in power basis: p(t) = c0 + c1 t + c2 t^2 + c3 t^3, t in [0, 1]
+	template<std::size_t N, typename T>
+	struct cubic_segment
+	{
+		base_vector<N, T> c[4];
+
+		// position at t
+		base_vector<N, T> evaluate(const T t) const {
+			return ((c[3] * t + c[2]) * t + c[1]) * t + c[0];
+		}
+
+		// first derivative at t
+		base_vector<N, T> derivative(const T t) const {
+			return (c[3] * (static_cast<T>(3.0) * t) + c[2] * static_cast<T>(2.0)) * t + c[1];
+		}
+
+		// second derivative at t
+		base_vector<N, T> second_derivative(const T t) const {
+			return c[3] * (static_cast<T>(6.0) * t) + c[2] * static_cast<T>(2.0);
+		}
+
+		// count samples at t = t0, t0 + h, t0 + 2h, ... by forward differencing:
+		// three vector additions per sample instead of a polynomial evaluation.
+		// out is an array of any vector or point type with N components
+		template<typename V>
+		void forward_difference(const T t0, const T h, V* out, const std::size_t count) const {
+			static_assert(components<V>::value == N, "samples have N components");
+			const T h2 = h * h;
+			const T h3 = h2 * h;
+			base_vector<N, T> f = evaluate(t0);
+			base_vector<N, T> d1 = c[1] * h + c[2] * (static_cast<T>(2.0) * t0 * h + h2)
+				+ c[3] * (static_cast<T>(3.0) * (t0 * t0 * h + t0 * h2) + h3);
+			base_vector<N, T> d2 = c[2] * (static_cast<T>(2.0) * h2) + c[3] * (static_cast<T>(6.0) * (t0 * h2 + h3));
+			const base_vector<N, T> d3 = c[3] * (static_cast<T>(6.0) * h3);
+			for (std::size_t i = 0; i < count; ++i) {
+				out[i].data = f.data;
+				f += d1;
+				d1 += d2;
+				d2 += d3;
+			}
+		}
+
+		// segment from the four control points of a cubic Bezier curve
+		static cubic_segment bezier(const base_vector<N, T>& p0, const base_vector<N, T>& p1,
+			const base_vector<N, T>& p2, const base_vector<N, T>& p3) {
+			cubic_segment s;
+			s.c[0] = p0;
+			s.c[1] = (p1 - p0) * static_cast<T>(3.0);
+			s.c[2] = (p0 - p1 * static_cast<T>(2.0) + p2) * static_cast<T>(3.0);
+			s.c[3] = p3 - p0 + (p1 - p2) * static_cast<T>(3.0);
+			return s;
+		}
+
+		// segment from two points and their tangents
+		static cubic_segment hermite(const base_vector<N, T>& p0, const base_vector<N, T>& m0,
+			const base_vector<N, T>& p1, const base_vector<N, T>& m1) {
+			cubic_segment s;
+			s.c[0] = p0;
+			s.c[1] = m0;
+			s.c[2] = (p1 - p0) * static_cast<T>(3.0) - m0 * static_cast<T>(2.0) - m1;
+			s.c[3] = (p0 - p1) * static_cast<T>(2.0) + m0 + m1;
+			return s;
+		}
+
+		// uniform Catmull-Rom segment between p1 and p2
+		static cubic_segment catmull_rom(const base_vector<N, T>& p0, const base_vector<N, T>& p1,
+			const base_vector<N, T>& p2, const base_vector<N, T>& p3) {
+			return hermite(p1, (p2 - p0) * static_cast<T>(0.5), p2, (p3 - p1) * static_cast<T>(0.5));
+		}
+
+		// uniform cubic B-spline segment
+		static cubic_segment bspline(const base_vector<N, T>& p0, const base_vector<N, T>& p1,
+			const base_vector<N, T>& p2, const base_vector<N, T>& p3) {
+			const T f = static_cast<T>(1.0) / static_cast<T>(6.0);
+			cubic_segment s;
+			s.c[0] = (p0 + p1 * static_cast<T>(4.0) + p2) * f;
+			s.c[1] = (p2 - p0) * static_cast<T>(0.5);
+			s.c[2] = (p0 - p1 * static_cast<T>(2.0) + p2) * static_cast<T>(0.5);
+			s.c[3] = (p3 - p0 + (p1 - p2) * static_cast<T>(3.0)) * f;
+			return s;
+		}
+	};
+
+	// spline kinds, they differ in how control points map to segments
+	enum class spline_type
+	{
+		bezier,			// p0 p1 p2 p3, p3 p4 p5 p6, ...: 3k + 1 points
+		hermite,		// p0 m0, p1 m1, ...: point and tangent pairs
+		catmull_rom,	// interpolates all points but the first and the last
+		bspline			// uniform cubic B-spline, approximates the points
+	};
+
+	// piecewise cubic curve, parameterized by u in [0, segments()]
+	template<std::size_t N, typename T>
+	struct spline
+	{
+		spline_type type;
+
+		// control points
+		std::vector<base_vector<N, T>> points;
+
+		spline(const spline_type _type = spline_type::catmull_rom)
+			: type(_type) {}
+
+		// num of segments
+		std::size_t segments() const {
+			const std::size_t n = points.size();
+			switch (type) {
+			case spline_type::bezier: return n >= 4 ? (n - 1) / 3 : 0;
+			case spline_type::hermite: return n >= 4 ? n / 2 - 1 : 0;
+			default: return n >= 4 ? n - 3 : 0;
+			}
+		}
+
+		// the i-th segment in power basis
+		cubic_segment<N, T> segment(const std::size_t i) const {
+			assert(i < segments());
+			switch (type) {
+			case spline_type::bezier:
+				return cubic_segment<N, T>::bezier(points[3 * i], points[3 * i + 1], points[3 * i + 2], points[3 * i + 3]);
+			case spline_type::hermite:
+				return cubic_segment<N, T>::hermite(points[2 * i], points[2 * i + 1], points[2 * i + 2], points[2 * i + 3]);
+			case spline_type::catmull_rom:
+				return cubic_segment<N, T>::catmull_rom(points[i], points[i + 1], points[i + 2], points[i + 3]);
+			default:
+				return cubic_segment<N, T>::bspline(points[i], points[i + 1], points[i + 2], points[i + 3]);
+			}
+		}
+
+		// position at u
+		base_vector<N, T> evaluate(const T u) const {
+			std::size_t i;
+			const T t = locate(u, i);
+			return segment(i).evaluate(t);
+		}
+
+		// derivative with respect to u
+		base_vector<N, T> derivative(const T u) const {
+			std::size_t i;
+			const T t = locate(u, i);
+			return segment(i).derivative(t);
+		}
+
+		// count samples uniformly spaced in u over the whole curve,
+		// endpoints included, computed by forward differencing, into
+		// an array of any vector or point type with N components
+		template<typename V>
+		void tessellate(V* out, const std::size_t count) const {
+			const std::size_t n = segments();
+			assert(n > 0);
+			if (count == 0)
+				return;
+			if (count == 1) {
+				out[0].data = evaluate(T{}).data;
+				return;
+			}
+
+			const T h = static_cast<T>(n) / static_cast<T>(count - 1);
+			std::size_t k = 0;
+			for (std::size_t i = 0; i < n && k < count; ++i) {
+				// samples whose u falls in [i, i + 1), the last segment takes the end point too
+				const T t0 = static_cast<T>(k) * h - static_cast<T>(i);
+				const T remaining = std::ceil((static_cast<T>(i + 1) - static_cast<T>(k) * h) / h);
+				std::size_t m = i + 1 == n ? count - k
+					: static_cast<std::size_t>(std::max(remaining, T{}));
+				m = std::min(m, count - k);
+				segment(i).forward_difference(t0, h, out + k, m);
+				k += m;
+			}
+		}
+
+	private:
+		// segment index and local parameter of u
+		T locate(const T u, std::size_t& i) const {
+			const std::size_t n = segments();
+			assert(n > 0);
+			const T clamped = std::max(T{}, std::min(u, static_cast<T>(n)));
+			i = std::min(static_cast<std::size_t>(clamped), n - 1);
+			return clamped - static_cast<T>(i);
+		}
+	};
+
+	// arc length parameterization: cumulative length sampled at uniform u
+	template<std::size_t N, typename T>
+	struct arc_length_table
+	{
+		// u step between entries
+		T step = T{};
+
+		// length from the start of the curve to u = i * step
+		std::vector<T> lengths;
+
+		arc_length_table() = default;
+
+		arc_length_table(const spline<N, T>& curve, const std::size_t samples = 256) {
+			build(curve, samples);
+		}
+
+		// sample the curve, samples >= 2
+		void build(const spline<N, T>& curve, const std::size_t samples = 256) {
+			assert(samples >= 2);
+			std::vector<base_vector<N, T>> p(samples);
+			curve.tessellate(p.data(), samples);
+			step = static_cast<T>(curve.segments()) / static_cast<T>(samples - 1);
+			lengths.resize(samples);
+			lengths[0] = T{};
+			for (std::size_t i = 1; i < samples; ++i)
+				lengths[i] = lengths[i - 1] + p[i].distance(p[i - 1]);
+		}
+
+		// total length
+		T length() const {
+			return lengths.empty() ? T{} : lengths.back();
+		}
+
+		// curve parameter at distance s from the start
+		T parameter(const T s) const {
+			assert(!lengths.empty());
+			const auto it = std::upper_bound(lengths.begin(), lengths.end(), s);
+			if (it == lengths.begin())
+				return T{};
+			if (it == lengths.end())
+				return static_cast<T>(lengths.size() - 1) * step;
+			const std::size_t i = static_cast<std::size_t>(it - lengths.begin()) - 1;
+			const T d = lengths[i + 1] - lengths[i];
+			const T f = d > T{} ? (s - lengths[i]) / d : T{};
+			return (static_cast<T>(i) + f) * step;
+		}
+	};
+
+	// spline types
+	typedef spline<2, float> spline2;
+	typedef spline<3, float> spline3;
+	typedef spline<2, double> dspline2;
+	typedef spline<3, double> dspline3;
+};
\ No newline at end of file
@@ -0,0 +1,298 @@
+#pragma once
+
+/*
+	Singular value and polar decomposition of 3x3 matrices
+	Vito Domenico Tagliente
+	math library for games
+*/
+
+#include <cmath>
+#include "vector.h"
+#include "matrix.h"
+#include "quaternion.h"
+#include "soa.h"
+
+namespace math4games
+{
+	// result of a 3x3 singular value decomposition: m = u * diag(s) * v^t
+	// u and v are proper rotations, so the last singular value carries
+	// the sign of the determinant
+	struct svd3
+	{
+		base_matrix<3, 3, float> u;
+		base_vector<3, float> s;
+		base_matrix<3, 3, float> v;
+	};
+
+	// result of a 3x3 polar decomposition: m = rotation * stretch
+	struct polar3
+	{
+		// proper rotation
+		base_matrix<3, 3, float> rotation;
+		// symmetric stretch
+		base_matrix<3, 3, float> stretch;
+
+		// rotation as quaternion
+		quaternion orientation() const {
+			return to_quaternion(rotation);
+		}
+	};
+
+	namespace detail
+	{
+		// The kernels below work on Lanes matrices at once, element i of the
+		// l-th matrix is x[i][l] (row major). Every step is a straight loop
+		// over the lanes, without branches, so that the compiler can map it
+		// on simd registers; Lanes = 1 is the scalar version.
+		// Note that gcc and clang only vectorize std::sqrt with -fno-math-errno.
+
+		// one Jacobi conjugation of the symmetric s on the (p, q) plane,
+		// accumulated into v
+		template<unsigned int Lanes>
+		inline void svd_jacobi(float (&s)[9][Lanes], float (&v)[9][Lanes], const unsigned int p, const unsigned int q) {
+			float c[Lanes], sn[Lanes];
+			for (unsigned int l = 0; l < Lanes; ++l) {
+				// rotation angle which annihilates s(p, q), identity if already zero
+				const float spq = s[p * 3 + q][l];
+				const float theta = (s[q * 3 + q][l] - s[p * 3 + p][l]) / (2.0f * (spq != 0.0f ? spq : 1.0f));
+				const float t = spq != 0.0f ? std::copysign(1.0f, theta) / (std::abs(theta) + std::sqrt(theta * theta + 1.0f)) : 0.0f;
+				c[l] = 1.0f / std::sqrt(t * t + 1.0f);
+				sn[l] = -t * c[l];
+			}
+
+			// s = G^t * s * G, v = v * G
+			for (unsigned int k = 0; k < 3; ++k) {
+				for (unsigned int l = 0; l < Lanes; ++l) {
+					const float skp = s[k * 3 + p][l];
+					const float skq = s[k * 3 + q][l];
+					s[k * 3 + p][l] = c[l] * skp + sn[l] * skq;
+					s[k * 3 + q][l] = c[l] * skq - sn[l] * skp;
+				}
+			}
+			for (unsigned int k = 0; k < 3; ++k) {
+				for (unsigned int l = 0; l < Lanes; ++l) {
+					const float spk = s[p * 3 + k][l];
+					const float sqk = s[q * 3 + k][l];
+					s[p * 3 + k][l] = c[l] * spk + sn[l] * sqk;
+					s[q * 3 + k][l] = c[l] * sqk - sn[l] * spk;
+				}
+			}
+			for (unsigned int k = 0; k < 3; ++k) {
+				for (unsigned int l = 0; l < Lanes; ++l) {
+					const float vkp = v[k * 3 + p][l];
+					const float vkq = v[k * 3 + q][l];
+					v[k * 3 + p][l] = c[l] * vkp + sn[l] * vkq;
+					v[k * 3 + q][l] = c[l] * vkq - sn[l] * vkp;
+				}
+			}
+		}
+
+		// swap the columns i and j of b and v when column j of b is longer,
+		// negating one of them to preserve the determinant of v
+		template<unsigned int Lanes>
+		inline void svd_sort(float (&b)[9][Lanes], float (&v)[9][Lanes], const unsigned int i, const unsigned int j) {
+			bool swap[Lanes];
+			for (unsigned int l = 0; l < Lanes; ++l) {
+				const float ni = b[i][l] * b[i][l] + b[3 + i][l] * b[3 + i][l] + b[6 + i][l] * b[6 + i][l];
+				const float nj = b[j][l] * b[j][l] + b[3 + j][l] * b[3 + j][l] + b[6 + j][l] * b[6 + j][l];
+				swap[l] = ni < nj;
+			}
+			for (unsigned int k = 0; k < 3; ++k) {
+				for (unsigned int l = 0; l < Lanes; ++l) {
+					const float bi = b[k * 3 + i][l];
+					const float bj = b[k * 3 + j][l];
+					b[k * 3 + i][l] = swap[l] ? bj : bi;
+					b[k * 3 + j][l] = swap[l] ? -bi : bj;
+					const float vi = v[k * 3 + i][l];
+					const float vj = v[k * 3 + j][l];
+					v[k * 3 + i][l] = swap[l] ? vj : vi;
+					v[k * 3 + j][l] = swap[l] ? -vi : vj;
+				}
+			}
+		}
+
+		// Givens rotation of the rows p and q of b which zeroes b(q, k),
+		// accumulated into u
+		template<unsigned int Lanes>
+		inline void svd_qr(float (&b)[9][Lanes], float (&u)[9][Lanes], const unsigned int p, const unsigned int q, const unsigned int k) {
+			float c[Lanes], sn[Lanes];
+			for (unsigned int l = 0; l < Lanes; ++l) {
+				const float a1 = b[p * 3 + k][l];
+				const float a2 = b[q * 3 + k][l];
+				const float rho = std::sqrt(a1 * a1 + a2 * a2);
+				const float f = 1.0f / (rho > 0.0f ? rho : 1.0f);
+				c[l] = rho > 0.0f ? a1 * f : 1.0f;
+				sn[l] = a2 * f;
+			}
+			for (unsigned int j = 0; j < 3; ++j) {
+				for (unsigned int l = 0; l < Lanes; ++l) {
+					const float bp = b[p * 3 + j][l];
+					const float bq = b[q * 3 + j][l];
+					b[p * 3 + j][l] = c[l] * bp + sn[l] * bq;
+					b[q * 3 + j][l] = c[l] * bq - sn[l] * bp;
+				}
+			}
+			for (unsigned int j = 0; j < 3; ++j) {
+				for (unsigned int l = 0; l < Lanes; ++l) {
+					const float up = u[j * 3 + p][l];
+					const float uq = u[j * 3 + q][l];
+					u[j * 3 + p][l] = c[l] * up + sn[l] * uq;
+					u[j * 3 + q][l] = c[l] * uq - sn[l] * up;
+				}
+			}
+		}
+
+		// branch free svd kernel, a = u * diag(s) * v^t
+		template<unsigned int Lanes>
+		inline void svd_kernel(const float (&a)[9][Lanes], float (&u)[9][Lanes], float (&s)[3][Lanes], float (&v)[9][Lanes], const unsigned int sweeps) {
+			// symmetric eigen problem on a^t * a
+			float ata[9][Lanes];
+			for (unsigned int i = 0; i < 3; ++i) {
+				for (unsigned int j = 0; j < 3; ++j) {
+					for (unsigned int l = 0; l < Lanes; ++l)
+						ata[i * 3 + j][l] = a[i][l] * a[j][l] + a[3 + i][l] * a[3 + j][l] + a[6 + i][l] * a[6 + j][l];
+				}
+			}
+			for (unsigned int i = 0; i < 9; ++i) {
+				for (unsigned int l = 0; l < Lanes; ++l)
+					v[i][l] = (i % 4 == 0) ? 1.0f : 0.0f;
+			}
+			for (unsigned int sweep = 0; sweep < sweeps; ++sweep) {
+				svd_jacobi(ata, v, 0, 1);
+				svd_jacobi(ata, v, 0, 2);
+				svd_jacobi(ata, v, 1, 2);
+			}
+
+			// b = a * v, with columns sorted by decreasing length
+			float b[9][Lanes];
+			for (unsigned int i = 0; i < 3; ++i) {
+				for (unsigned int j = 0; j < 3; ++j) {
+					for (unsigned int l = 0; l < Lanes; ++l)
+						b[i * 3 + j][l] = a[i * 3][l] * v[j][l] + a[i * 3 + 1][l] * v[3 + j][l] + a[i * 3 + 2][l] * v[6 + j][l];
+				}
+			}
+			svd_sort(b, v, 0, 1);
+			svd_sort(b, v, 0, 2);
+			svd_sort(b, v, 1, 2);
+
+			// qr decomposition of b, r is diagonal up to rounding
+			for (unsigned int i = 0; i < 9; ++i) {
+				for (unsigned int l = 0; l < Lanes; ++l)
+					u[i][l] = (i % 4 == 0) ? 1.0f : 0.0f;
+			}
+			svd_qr(b, u, 0, 1, 0);
+			svd_qr(b, u, 0, 2, 0);
+			svd_qr(b, u, 1, 2, 1);
+
+			for (unsigned int l = 0; l < Lanes; ++l) {
+				s[0][l] = b[0][l];
+				s[1][l] = b[4][l];
+				s[2][l] = b[8][l];
+			}
+		}
+
+		// rotation = u * v^t, stretch = v * diag(s) * v^t
+		template<unsigned int Lanes>
+		inline void polar_kernel(const float (&u)[9][Lanes], const float (&s)[3][Lanes], const float (&v)[9][Lanes],
+			float (&rotation)[9][Lanes], float (&stretch)[9][Lanes]) {
+			for (unsigned int i = 0; i < 3; ++i) {
+				for (unsigned int j = 0; j < 3; ++j) {
+					for (unsigned int l = 0; l < Lanes; ++l) {
+						rotation[i * 3 + j][l] = u[i * 3][l] * v[j * 3][l] + u[i * 3 + 1][l] * v[j * 3 + 1][l] + u[i * 3 + 2][l] * v[j * 3 + 2][l];
+						stretch[i * 3 + j][l] = v[i * 3][l] * s[0][l] * v[j * 3][l] + v[i * 3 + 1][l] * s[1][l] * v[j * 3 + 1][l] + v[i * 3 + 2][l] * s[2][l] * v[j * 3 + 2][l];
+					}
+				}
+			}
+		}
+
+		// load up to Lanes matrices from soa storage, padding with zeros
+		template<std::size_t E, unsigned int Lanes>
+		inline void soa_load(float (&x)[E][Lanes], float* const* data, const std::size_t first, const std::size_t n) {
+			for (unsigned int i = 0; i < E; ++i) {
+				for (unsigned int l = 0; l < Lanes; ++l)
+					x[i][l] = l < n ? data[i][first + l] : 0.0f;
+			}
+		}
+
+		// store the first n lanes to soa storage
+		template<std::size_t E, unsigned int Lanes>
+		inline void soa_store(const float (&x)[E][Lanes], float* const* data, const std::size_t first, const std::size_t n) {
+			for (unsigned int i = 0; i < E; ++i) {
+				for (std::size_t l = 0; l < n; ++l)
+					data[i][first + l] = x[i][l];
+			}
+		}
+	}
+
+	// singular value decomposition with a fixed number of Jacobi sweeps
+	inline svd3 svd(const base_matrix<3, 3, float>& m, const unsigned int sweeps = 4) {
+		float a[9][1], u[9][1], s[3][1], v[9][1];
+		for (unsigned int i = 0; i < 9; ++i)
+			a[i][0] = m.data[i];
+		detail::svd_kernel(a, u, s, v, sweeps);
+
+		svd3 result;
+		for (unsigned int i = 0; i < 9; ++i) {
+			result.u.data[i] = u[i][0];
+			result.v.data[i] = v[i][0];
+		}
+		for (unsigned int i = 0; i < 3; ++i)
+			result.s[i] = s[i][0];
+		return result;
+	}
+
+	// polar decomposition, m = rotation * stretch
+	inline polar3 polar(const base_matrix<3, 3, float>& m, const unsigned int sweeps = 4) {
+		float a[9][1], u[9][1], s[3][1], v[9][1], r[9][1], p[9][1];
+		for (unsigned int i = 0; i < 9; ++i)
+			a[i][0] = m.data[i];
+		detail::svd_kernel(a, u, s, v, sweeps);
+		detail::polar_kernel(u, s, v, r, p);
+
+		polar3 result;
+		for (unsigned int i = 0; i < 9; ++i) {
+			result.rotation.data[i] = r[i][0];
+			result.stretch.data[i] = p[i][0];
+		}
+		return result;
+	}
+
+	// batch svd over structure of arrays storage, Lanes matrices at a time
+	// (4 for sse/neon, 8 for avx)
+	template<unsigned int Lanes = 8>
+	void svd(const soa_mat3& m, soa_mat3& u, soa_vec3& s, soa_mat3& v, const unsigned int sweeps = 4) {
+		float a[9][Lanes], bu[9][Lanes], bs[3][Lanes], bv[9][Lanes];
+		for (std::size_t first = 0; first < m.count; first += Lanes) {
+			const std::size_t n = (m.count - first < Lanes) ? m.count - first : Lanes;
+			detail::soa_load(a, m.data.data(), first, n);
+			detail::svd_kernel(a, bu, bs, bv, sweeps);
+			detail::soa_store(bu, u.data.data(), first, n);
+			detail::soa_store(bs, s.data.data(), first, n);
+			detail::soa_store(bv, v.data.data(), first, n);
+		}
+	}
+
+	// batch polar decomposition over structure of arrays storage
+	template<unsigned int Lanes = 8>
+	void polar(const soa_mat3& m, soa_mat3& rotation, soa_mat3& stretch, const unsigned int sweeps = 4) {
+		float a[9][Lanes], bu[9][Lanes], bs[3][Lanes], bv[9][Lanes], br[9][Lanes], bp[9][Lanes];
+		for (std::size_t first = 0; first < m.count; first += Lanes) {
+			const std::size_t n = (m.count - first < Lanes) ? m.count - first : Lanes;
+			detail::soa_load(a, m.data.data(), first, n);
+			detail::svd_kernel(a, bu, bs, bv, sweeps);
+			detail::polar_kernel(bu, bs, bv, br, bp);
+			detail::soa_store(br, rotation.data.data(), first, n);
+			detail::soa_store(bp, stretch.data.data(), first, n);
+		}
+	}
+
+	// batch polar decomposition returning the rotations as quaternions
+	inline void polar(const base_matrix<3, 3, float>* matrices, quaternion* rotations,
+		base_matrix<3, 3, float>* stretches, const std::size_t count, const unsigned int sweeps = 4) {
+		for (std::size_t i = 0; i < count; ++i) {
+			const polar3 p = polar(matrices[i], sweeps);
+			rotations[i] = p.orientation();
+			stretches[i] = p.stretch;
+		}
+	}
+};
\ No newline at end of file
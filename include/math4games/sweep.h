@@ -0,0 +1,682 @@
+#pragma once
+
+/*
+	Continuous collision
+	Vito Domenico Tagliente
+	math library for games
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include "vector.h"
+#include "convex.h"
+
+namespace math4games
+{
+	/*
+		Swept sphere and capsule tests: the shape moves by delta over the
+		time interval [0, 1] and the tests return the first time of impact
+		against a plane, an axis aligned box or a triangle, so that fast
+		movers cannot tunnel through thin geometry between two frames.
+		Shapes that already overlap at time 0 report a hit at time 0.
+
+		The batch functions test one sweep against many primitives or many
+		sweeps against one primitive. Spheres are tested 8 lanes at a time
+		with branch free kernels, the few lanes whose contact is on an edge
+		or a corner, or that start overlapping, fall back to the exact
+		scalar test.
+	*/
+
+	// half space, the points x with normal * x <= distance are solid
+	struct plane
+	{
+		vec3 normal;
+		float distance = 0.0f;
+
+		plane() = default;
+		plane(const vec3& _normal, const float _distance) : normal(_normal), distance(_distance) {}
+
+		// signed distance of p, positive in front of the plane
+		float signed_distance(const vec3& p) const {
+			return normal * p - distance;
+		}
+	};
+
+	// axis aligned box
+	struct aabb
+	{
+		vec3 min;
+		vec3 max;
+
+		aabb() = default;
+		aabb(const vec3& _min, const vec3& _max) : min(_min), max(_max) {}
+
+		// support function, an aabb is a convex shape for gjk
+		vec3 support(const vec3& direction) const {
+			return vec3(
+				direction.x < 0.0f ? min.x : max.x,
+				direction.y < 0.0f ? min.y : max.y,
+				direction.z < 0.0f ? min.z : max.z
+			);
+		}
+	};
+
+	struct triangle
+	{
+		vec3 a;
+		vec3 b;
+		vec3 c;
+
+		triangle() = default;
+		triangle(const vec3& _a, const vec3& _b, const vec3& _c) : a(_a), b(_b), c(_c) {}
+
+		// support function, a triangle is a convex shape for gjk
+		vec3 support(const vec3& direction) const {
+			const float da = direction * a, db = direction * b, dc = direction * c;
+			if (da >= db && da >= dc)
+				return a;
+			return db >= dc ? b : c;
+		}
+	};
+
+	// sphere moving from center to center + delta
+	struct swept_sphere
+	{
+		vec3 center;
+		float radius = 0.0f;
+		vec3 delta;
+	};
+
+	// capsule of segment a, b moving by delta
+	struct swept_capsule
+	{
+		vec3 a;
+		vec3 b;
+		float radius = 0.0f;
+		vec3 delta;
+	};
+
+	struct sweep_hit
+	{
+		bool hit = false;
+		// time of impact in [0, 1], fraction of delta
+		float time = 1.0f;
+		// unit contact normal, from the primitive towards the moving shape
+		vec3 normal;
+		// contact point on the primitive
+		vec3 point;
+	};
+
+	// closest points
+
+	inline vec3 closest_point(const aabb& box, const vec3& p) {
+		return vec3(
+			std::min(std::max(p.x, box.min.x), box.max.x),
+			std::min(std::max(p.y, box.min.y), box.max.y),
+			std::min(std::max(p.z, box.min.z), box.max.z)
+		);
+	}
+
+	// closest point of the segment a, b
+	inline vec3 closest_point(const vec3& a, const vec3& b, const vec3& p) {
+		const vec3 ab = b - a;
+		const float length = ab * ab;
+		if (length == 0.0f)
+			return a;
+		const float t = std::min(std::max(((p - a) * ab) / length, 0.0f), 1.0f);
+		return a + ab * t;
+	}
+
+	// by the Voronoi regions of the triangle
+	inline vec3 closest_point(const triangle& tri, const vec3& p) {
+		const vec3 ab = tri.b - tri.a, ac = tri.c - tri.a, ap = p - tri.a;
+		const float d1 = ab * ap, d2 = ac * ap;
+		if (d1 <= 0.0f && d2 <= 0.0f)
+			return tri.a;
+		const vec3 bp = p - tri.b;
+		const float d3 = ab * bp, d4 = ac * bp;
+		if (d3 >= 0.0f && d4 <= d3)
+			return tri.b;
+		const float vc = d1 * d4 - d3 * d2;
+		if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+			return tri.a + ab * (d1 / (d1 - d3));
+		const vec3 cp = p - tri.c;
+		const float d5 = ab * cp, d6 = ac * cp;
+		if (d6 >= 0.0f && d5 <= d6)
+			return tri.c;
+		const float vb = d5 * d2 - d1 * d6;
+		if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+			return tri.a + ac * (d2 / (d2 - d6));
+		const float va = d3 * d6 - d5 * d4;
+		if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+			return tri.b + (tri.c - tri.b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+		const float sum = va + vb + vc;
+		if (!(sum > 0.0f))
+			return closest_point(tri.a, tri.b, p);
+		return tri.a + ab * (vb / sum) + ac * (vc / sum);
+	}
+
+	namespace detail
+	{
+		// first time in [0, 1] at which the point o + t * d is within radius of center
+		inline bool ray_sphere(const vec3& o, const vec3& d, const vec3& center, const float radius, float& t) {
+			const vec3 m = o - center;
+			const float c = m * m - radius * radius;
+			if (c <= 0.0f) {
+				t = 0.0f;
+				return true;
+			}
+			const float b = m * d;
+			if (b >= 0.0f)
+				return false;
+			const float a = d * d;
+			const float discriminant = b * b - a * c;
+			if (discriminant < 0.0f)
+				return false;
+			t = (-b - std::sqrt(discriminant)) / a;
+			return t <= 1.0f;
+		}
+
+		// first time in [0, 1] at which the point o + t * d is within radius of the segment p, q
+		inline bool ray_capsule(const vec3& o, const vec3& d, const vec3& p, const vec3& q, const float radius, float& t) {
+			const vec3 e = q - p, m = o - p;
+			const float ee = e * e, md = m * e, nd = d * e;
+			bool hit = false;
+			t = std::numeric_limits<float>::max();
+
+			// side of the cylinder, in the space orthogonal to the axis
+			const float a = ee * (d * d) - nd * nd;
+			const float b = ee * (m * d) - nd * md;
+			const float c = ee * (m * m - radius * radius) - md * md;
+			if (a > 0.0f && b < 0.0f) {
+				const float discriminant = b * b - a * c;
+				if (discriminant >= 0.0f) {
+					const float tc = (-b - std::sqrt(discriminant)) / a;
+					const float s = md + tc * nd;
+					if (tc >= 0.0f && tc <= 1.0f && s >= 0.0f && s <= ee) {
+						t = tc;
+						hit = true;
+					}
+				}
+			}
+			// spherical caps
+			float ts;
+			if (ray_sphere(o, d, p, radius, ts) && ts < t) {
+				t = ts;
+				hit = true;
+			}
+			if (ray_sphere(o, d, q, radius, ts) && ts < t) {
+				t = ts;
+				hit = true;
+			}
+			return hit;
+		}
+
+		inline vec3 contact_normal(const vec3& from, const vec3& to, const vec3& fallback) {
+			vec3 n = to - from;
+			const float length = n.magnitude();
+			return length > 0.0f ? vec3(n * (1.0f / length)) : fallback;
+		}
+
+		inline sweep_hit make_hit(const float time, const vec3& normal, const vec3& point) {
+			sweep_hit h;
+			h.hit = true;
+			h.time = time;
+			h.normal = normal;
+			h.point = point;
+			return h;
+		}
+
+		// hit of a sphere against the capsule of segment p, q, the edges and corners of primitives
+		inline bool sweep_edge(const swept_sphere& s, const vec3& p, const vec3& q, sweep_hit& hit) {
+			float t;
+			if (!ray_capsule(s.center, s.delta, p, q, s.radius, t) || (hit.hit && t >= hit.time))
+				return false;
+			const vec3 center = s.center + s.delta * t;
+			const vec3 point = closest_point(p, q, center);
+			hit = make_hit(t, contact_normal(point, center, vec3(-s.delta)), point);
+			return true;
+		}
+	}
+
+	// sphere against primitives
+
+	inline sweep_hit sweep(const swept_sphere& s, const plane& p) {
+		const float s0 = p.signed_distance(s.center);
+		if (s0 <= s.radius)
+			return detail::make_hit(0.0f, p.normal, s.center - p.normal * s0);
+		const float dn = p.normal * s.delta;
+		if (dn >= 0.0f)
+			return sweep_hit();
+		const float t = (s0 - s.radius) / -dn;
+		if (t > 1.0f)
+			return sweep_hit();
+		return detail::make_hit(t, p.normal, s.center + s.delta * t - p.normal * s.radius);
+	}
+
+	inline sweep_hit sweep(const swept_sphere& s, const aabb& box) {
+		const vec3 closest = closest_point(box, s.center);
+		const vec3 offset = s.center - closest;
+		if (offset * offset <= s.radius * s.radius)
+			return detail::make_hit(0.0f, detail::contact_normal(closest, s.center, vec3(-s.delta)), closest);
+
+		// slabs of the box grown by the radius
+		float enter = 0.0f, exit = 1.0f;
+		unsigned int axis = 0;
+		for (unsigned int i = 0; i < 3; ++i) {
+			const float lo = box.min.data[i] - s.radius, hi = box.max.data[i] + s.radius;
+			const float c = s.center.data[i], d = s.delta.data[i];
+			if (d == 0.0f) {
+				if (c < lo || c > hi)
+					return sweep_hit();
+				continue;
+			}
+			float t0 = (lo - c) / d, t1 = (hi - c) / d;
+			if (t0 > t1)
+				std::swap(t0, t1);
+			if (t0 > enter) {
+				enter = t0;
+				axis = i;
+			}
+			exit = std::min(exit, t1);
+			if (enter > exit)
+				return sweep_hit();
+		}
+
+		// on a face, or on the rounded edges and corners of the grown box:
+		// the axes on which the entry point is outside of the box
+		const vec3 p = s.center + s.delta * enter;
+		unsigned int below = 0, above = 0;
+		for (unsigned int i = 0; i < 3; ++i) {
+			below |= static_cast<unsigned int>(p.data[i] < box.min.data[i]) << i;
+			above |= static_cast<unsigned int>(p.data[i] > box.max.data[i]) << i;
+		}
+		const unsigned int mask = below | above;
+		if (mask == 1u << axis) {
+			vec3 normal = vec3::zero;
+			normal.data[axis] = s.delta.data[axis] > 0.0f ? -1.0f : 1.0f;
+			return detail::make_hit(enter, normal, p - normal * s.radius);
+		}
+
+		// a corner region tests the three edges leaving the corner,
+		// an edge region the edge along the axis inside the box
+		vec3 corner;
+		for (unsigned int i = 0; i < 3; ++i)
+			corner.data[i] = (above >> i) & 1 ? box.max.data[i] : box.min.data[i];
+		sweep_hit hit;
+		for (unsigned int i = 0; i < 3; ++i) {
+			if (mask != 7u && ((mask >> i) & 1))
+				continue;
+			vec3 end = corner;
+			end.data[i] = (above >> i) & 1 ? box.min.data[i] : box.max.data[i];
+			detail::sweep_edge(s, corner, end, hit);
+		}
+		return hit;
+	}
+
+	inline sweep_hit sweep(const swept_sphere& s, const triangle& tri) {
+		const vec3 closest = closest_point(tri, s.center);
+		const vec3 offset = s.center - closest;
+		vec3 n = vec3(tri.b - tri.a).cross(tri.c - tri.a);
+		const float length = n.magnitude();
+		if (offset * offset <= s.radius * s.radius)
+			return detail::make_hit(0.0f, detail::contact_normal(closest, s.center, length > 0.0f ? n : vec3(-s.delta)), closest);
+
+		const float band = n * (s.center - tri.a);
+		// a sphere already within radius of the plane can only hit an edge
+		if (length > 0.0f && std::fabs(band) > s.radius * length) {
+			// the face, seen from the side of the sphere
+			n *= 1.0f / length;
+			const vec3 winding = n;
+			float s0 = n * (s.center - tri.a);
+			if (s0 < 0.0f) {
+				n = -n;
+				s0 = -s0;
+			}
+			const float dn = n * s.delta;
+			if (dn >= 0.0f)
+				return sweep_hit();
+			const float t = (s0 - s.radius) / -dn;
+			if (t > 1.0f)
+				return sweep_hit();
+			const vec3 q = s.center + s.delta * t - n * s.radius;
+			if (vec3(tri.b - tri.a).cross(q - tri.a) * winding >= 0.0f && vec3(tri.c - tri.b).cross(q - tri.b) * winding >= 0.0f
+				&& vec3(tri.a - tri.c).cross(q - tri.c) * winding >= 0.0f)
+				return detail::make_hit(t, n, q);
+		}
+
+		sweep_hit hit;
+		detail::sweep_edge(s, tri.a, tri.b, hit);
+		detail::sweep_edge(s, tri.b, tri.c, hit);
+		detail::sweep_edge(s, tri.c, tri.a, hit);
+		return hit;
+	}
+
+	// capsule against primitives
+
+	// the lower end reaches the plane first
+	inline sweep_hit sweep(const swept_capsule& s, const plane& p) {
+		swept_sphere end;
+		end.center = p.signed_distance(s.a) <= p.signed_distance(s.b) ? s.a : s.b;
+		end.radius = s.radius;
+		end.delta = s.delta;
+		return sweep(end, p);
+	}
+
+	namespace detail
+	{
+		/*
+			conservative advancement: the gjk distance d between the capsule
+			segment and the primitive, with its normal n, bounds the time
+			before contact by (d - radius) / (delta * n). The segment steps
+			by that time until the gap is below tolerance, warm starting gjk
+			from the previous step
+		*/
+		template<typename Primitive>
+		sweep_hit advance(const swept_capsule& s, const Primitive& primitive,
+			const unsigned int max_iterations = 32, const float tolerance = 1e-4f) {
+			convex_capsule segment;
+			gjk_cache cache;
+			float t = 0.0f;
+			for (unsigned int i = 0; i < max_iterations; ++i) {
+				segment.a = s.a + s.delta * t;
+				segment.b = s.b + s.delta * t;
+				const gjk_result result = gjk_distance(segment, primitive, &cache);
+				if (result.intersect)
+					return make_hit(t, vec3(-s.delta * (1.0f / std::max(s.delta.magnitude(), std::numeric_limits<float>::min()))), result.point_b);
+				const float gap = result.distance - s.radius;
+				const vec3 normal = (result.point_a - result.point_b) * (1.0f / result.distance);
+				if (gap <= tolerance)
+					return make_hit(t, normal, result.point_b);
+				const float closing = -(s.delta * normal);
+				if (closing <= 0.0f)
+					return sweep_hit();
+				t += gap / closing;
+				if (t > 1.0f)
+					return sweep_hit();
+			}
+			return sweep_hit();
+		}
+	}
+
+	inline sweep_hit sweep(const swept_capsule& s, const aabb& box) {
+		return detail::advance(s, box);
+	}
+
+	inline sweep_hit sweep(const swept_capsule& s, const triangle& tri) {
+		return detail::advance(s, tri);
+	}
+
+	namespace detail
+	{
+		// lanes of spheres and primitives for the batch kernels
+		template<std::size_t Lanes>
+		struct sphere_lanes
+		{
+			float center[3][Lanes];
+			float delta[3][Lanes];
+			float radius[Lanes];
+
+			void load(const std::size_t l, const swept_sphere& s) {
+				for (unsigned int i = 0; i < 3; ++i) {
+					center[i][l] = s.center.data[i];
+					delta[i][l] = s.delta.data[i];
+				}
+				radius[l] = s.radius;
+			}
+		};
+
+		template<typename Primitive, std::size_t Lanes> struct primitive_lanes;
+
+		template<std::size_t Lanes>
+		struct primitive_lanes<plane, Lanes>
+		{
+			float normal[3][Lanes];
+			float distance[Lanes];
+
+			void load(const std::size_t l, const plane& p) {
+				for (unsigned int i = 0; i < 3; ++i)
+					normal[i][l] = p.normal.data[i];
+				distance[l] = p.distance;
+			}
+		};
+
+		template<std::size_t Lanes>
+		struct primitive_lanes<aabb, Lanes>
+		{
+			float min[3][Lanes];
+			float max[3][Lanes];
+
+			void load(const std::size_t l, const aabb& box) {
+				for (unsigned int i = 0; i < 3; ++i) {
+					min[i][l] = box.min.data[i];
+					max[i][l] = box.max.data[i];
+				}
+			}
+		};
+
+		template<std::size_t Lanes>
+		struct primitive_lanes<triangle, Lanes>
+		{
+			float a[3][Lanes];
+			float b[3][Lanes];
+			float c[3][Lanes];
+
+			void load(const std::size_t l, const triangle& tri) {
+				for (unsigned int i = 0; i < 3; ++i) {
+					a[i][l] = tri.a.data[i];
+					b[i][l] = tri.b.data[i];
+					c[i][l] = tri.c.data[i];
+				}
+			}
+		};
+
+		// lane states
+		const unsigned int sweep_miss = 0;
+		const unsigned int sweep_face = 1;
+		const unsigned int sweep_exact = 2;
+
+		template<std::size_t Lanes>
+		void sweep_lanes(const sphere_lanes<Lanes>& s, const primitive_lanes<plane, Lanes>& p,
+			unsigned int (&state)[Lanes], float (&time)[Lanes], float (&normal)[3][Lanes]) {
+			for (std::size_t l = 0; l < Lanes; ++l) {
+				float s0 = -p.distance[l], dn = 0.0f;
+				for (unsigned int i = 0; i < 3; ++i) {
+					s0 += p.normal[i][l] * s.center[i][l];
+					dn += p.normal[i][l] * s.delta[i][l];
+					normal[i][l] = p.normal[i][l];
+				}
+				const float approach = (s0 - s.radius[l]) / std::max(-dn, std::numeric_limits<float>::min());
+				const float t = dn < 0.0f ? approach : 2.0f;
+				// an overlap at time 0 needs the contact point of the exact test
+				state[l] = s0 <= s.radius[l] ? sweep_exact : t <= 1.0f ? sweep_face : sweep_miss;
+				time[l] = t;
+			}
+		}
+
+		template<std::size_t Lanes>
+		void sweep_lanes(const sphere_lanes<Lanes>& s, const primitive_lanes<aabb, Lanes>& box,
+			unsigned int (&state)[Lanes], float (&time)[Lanes], float (&normal)[3][Lanes]) {
+			float enter[Lanes], exit[Lanes], near[3][Lanes];
+			for (std::size_t l = 0; l < Lanes; ++l) {
+				enter[l] = -std::numeric_limits<float>::max();
+				exit[l] = 1.0f;
+			}
+			// slabs of the box grown by the radius
+			for (unsigned int i = 0; i < 3; ++i) {
+				for (std::size_t l = 0; l < Lanes; ++l) {
+					const float lo = box.min[i][l] - s.radius[l], hi = box.max[i][l] + s.radius[l];
+					const float c = s.center[i][l], d = s.delta[i][l];
+					// a tiny delta instead of 0 sends the slab times to +-infinity
+					const float inverse = 1.0f / std::copysign(std::max(std::fabs(d), 1e-30f), d);
+					const float t0 = (lo - c) * inverse, t1 = (hi - c) * inverse;
+					near[i][l] = std::min(t0, t1);
+					enter[l] = std::max(enter[l], near[i][l]);
+					exit[l] = std::min(exit[l], std::max(t0, t1));
+				}
+			}
+			float axis[Lanes];
+			for (std::size_t l = 0; l < Lanes; ++l)
+				axis[l] = near[2][l] == enter[l] ? 2.0f : near[1][l] == enter[l] ? 1.0f : 0.0f;
+			for (std::size_t l = 0; l < Lanes; ++l) {
+				// the normal is along the entering axis and the entry point
+				// must be on that face of the original box
+				unsigned int face = 1;
+				for (unsigned int i = 0; i < 3; ++i) {
+					const bool entering = axis[l] == static_cast<float>(i);
+					const float p = s.center[i][l] + s.delta[i][l] * enter[l];
+					normal[i][l] = entering ? (s.delta[i][l] > 0.0f ? -1.0f : 1.0f) : 0.0f;
+					face &= entering | ((p >= box.min[i][l]) & (p <= box.max[i][l]));
+				}
+				const unsigned int hit = (enter[l] <= exit[l]) & (enter[l] <= 1.0f);
+				// starting inside the grown box may or may not be an overlap
+				const unsigned int exact = (enter[l] < 0.0f) | (face ^ 1u);
+				state[l] = hit * (sweep_face + exact * (sweep_exact - sweep_face));
+				time[l] = enter[l];
+			}
+		}
+
+		template<std::size_t Lanes>
+		void sweep_lanes(const sphere_lanes<Lanes>& s, const primitive_lanes<triangle, Lanes>& tri,
+			unsigned int (&state)[Lanes], float (&time)[Lanes], float (&normal)[3][Lanes]) {
+			for (std::size_t l = 0; l < Lanes; ++l) {
+				float ab[3], ac[3], n[3];
+				for (unsigned int i = 0; i < 3; ++i) {
+					ab[i] = tri.b[i][l] - tri.a[i][l];
+					ac[i] = tri.c[i][l] - tri.a[i][l];
+				}
+				n[0] = ab[1] * ac[2] - ab[2] * ac[1];
+				n[1] = ab[2] * ac[0] - ab[0] * ac[2];
+				n[2] = ab[0] * ac[1] - ab[1] * ac[0];
+				const float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+				float s0 = 0.0f;
+				for (unsigned int i = 0; i < 3; ++i)
+					s0 += n[i] * (s.center[i][l] - tri.a[i][l]);
+				// the face, seen from the side of the sphere
+				const float orientation = std::copysign(1.0f, s0) / std::max(length, std::numeric_limits<float>::min());
+				float dn = 0.0f;
+				for (unsigned int i = 0; i < 3; ++i) {
+					n[i] *= orientation;
+					dn += n[i] * s.delta[i][l];
+					normal[i][l] = n[i];
+				}
+				s0 *= orientation;
+				const float approach = (s0 - s.radius[l]) / std::max(-dn, std::numeric_limits<float>::min());
+				const float t = dn < 0.0f ? approach : 2.0f;
+
+				// contact point on the plane, inside the three edges
+				float q[3];
+				for (unsigned int i = 0; i < 3; ++i)
+					q[i] = s.center[i][l] + s.delta[i][l] * t - n[i] * s.radius[l];
+				unsigned int inside = 1;
+				const float (*v[3])[Lanes] = { tri.a, tri.b, tri.c };
+				for (unsigned int e = 0; e < 3; ++e) {
+					const float (*from)[Lanes] = v[e];
+					const float (*to)[Lanes] = v[(e + 1) % 3];
+					float edge[3], r[3];
+					for (unsigned int i = 0; i < 3; ++i) {
+						edge[i] = to[i][l] - from[i][l];
+						r[i] = q[i] - from[i][l];
+					}
+					const float side = n[0] * (edge[1] * r[2] - edge[2] * r[1]) + n[1] * (edge[2] * r[0] - edge[0] * r[2])
+						+ n[2] * (edge[0] * r[1] - edge[1] * r[0]);
+					// n may be flipped, the winding of a, b, c is on its unflipped side
+					inside &= side * orientation >= 0.0f;
+				}
+				// within radius of the plane at time 0, degenerate or on an edge: exact test
+				const unsigned int exact = (length == 0.0f) | (s0 <= s.radius[l]);
+				const unsigned int reached = t <= 1.0f;
+				state[l] = exact ? sweep_exact : reached * (sweep_exact - inside * (sweep_exact - sweep_face));
+				time[l] = t;
+			}
+		}
+
+		// runs the lane kernel over count pairs, sphere_at(k) and primitive_at(k)
+		// return pair k. Returns the index of the first hit in time, count if none
+		template<typename Primitive, typename SphereAt, typename PrimitiveAt>
+		std::size_t sweep_batch(const std::size_t count, SphereAt sphere_at, PrimitiveAt primitive_at, sweep_hit* hits) {
+			const std::size_t lanes = 8;
+			sphere_lanes<lanes> s;
+			primitive_lanes<Primitive, lanes> p;
+			unsigned int state[lanes];
+			float time[lanes], normal[3][lanes];
+			std::size_t first = count;
+			for (std::size_t k = 0; k < count; k += lanes) {
+				// a short last block repeats its first pair in the spare lanes
+				const std::size_t n = std::min(lanes, count - k);
+				for (std::size_t l = 0; l < lanes; ++l) {
+					const std::size_t index = k + (l < n ? l : 0);
+					s.load(l, sphere_at(index));
+					p.load(l, primitive_at(index));
+				}
+				sweep_lanes(s, p, state, time, normal);
+				for (std::size_t l = 0; l < n; ++l) {
+					sweep_hit& hit = hits[k + l];
+					if (state[l] == sweep_exact)
+						hit = sweep(sphere_at(k + l), primitive_at(k + l));
+					else if (state[l] == sweep_face) {
+						hit.hit = true;
+						hit.time = time[l];
+						for (unsigned int i = 0; i < 3; ++i) {
+							hit.normal.data[i] = normal[i][l];
+							hit.point.data[i] = s.center[i][l] + s.delta[i][l] * time[l] - normal[i][l] * s.radius[l];
+						}
+					}
+					else {
+						hit.hit = false;
+						hit.time = 1.0f;
+					}
+					if (hit.hit && (first == count || hit.time < hits[first].time))
+						first = k + l;
+				}
+			}
+			return first;
+		}
+	}
+
+	// batch versions, hits[k] is the result of pair k, the normal and the
+	// point of a miss are unspecified. They return the index of the first
+	// hit in time, count if none
+
+	// one sphere against many primitives
+	template<typename Primitive>
+	std::size_t sweep(const swept_sphere& s, const Primitive* primitives, const std::size_t count, sweep_hit* hits) {
+		return detail::sweep_batch<Primitive>(count,
+			[&s](const std::size_t) -> const swept_sphere& { return s; },
+			[primitives](const std::size_t k) -> const Primitive& { return primitives[k]; }, hits);
+	}
+
+	// many spheres against one primitive
+	template<typename Primitive>
+	std::size_t sweep(const swept_sphere* spheres, const std::size_t count, const Primitive& primitive, sweep_hit* hits) {
+		return detail::sweep_batch<Primitive>(count,
+			[spheres](const std::size_t k) -> const swept_sphere& { return spheres[k]; },
+			[&primitive](const std::size_t) -> const Primitive& { return primitive; }, hits);
+	}
+
+	// one capsule against many primitives
+	template<typename Primitive>
+	std::size_t sweep(const swept_capsule& s, const Primitive* primitives, const std::size_t count, sweep_hit* hits) {
+		std::size_t first = count;
+		for (std::size_t k = 0; k < count; ++k) {
+			hits[k] = sweep(s, primitives[k]);
+			if (hits[k].hit && (first == count || hits[k].time < hits[first].time))
+				first = k;
+		}
+		return first;
+	}
+
+	// many capsules against one primitive
+	template<typename Primitive>
+	std::size_t sweep(const swept_capsule* capsules, const std::size_t count, const Primitive& primitive, sweep_hit* hits) {
+		std::size_t first = count;
+		for (std::size_t k = 0; k < count; ++k) {
+			hits[k] = sweep(capsules[k], primitive);
+			if (hits[k].hit && (first == count || hits[k].time < hits[first].time))
+				first = k;
+		}
+		return first;
+	}
+};
\ No newline at end of file
@@ -10,6 +10,7 @@
 #include "point.h"
 #include "matrix.h"
 #include "quaternion.h"
+#include "soa.h"
 
 namespace math4games
 {
@@ -38,7 +39,7 @@ namespace math4games
 		static_assert(N > 1, "invalid N");
 		base_point<N - 1, T> p;
 		for (unsigned int i = 0; i < N - 1; ++i)
-			n[i] = v[i];
+			p[i] = v[i];
 		return p;
 	}
 
@@ -158,36 +159,275 @@ namespace math4games
 			m(i, i) *= v[i];
 	}
 
-	// transform matrix
-	template <std::size_t N, typename T>
-	base_matrix<N + 1, N + 1, T> transform(const base_vector<N, T>& position,
-		const base_vector<N, T>& rotation, const base_vector<N, T>& scale) {
-		base_matrix<N + 1, N + 1, T> m = identity<N + 1, T>();
+	// 3D transform, rotation holds the euler angles in degrees about x, y and z
+	template <typename T>
+	base_matrix<4, 4, T> transform(const base_vector<3, T>& position,
+		const base_vector<3, T>& rotation, const base_vector<3, T>& scale) {
 		// translation
-		translate(m, position);
+		base_matrix<4, 4, T> m = translate(position);
 		// rotation
-		// TODO
+		m = m * rotate_z<4, T>(rotation[2]) * rotate_y<4, T>(rotation[1]) * rotate_x<4, T>(rotation[0]);
 		// scaling
-		math4games::scale(m, scale);
-		return m;
+		return m * math4games::scale(scale);
 	}
 
+	// 2D transform, rotation is a direction rotated from the x axis
 	template <typename T>
 	base_matrix<3, 3, T> transform(const base_vector<2, T>& position,
 		const base_vector<2, T>& rotation, const base_vector<2, T>& scale) {
-		base_matrix<3, 3, T> m = identity<3, T>();
 		// translation
-		translate(m, position);
-		// rotation
-		const float theta = degrees(std::acosf(rotation.x / rotation.magnitude()));
-		m = m * rotate_z(theta);
+		base_matrix<3, 3, T> m = translate(position);
+		// rotation, the angle of the rotation direction
+		const float theta = degrees(std::atan2(rotation[1], rotation[0]));
+		m = m * rotate_z<3, T>(theta);
 		// scaling
-		math4games::scale(m, scale);
+		return m * math4games::scale(scale);
+	}
+
+	// translation, rotation and scale components of an affine transform
+	struct trs
+	{
+		vector3 translation;
+		quaternion rotation;
+		vector3 scale;
+
+		trs() : rotation(0.0f, 0.0f, 0.0f, 1.0f), scale(1.0f) {}
+	};
+
+	// compose translation * rotation * scale
+	inline base_matrix<4, 4, float> compose(const base_vector<3, float>& translation,
+		const quaternion& rotation, const base_vector<3, float>& scale) {
+		const matrix3 r = to_matrix3(rotation);
+		base_matrix<4, 4, float> m;
+		for (unsigned int j = 0; j < 3; ++j) {
+			for (unsigned int i = 0; i < 3; ++i)
+				m.data[j * 4 + i] = r.data[j * 3 + i] * scale[i];
+			m.data[j * 4 + 3] = translation[j];
+		}
+		m.data[15] = 1.0f;
 		return m;
 	}
-	
+
+	inline base_matrix<4, 4, float> compose(const trs& components) {
+		return compose(components.translation, components.rotation, components.scale);
+	}
+
+	// split an affine transform in translation, rotation and scale.
+	// A negative determinant is folded into the x scale. Shear can not be
+	// represented: sheared is set when the scaled axes are not orthogonal
+	// within tolerance, the rotation is then taken from the orthonormalized axes
+	inline trs decompose(const base_matrix<4, 4, float>& m, bool& sheared, const float tolerance = 1.0e-4f) {
+		trs result;
+		float axis[3][3];
+		for (unsigned int i = 0; i < 3; ++i) {
+			result.translation[i] = m.data[i * 4 + 3];
+			for (unsigned int j = 0; j < 3; ++j)
+				axis[i][j] = m.data[j * 4 + i];
+		}
+
+		auto dot = [](const float* a, const float* b) {
+			return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+		};
+
+		auto cross = [](const float* a, const float* b, float* c) {
+			c[0] = a[1] * b[2] - a[2] * b[1];
+			c[1] = a[2] * b[0] - a[0] * b[2];
+			c[2] = a[0] * b[1] - a[1] * b[0];
+		};
+
+		// Gram-Schmidt, the projections measure the shear. An axis that is
+		// zero, or nearly a combination of the previous ones, is degenerate
+		float shear[3] = { 0.0f, 0.0f, 0.0f };
+		bool degenerate[3];
+		for (unsigned int i = 0; i < 3; ++i) {
+			const float length = std::sqrt(dot(axis[i], axis[i]));
+			for (unsigned int k = 0; k < i; ++k) {
+				const float d = degenerate[k] ? 0.0f : dot(axis[i], axis[k]);
+				for (unsigned int j = 0; j < 3; ++j)
+					axis[i][j] -= d * axis[k][j];
+				shear[i + k - 1] = d;
+			}
+			result.scale[i] = std::sqrt(dot(axis[i], axis[i]));
+			degenerate[i] = result.scale[i] <= length * tolerance || result.scale[i] == 0.0f;
+			const float f = degenerate[i] ? 0.0f : 1.0f / result.scale[i];
+			for (unsigned int j = 0; j < 3; ++j)
+				axis[i][j] *= f;
+		}
+
+		// complete the rotation with right handed axes orthogonal to the
+		// others, the identity when every axis is degenerate
+		const unsigned int valid = !degenerate[0] + !degenerate[1] + !degenerate[2];
+		for (unsigned int i = 0; i < 3 && valid < 3; ++i) {
+			const unsigned int next = (i + 1) % 3, last = (i + 2) % 3;
+			if (valid == 0) {
+				for (unsigned int j = 0; j < 3; ++j)
+					axis[i][j] = i == j ? 1.0f : 0.0f;
+			}
+			else if (valid == 2 && degenerate[i]) {
+				cross(axis[next], axis[last], axis[i]);
+			}
+			else if (valid == 1 && !degenerate[i]) {
+				// the world axis least aligned with the valid one
+				const float* a = axis[i];
+				const unsigned int w = std::abs(a[0]) <= std::abs(a[1]) && std::abs(a[0]) <= std::abs(a[2]) ? 0
+					: (std::abs(a[1]) <= std::abs(a[2]) ? 1 : 2);
+				const float e[3] = { w == 0 ? 1.0f : 0.0f, w == 1 ? 1.0f : 0.0f, w == 2 ? 1.0f : 0.0f };
+				cross(a, e, axis[next]);
+				const float f = 1.0f / std::sqrt(dot(axis[next], axis[next]));
+				for (unsigned int j = 0; j < 3; ++j)
+					axis[next][j] *= f;
+				cross(a, axis[next], axis[last]);
+			}
+		}
+		sheared = false;
+		for (unsigned int i = 0; i < 3; ++i) {
+			const float s = i == 0 ? result.scale[1] : result.scale[2];
+			sheared = sheared || std::abs(shear[i]) > tolerance * (s != 0.0f ? s : 1.0f);
+		}
+
+		// reflection
+		const float handedness =
+			axis[0][0] * (axis[1][1] * axis[2][2] - axis[1][2] * axis[2][1]) -
+			axis[0][1] * (axis[1][0] * axis[2][2] - axis[1][2] * axis[2][0]) +
+			axis[0][2] * (axis[1][0] * axis[2][1] - axis[1][1] * axis[2][0]);
+		if (handedness < 0.0f) {
+			result.scale[0] = -result.scale[0];
+			for (unsigned int j = 0; j < 3; ++j)
+				axis[0][j] = -axis[0][j];
+		}
+
+		matrix3 r;
+		for (unsigned int i = 0; i < 3; ++i) {
+			for (unsigned int j = 0; j < 3; ++j)
+				r.data[j * 3 + i] = axis[i][j];
+		}
+		result.rotation = to_quaternion(r);
+		return result;
+	}
+
+	inline trs decompose(const base_matrix<4, 4, float>& m) {
+		bool sheared;
+		return decompose(m, sheared);
+	}
+
+	// batch versions
+	inline void decompose(const base_matrix<4, 4, float>* matrices, trs* results, const std::size_t count) {
+		for (std::size_t i = 0; i < count; ++i)
+			results[i] = decompose(matrices[i]);
+	}
+
+	inline void compose(const trs* components, base_matrix<4, 4, float>* matrices, const std::size_t count) {
+		for (std::size_t i = 0; i < count; ++i)
+			matrices[i] = compose(components[i]);
+	}
+
+	// true when the upper 3x3 is a rotation times a uniform scale, possibly
+	// mirrored: its columns are orthogonal and of the same length
+	inline bool is_similarity(const base_matrix<4, 4, float>& m, const float tolerance = 1.0e-5f) {
+		const float* a = m.data.data();
+		float g[6];
+		// gram matrix of the columns: c0.c0, c1.c1, c2.c2, c0.c1, c0.c2, c1.c2
+		const unsigned int pairs[6][2] = { { 0, 0 }, { 1, 1 }, { 2, 2 }, { 0, 1 }, { 0, 2 }, { 1, 2 } };
+		for (unsigned int k = 0; k < 6; ++k) {
+			const unsigned int i = pairs[k][0], j = pairs[k][1];
+			g[k] = a[i] * a[j] + a[4 + i] * a[4 + j] + a[8 + i] * a[8 + j];
+		}
+		const float limit = tolerance * g[0];
+		return std::fabs(g[1] - g[0]) <= limit && std::fabs(g[2] - g[0]) <= limit
+			&& std::fabs(g[3]) <= limit && std::fabs(g[4]) <= limit && std::fabs(g[5]) <= limit;
+	}
+
+	// cofactor matrix of the upper 3x3, that is determinant * inverse transpose
+	inline base_matrix<3, 3, float> cofactor(const base_matrix<4, 4, float>& m) {
+		const float* a = m.data.data();
+		base_matrix<3, 3, float> c;
+		// each cofactor row is the cross product of the other two rows
+		for (unsigned int i = 0; i < 3; ++i) {
+			const float* r1 = a + ((i + 1) % 3) * 4;
+			const float* r2 = a + ((i + 2) % 3) * 4;
+			c.data[i * 3 + 0] = r1[1] * r2[2] - r1[2] * r2[1];
+			c.data[i * 3 + 1] = r1[2] * r2[0] - r1[0] * r2[2];
+			c.data[i * 3 + 2] = r1[0] * r2[1] - r1[1] * r2[0];
+		}
+		return c;
+	}
+
+	/*
+		matrix for the normals of a transform, the inverse transpose of its
+		upper 3x3 up to a positive scale, so the transformed normals have to
+		be renormalized. Rotations with uniform scale are their own normal
+		matrix, the others use the cofactors without dividing by the
+		determinant, only its sign is kept so mirrored normals do not flip
+	*/
+	inline base_matrix<3, 3, float> normal_matrix(const base_matrix<4, 4, float>& m) {
+		const float* a = m.data.data();
+		if (is_similarity(m))
+			return base_matrix<3, 3, float>({ a[0], a[1], a[2], a[4], a[5], a[6], a[8], a[9], a[10] });
+		base_matrix<3, 3, float> c = cofactor(m);
+		const float det = a[0] * c.data[0] + a[1] * c.data[1] + a[2] * c.data[2];
+		if (det < 0.0f)
+			for (unsigned int i = 0; i < 9; ++i)
+				c.data[i] = -c.data[i];
+		return c;
+	}
+
+	// exact inverse transpose of the upper 3x3, for unit normals that stay
+	// unit only when the transform is orthonormal
+	inline base_matrix<3, 3, float> inverse_transpose(const base_matrix<4, 4, float>& m, bool& invertible) {
+		base_matrix<3, 3, float> c = cofactor(m);
+		const float det = m.data[0] * c.data[0] + m.data[1] * c.data[1] + m.data[2] * c.data[2];
+		invertible = det != 0.0f;
+		if (!invertible)
+			return c;
+		const float f = 1.0f / det;
+		for (unsigned int i = 0; i < 9; ++i)
+			c.data[i] *= f;
+		return c;
+	}
+
+	// batch normal transform, normals[k] = normalize(n * normals[k]). A
+	// normal that becomes null stays null
+	template<typename V>
+	void transform_normals(const base_matrix<3, 3, float>& n, const V* normals, V* results, const std::size_t count) {
+		const float* a = n.data.data();
+		for (std::size_t k = 0; k < count; ++k) {
+			const float x = normals[k].data[0], y = normals[k].data[1], z = normals[k].data[2];
+			const float tx = a[0] * x + a[1] * y + a[2] * z;
+			const float ty = a[3] * x + a[4] * y + a[5] * z;
+			const float tz = a[6] * x + a[7] * y + a[8] * z;
+			const float length2 = tx * tx + ty * ty + tz * tz;
+			const float s = length2 > 0.0f ? 1.0f / std::sqrt(length2) : 0.0f;
+			results[k].data[0] = tx * s;
+			results[k].data[1] = ty * s;
+			results[k].data[2] = tz * s;
+		}
+	}
+
+	// soa version, one contiguous loop over the components
+	inline void transform_normals(const base_matrix<3, 3, float>& n, const soa_vector<3, float>& normals,
+		soa_vector<3, float>& results) {
+		assert(results.count >= normals.count);
+		const float* a = n.data.data();
+		const float* x = normals.data[0];
+		const float* y = normals.data[1];
+		const float* z = normals.data[2];
+		float* rx = results.data[0];
+		float* ry = results.data[1];
+		float* rz = results.data[2];
+		for (std::size_t k = 0; k < normals.count; ++k) {
+			const float tx = a[0] * x[k] + a[1] * y[k] + a[2] * z[k];
+			const float ty = a[3] * x[k] + a[4] * y[k] + a[5] * z[k];
+			const float tz = a[6] * x[k] + a[7] * y[k] + a[8] * z[k];
+			const float length2 = tx * tx + ty * ty + tz * tz;
+			const float s = length2 > 0.0f ? 1.0f / std::sqrt(length2) : 0.0f;
+			rx[k] = tx * s;
+			ry[k] = ty * s;
+			rz[k] = tz * s;
+		}
+	}
+
 	// orthograpic pojection
-	base_matrix<4, 4, float> orthographic(const float left, const float right, 
+	inline base_matrix<4, 4, float> orthographic(const float left, const float right, 
 		const float bottom, const float top, 
 		const float near_plane, const float far_plane) 
 	{
@@ -205,7 +445,7 @@ namespace math4games
 	}
 	
 	// perspective projection
-    base_matrix<4, 4, float> perspective(const float fov, const float aspect, const float near_plane, const float far_plane)
+    inline base_matrix<4, 4, float> perspective(const float fov, const float aspect, const float near_plane, const float far_plane)
     {
         base_matrix<4, 4, float> m(0.0f);
 
@@ -224,4 +464,70 @@ namespace math4games
 
         return m;
     }
+
+	// view matrix of a camera at eye looking at target, right handed with
+	// the camera looking down -z
+	inline base_matrix<4, 4, float> look_at(const base_vector<3, float>& eye, const base_vector<3, float>& target,
+		const base_vector<3, float>& up) {
+		float f[3] = { target.data[0] - eye.data[0], target.data[1] - eye.data[1], target.data[2] - eye.data[2] };
+		const float lf = 1.0f / std::sqrt(f[0] * f[0] + f[1] * f[1] + f[2] * f[2]);
+		f[0] *= lf; f[1] *= lf; f[2] *= lf;
+		// side = f x up, real up = side x f
+		float s[3] = {
+			f[1] * up.data[2] - f[2] * up.data[1],
+			f[2] * up.data[0] - f[0] * up.data[2],
+			f[0] * up.data[1] - f[1] * up.data[0]
+		};
+		const float ls = 1.0f / std::sqrt(s[0] * s[0] + s[1] * s[1] + s[2] * s[2]);
+		s[0] *= ls; s[1] *= ls; s[2] *= ls;
+		const float u[3] = {
+			s[1] * f[2] - s[2] * f[1],
+			s[2] * f[0] - s[0] * f[2],
+			s[0] * f[1] - s[1] * f[0]
+		};
+		const float* e = eye.data.data();
+		return base_matrix<4, 4, float>({
+			s[0], s[1], s[2], -(s[0] * e[0] + s[1] * e[1] + s[2] * e[2]),
+			u[0], u[1], u[2], -(u[0] * e[0] + u[1] * e[1] + u[2] * e[2]),
+			-f[0], -f[1], -f[2], f[0] * e[0] + f[1] * e[1] + f[2] * e[2],
+			0.0f, 0.0f, 0.0f, 1.0f
+		});
+	}
+
+	// perspective projection with the far plane at infinity, depth in [-1, 1]
+	inline base_matrix<4, 4, float> perspective_infinite(const float fov, const float aspect, const float near_plane) {
+		const float f = 1.0f / std::tan(fov * 0.5f);
+		base_matrix<4, 4, float> m(0.0f);
+		m(0, 0) = f / aspect;
+		m(1, 1) = f;
+		m(2, 2) = -1.0f;
+		m(2, 3) = -1.0f;
+		m(3, 2) = -2.0f * near_plane;
+		return m;
+	}
+
+	// reverse z perspective projection, depth in [0, 1] with the near plane
+	// at 1 and the far plane at 0: the float depth buffer precision then
+	// follows the 1/z distribution of the projected depth
+	inline base_matrix<4, 4, float> perspective_reverse_z(const float fov, const float aspect, const float near_plane, const float far_plane) {
+		const float f = 1.0f / std::tan(fov * 0.5f);
+		base_matrix<4, 4, float> m(0.0f);
+		m(0, 0) = f / aspect;
+		m(1, 1) = f;
+		m(2, 2) = near_plane / (far_plane - near_plane);
+		m(2, 3) = -1.0f;
+		m(3, 2) = near_plane * far_plane / (far_plane - near_plane);
+		return m;
+	}
+
+	// reverse z perspective projection with the far plane at infinity
+	inline base_matrix<4, 4, float> perspective_infinite_reverse_z(const float fov, const float aspect, const float near_plane) {
+		const float f = 1.0f / std::tan(fov * 0.5f);
+		base_matrix<4, 4, float> m(0.0f);
+		m(0, 0) = f / aspect;
+		m(1, 1) = f;
+		m(2, 3) = -1.0f;
+		m(3, 2) = near_plane;
+		return m;
+	}
 }
@@ -10,9 +10,34 @@
 #include <cassert>
 #include <initializer_list>
 #include <array>
+#include "element.h"
+#include "profile.h"
 
 namespace math4games
 {
+	// alignment of the storage of N components of type T.
+	// Define MATH4GAMES_ALIGN_SIMD to align 4 and 16 float storages
+	// (vec4, mat4) to 16 bytes, so that they can be loaded into simd registers
+	template<std::size_t N, typename T>
+	struct storage_alignment
+	{
+		static const std::size_t value = alignof(std::array<T, N>);
+	};
+
+#ifdef MATH4GAMES_ALIGN_SIMD
+	template<>
+	struct storage_alignment<4, float>
+	{
+		static const std::size_t value = 16;
+	};
+
+	template<>
+	struct storage_alignment<16, float>
+	{
+		static const std::size_t value = 16;
+	};
+#endif
+
 	template<std::size_t N, typename T>
 	struct base_vector
 	{
@@ -20,7 +45,7 @@ namespace math4games
 		const std::size_t length = N;
 
 		// store data into a managed array
-		std::array<T, N> data;
+		alignas(storage_alignment<N, T>::value) std::array<T, N> data;
 
 		// default constructor
 		base_vector() {
@@ -77,12 +102,14 @@ namespace math4games
 
 		T& operator() (const unsigned int i)
 		{
-			return data.at(i);
+			MATH4GAMES_COUNT("element access", profile::type_name<T>(N), 0);
+			return detail::element(data, i);
 		}
 
 		T operator() (const unsigned int i) const
 		{
-			return data.at(i);
+			MATH4GAMES_COUNT("element access", profile::type_name<T>(N), 0);
+			return detail::element(data, i);
 		}
 
 		// compute the magnitude
@@ -106,6 +133,7 @@ namespace math4games
 
 		// normalize the vector
 		base_vector<N, T> normalize() {
+			MATH4GAMES_COUNT("normalize", profile::type_name<T>(N), 3 * N + 1);
 			return (*this *= (static_cast<T>(1.0) / magnitude()));
 		}
 
@@ -234,6 +262,10 @@ namespace math4games
 
 		base_vector2() :base_vector<2, T>() {}
 
+		// copy constructors, the component references must bind to this data
+		base_vector2(const base_vector2& other) :base_vector<2, T>(other) {}
+		base_vector2(const base_vector<2, T>& other) :base_vector<2, T>(other) {}
+
 		T& x = base_vector<2, T>::data[0];
 		T& y = base_vector<2, T>::data[1];
 
@@ -266,6 +298,10 @@ namespace math4games
 
 		base_vector3() :base_vector<3, T>() {}
 
+		// copy constructors, the component references must bind to this data
+		base_vector3(const base_vector3& other) :base_vector<3, T>(other) {}
+		base_vector3(const base_vector<3, T>& other) :base_vector<3, T>(other) {}
+
 		T& x = base_vector<3, T>::data[0];
 		T& y = base_vector<3, T>::data[1];
 		T& z = base_vector<3, T>::data[2];
@@ -315,6 +351,10 @@ namespace math4games
 
 		base_vector4() :base_vector<4, T>() {}
 
+		// copy constructors, the component references must bind to this data
+		base_vector4(const base_vector4& other) :base_vector<4, T>(other) {}
+		base_vector4(const base_vector<4, T>& other) :base_vector<4, T>(other) {}
+
 		T& x = base_vector<4, T>::data[0];
 		T& y = base_vector<4, T>::data[1];
 		T& z = base_vector<4, T>::data[2];
@@ -0,0 +1,232 @@
+#pragma once
+
+/*
+	Large world coordinates
+	Vito Domenico Tagliente
+	math library for games
+*/
+
+#include <cmath>
+#include <type_traits>
+#include "vector.h"
+#include "matrix.h"
+#include "quaternion.h"
+#include "transformation.h"
+#include "soa.h"
+
+// edge of a world cell, in world units
+#ifndef MATH4GAMES_WORLD_CELL_SIZE
+#define MATH4GAMES_WORLD_CELL_SIZE 1024.0
+#endif
+
+namespace math4games
+{
+	/*
+		World positions and transforms are kept in double precision
+		(dvec3, dmat4) or as an integer cell plus a float offset inside it.
+		Rendering and physics work in float relative to an origin near the
+		viewer: rebase() subtracts the origin in full precision and only
+		then narrows to float, so the result keeps float precision however
+		far from the world origin the data is.
+	*/
+
+	const double world_cell_size = MATH4GAMES_WORLD_CELL_SIZE;
+
+	// precision conversions
+
+	template<std::size_t N>
+	base_vector<N, float> narrow(const base_vector<N, double>& v) {
+		base_vector<N, float> result;
+		for (unsigned int i = 0; i < N; ++i)
+			result.data[i] = static_cast<float>(v.data[i]);
+		return result;
+	}
+
+	template<std::size_t N>
+	base_vector<N, double> widen(const base_vector<N, float>& v) {
+		base_vector<N, double> result;
+		for (unsigned int i = 0; i < N; ++i)
+			result.data[i] = v.data[i];
+		return result;
+	}
+
+	template<std::size_t N, std::size_t M>
+	base_matrix<N, M, float> narrow(const base_matrix<N, M, double>& m) {
+		base_matrix<N, M, float> result;
+		for (unsigned int i = 0; i < N * M; ++i)
+			result.data[i] = static_cast<float>(m.data[i]);
+		return result;
+	}
+
+	template<std::size_t N, std::size_t M>
+	base_matrix<N, M, double> widen(const base_matrix<N, M, float>& m) {
+		base_matrix<N, M, double> result;
+		for (unsigned int i = 0; i < N * M; ++i)
+			result.data[i] = m.data[i];
+		return result;
+	}
+
+	// double precision world transform, translation * rotation * scale
+	inline base_matrix<4, 4, double> compose(const base_vector<3, double>& translation,
+		const quaternion& rotation, const base_vector<3, float>& scale) {
+		base_matrix<4, 4, double> m = widen(compose(base_vector<3, float>(), rotation, scale));
+		for (unsigned int j = 0; j < 3; ++j)
+			m.data[j * 4 + 3] = translation.data[j];
+		return m;
+	}
+
+	// rebase relative to origin and narrow to float
+
+	inline base_vector<3, float> rebase(const base_vector<3, double>& p, const base_vector<3, double>& origin) {
+		base_vector<3, float> result;
+		for (unsigned int i = 0; i < 3; ++i)
+			result.data[i] = static_cast<float>(p.data[i] - origin.data[i]);
+		return result;
+	}
+
+	// the translation, column 3, is rebased, the linear part is narrowed
+	inline base_matrix<4, 4, float> rebase(const base_matrix<4, 4, double>& m, const base_vector<3, double>& origin) {
+		base_matrix<4, 4, float> result = narrow(m);
+		for (unsigned int j = 0; j < 3; ++j)
+			result.data[j * 4 + 3] = static_cast<float>(m.data[j * 4 + 3] - origin.data[j]);
+		return result;
+	}
+
+	namespace detail
+	{
+		template<typename P, typename V>
+		void rebase_array(const P* positions, V* results, const std::size_t count,
+			const base_vector<3, double>& origin, std::integral_constant<std::size_t, 3>) {
+			const double ox = origin.data[0], oy = origin.data[1], oz = origin.data[2];
+			for (std::size_t k = 0; k < count; ++k) {
+				results[k].data[0] = static_cast<float>(positions[k].data[0] - ox);
+				results[k].data[1] = static_cast<float>(positions[k].data[1] - oy);
+				results[k].data[2] = static_cast<float>(positions[k].data[2] - oz);
+			}
+		}
+
+		template<typename M, typename R>
+		void rebase_array(const M* matrices, R* results, const std::size_t count,
+			const base_vector<3, double>& origin, std::integral_constant<std::size_t, 16>) {
+			for (std::size_t k = 0; k < count; ++k)
+				results[k].data = rebase(matrices[k], origin).data;
+		}
+	}
+
+	// batch versions, of arrays of any 3 component vector or point type
+	// or of 4x4 matrices, see components
+	template<typename P, typename R>
+	void rebase(const P* values, R* results, const std::size_t count, const base_vector<3, double>& origin) {
+		static_assert(components<P>::value == components<R>::value, "rebase keeps the number of components");
+		detail::rebase_array(values, results, count, origin, std::integral_constant<std::size_t, components<P>::value>());
+	}
+
+	// soa version, one contiguous loop per component
+	inline void rebase(const soa_vector<3, double>& positions, soa_vector<3, float>& results,
+		const base_vector<3, double>& origin) {
+		assert(results.count >= positions.count);
+		for (unsigned int i = 0; i < 3; ++i) {
+			const double* in = positions.data[i];
+			float* out = results.data[i];
+			const double o = origin.data[i];
+			for (std::size_t k = 0; k < positions.count; ++k)
+				out[k] = static_cast<float>(in[k] - o);
+		}
+	}
+
+	// position as an integer cell and a float offset in [0, world_cell_size).
+	// The offset precision is the same everywhere in the world, which is
+	// addressable up to 2^31 cells per axis
+	struct world_position
+	{
+		base_vector<3, int> cell;
+		base_vector<3, float> offset;
+
+		world_position() = default;
+
+		world_position(const base_vector<3, double>& p) {
+			for (unsigned int i = 0; i < 3; ++i) {
+				const double c = std::floor(p.data[i] / world_cell_size);
+				cell.data[i] = static_cast<int>(c);
+				offset.data[i] = static_cast<float>(p.data[i] - c * world_cell_size);
+			}
+			normalize();
+		}
+
+		// double precision position
+		base_vector<3, double> position() const {
+			base_vector<3, double> result;
+			for (unsigned int i = 0; i < 3; ++i)
+				result.data[i] = cell.data[i] * world_cell_size + offset.data[i];
+			return result;
+		}
+
+		// move whole cells from the offset to the cell
+		void normalize() {
+			const float size = static_cast<float>(world_cell_size);
+			for (unsigned int i = 0; i < 3; ++i) {
+				const float c = std::floor(offset.data[i] / size);
+				if (c != 0.0f) {
+					cell.data[i] += static_cast<int>(c);
+					offset.data[i] -= c * size;
+				}
+				// rounding can land exactly on the upper bound
+				if (offset.data[i] >= size) {
+					cell.data[i] += 1;
+					offset.data[i] -= size;
+				}
+			}
+		}
+
+		// translate by a float displacement
+		world_position& operator+= (const base_vector<3, float>& d) {
+			offset += d;
+			normalize();
+			return *this;
+		}
+
+		world_position& operator-= (const base_vector<3, float>& d) {
+			offset -= d;
+			normalize();
+			return *this;
+		}
+
+		// float displacement from other to this
+		base_vector<3, float> operator- (const world_position& other) const {
+			base_vector<3, float> result;
+			for (unsigned int i = 0; i < 3; ++i) {
+				const double cells = static_cast<double>(cell.data[i]) - other.cell.data[i];
+				result.data[i] = static_cast<float>(cells * world_cell_size) + (offset.data[i] - other.offset.data[i]);
+			}
+			return result;
+		}
+
+		bool operator== (const world_position& other) const {
+			return cell == other.cell && offset == other.offset;
+		}
+
+		bool operator!= (const world_position& other) const {
+			return !(*this == other);
+		}
+	};
+
+	inline world_position operator+ (world_position p, const base_vector<3, float>& d) {
+		return p += d;
+	}
+
+	inline world_position operator- (world_position p, const base_vector<3, float>& d) {
+		return p -= d;
+	}
+
+	// position relative to origin, in float
+	inline base_vector<3, float> rebase(const world_position& p, const world_position& origin) {
+		return p - origin;
+	}
+
+	template<typename V>
+	void rebase(const world_position* positions, V* results, const std::size_t count, const world_position& origin) {
+		static_assert(components<V>::value == 3, "rebased positions have 3 components");
+		for (std::size_t k = 0; k < count; ++k)
+			results[k].data = (positions[k] - origin).data;
+	}
+};
\ No newline at end of file
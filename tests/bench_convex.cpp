@@ -0,0 +1,110 @@
+// pair tests per second on 10k pairs of oriented boxes, near each other
+// so that about a third intersect: gjk distance cold and warm started from
+// the last frame, intersection only, epa on the intersecting pairs, and
+// gjk distance between point arrays of 32 points
+
+#include <math4games/math4games.h>
+#include <check.h>
+
+#include <random>
+#include <vector>
+
+using namespace math4games;
+
+int main()
+{
+	const std::size_t count = 10000;
+	const int repetitions = 10;
+	std::mt19937 generator(42);
+	std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> size(0.2f, 1.0f);
+
+	auto random_box = [&](const vec3& center) {
+		convex_box box;
+		box.center = center;
+		quaternion q(uniform(generator), uniform(generator), uniform(generator), uniform(generator));
+		box.rotation.data = to_matrix3(q.normalize()).data;
+		box.extents = vec3(size(generator), size(generator), size(generator));
+		return box;
+	};
+
+	std::vector<convex_box> a(count), b(count);
+	for (std::size_t k = 0; k < count; ++k)
+	{
+		a[k] = random_box(vec3::zero);
+		b[k] = random_box(vec3(2.0f * uniform(generator), 2.0f * uniform(generator), 2.0f * uniform(generator)));
+	}
+
+	std::vector<gjk_result> results(count);
+	std::size_t iterations = 0, intersecting = 0;
+	const double cold = check::time(repetitions, [&]() {
+		for (std::size_t k = 0; k < count; ++k)
+			results[k] = gjk_distance(a[k], b[k]);
+	});
+	for (const gjk_result& r : results)
+	{
+		iterations += r.iterations;
+		intersecting += r.intersect;
+	}
+
+	// one frame of motion between the queries, the caches hold the last one
+	std::vector<gjk_cache> caches(count);
+	for (std::size_t k = 0; k < count; ++k)
+		gjk_distance(a[k], b[k], &caches[k]);
+	const vec3 step(0.001f, 0.0f, 0.0f);
+	std::size_t warm_iterations = 0;
+	const double warm = check::time(repetitions, [&]() {
+		for (std::size_t k = 0; k < count; ++k)
+		{
+			b[k].center += step;
+			results[k] = gjk_distance(a[k], b[k], &caches[k]);
+			warm_iterations += results[k].iterations;
+		}
+	});
+
+	std::size_t intersections = 0;
+	const double intersect = check::time(repetitions, [&]() {
+		for (std::size_t k = 0; k < count; ++k)
+			intersections += gjk_intersect(a[k], b[k]);
+	});
+
+	float depth = 0.0f;
+	const double penetration = check::time(repetitions, [&]() {
+		for (std::size_t k = 0; k < count; ++k)
+		{
+			const gjk_result g = gjk_distance(a[k], b[k]);
+			if (g.intersect)
+				depth += epa_penetration(a[k], b[k], g).depth;
+		}
+	});
+
+	// clouds of 32 points within unit spheres
+	const std::size_t cloud = 32;
+	std::vector<point3> points(2 * count * cloud);
+	for (std::size_t k = 0; k < points.size(); ++k)
+	{
+		const vec3 p = vec3(uniform(generator), uniform(generator), uniform(generator)).normalize();
+		const float offset = k / cloud % 2 == 0 ? 0.0f : 2.5f;
+		points[k] = point3(p.x + offset, p.y, p.z);
+	}
+	float distance = 0.0f;
+	const double hulls = check::time(repetitions, [&]() {
+		for (std::size_t k = 0; k < count; ++k)
+		{
+			const convex_points<point3> first(&points[2 * k * cloud], cloud), second(&points[(2 * k + 1) * cloud], cloud);
+			distance += gjk_distance(first, second).distance;
+		}
+	});
+
+	// times are in microseconds
+	const double n = static_cast<double>(count);
+	std::printf("%zu box pairs, %zu intersecting\n", count, intersecting);
+	std::printf("gjk distance cold     %8.0f pairs/ms, %.2f iterations\n", n / cold * 1.0e3, static_cast<double>(iterations) / n);
+	std::printf("gjk distance warm     %8.0f pairs/ms, %.2f iterations\n", n / warm * 1.0e3,
+		static_cast<double>(warm_iterations) / (n * (repetitions + 1)));
+	std::printf("gjk intersect         %8.0f pairs/ms\n", n / intersect * 1.0e3);
+	std::printf("gjk distance and epa  %8.0f pairs/ms\n", n / penetration * 1.0e3);
+	std::printf("gjk distance 32 point %8.0f pairs/ms\n", n / hulls * 1.0e3);
+	std::printf("checksum %zu %g %g\n", intersections, depth, distance);
+	return 0;
+}
@@ -0,0 +1,84 @@
+// delaunay triangulation of 1M uniform points with one workspace reused
+// across calls, and of 100k points with 1000 crossing constraints, with
+// the counts of inverted triangles, broken twins and non delaunay edges
+
+#include <math4games/math4games.h>
+#include <check.h>
+
+#include <random>
+#include <vector>
+
+using namespace math4games;
+
+struct validity
+{
+	std::size_t inverted = 0;
+	std::size_t twins = 0;
+	std::size_t non_delaunay = 0;
+	std::size_t constrained = 0;
+};
+
+// every triangle counter clockwise, every half edge the twin of its twin
+// and every unconstrained edge locally delaunay
+static validity validate(const std::vector<point2>& points, const delaunay2& d) {
+	validity v;
+	for (std::uint32_t e = 0; e < d.triangles.size(); ++e)
+	{
+		const point2& a = points[d.triangles[e]];
+		const point2& b = points[d.triangles[delaunay2::next(e)]];
+		const point2& c = points[d.triangles[delaunay2::prev(e)]];
+		if (e % 3 == 0 && orient2d(a, b, c) <= 0)
+			++v.inverted;
+		const std::uint32_t f = d.halfedges[e];
+		if (f == delaunay_none)
+			continue;
+		if (d.halfedges[f] != e || d.triangles[f] != d.triangles[delaunay2::next(e)] || d.constrained[e] != d.constrained[f])
+			++v.twins;
+		if (d.constrained[e])
+			++v.constrained;
+		else if (incircle(a, b, c, points[d.triangles[delaunay2::prev(f)]]) > 0)
+			++v.non_delaunay;
+	}
+	v.constrained /= 2;
+	return v;
+}
+
+static void report(const char* const name, const std::vector<point2>& points, const delaunay2& d, const bool ok, const double t) {
+	const validity v = validate(points, d);
+	std::printf("%-11s %8zu points %s %8zu triangles %8.1f ms, inverted %zu, twins %zu, non delaunay %zu, constrained %zu\n",
+		name, points.size(), ok ? "ok" : "failed", d.size(), t * 1.0e-3, v.inverted, v.twins, v.non_delaunay, v.constrained);
+}
+
+int main()
+{
+	const int repetitions = 5;
+	std::mt19937 generator(42);
+	std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+	delaunay_workspace workspace;
+	delaunay2 d;
+
+	// times are in microseconds
+	std::vector<point2> points(1000000);
+	for (point2& p : points)
+		p.data = { uniform(generator), uniform(generator) };
+	bool ok = true;
+	const double unconstrained = check::time(repetitions, [&]() { ok = delaunay(points.data(), points.size(), d, workspace); });
+	report("uniform", points, d, ok, unconstrained);
+
+	// vertical bars from bottom to top, each crossing many triangles
+	points.resize(100000);
+	std::vector<std::uint32_t> edges;
+	for (std::uint32_t i = 0; i < 1000; ++i)
+	{
+		const float x = -0.99f + 0.00198f * i;
+		points.push_back(point2(x, -0.9f));
+		points.push_back(point2(x, 0.9f));
+		edges.push_back(static_cast<std::uint32_t>(points.size() - 2));
+		edges.push_back(static_cast<std::uint32_t>(points.size() - 1));
+	}
+	const double constrained = check::time(repetitions, [&]() {
+		ok = delaunay(points.data(), points.size(), edges.data(), edges.size() / 2, d, workspace);
+	});
+	report("constrained", points, d, ok, constrained);
+	return 0;
+}
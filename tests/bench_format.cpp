@@ -0,0 +1,91 @@
+// nanoseconds per vec3 written and read as text, 1M vectors: to_chars and
+// from_chars into memory against ostringstream and istringstream with
+// round trip precision, the debug.h operator<< against the same stream,
+// and text_writer and text_reader through a temporary file
+
+#include <math4games/math4games.h>
+#include <check.h>
+
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace math4games;
+
+typedef base_vector<3, float> position;
+
+int main()
+{
+	const std::size_t count = 1 << 20;
+	const int repetitions = 3;
+	std::mt19937 generator(42);
+	std::uniform_real_distribution<float> uniform(-1000.0f, 1000.0f);
+	std::vector<position> values(count), values_back(count);
+	for (position& value : values)
+		value = position({ uniform(generator), uniform(generator), uniform(generator) });
+
+	// to_chars and from_chars, one value per line
+	std::vector<char> text(count * 48);
+	std::size_t size = 0;
+	const double format = check::time(repetitions, [&]() {
+		char* first = text.data();
+		char* const last = text.data() + text.size();
+		for (const position& value : values)
+		{
+			first = to_chars(first, last, value).ptr;
+			*first++ = '\n';
+		}
+		size = static_cast<std::size_t>(first - text.data());
+	});
+	const double parse = check::time(repetitions, [&]() {
+		const char* first = text.data();
+		const char* const last = text.data() + size;
+		for (position& value : values_back)
+			first = from_chars(first, last, value).ptr + 1;
+	});
+
+	// the same text through string streams
+	std::string stream_text;
+	const double stream_format = check::time(repetitions, [&]() {
+		std::ostringstream stream;
+		stream.precision(std::numeric_limits<float>::max_digits10);
+		for (const position& value : values)
+			stream << value.data[0] << ' ' << value.data[1] << ' ' << value.data[2] << '\n';
+		stream_text = stream.str();
+	});
+	const double stream_parse = check::time(repetitions, [&]() {
+		std::istringstream stream(stream_text);
+		for (position& value : values_back)
+			stream >> value.data[0] >> value.data[1] >> value.data[2];
+	});
+	const double debug_format = check::time(repetitions, [&]() {
+		std::ostringstream stream;
+		for (const position& value : values)
+			stream << value;
+	});
+
+	// streaming through a file
+	std::FILE* file = std::tmpfile();
+	const double write = check::time(repetitions, [&]() {
+		std::rewind(file);
+		text_writer writer(file);
+		writer.write(values.data(), values.size());
+	});
+	std::size_t read_count = 0;
+	const double read = check::time(repetitions, [&]() {
+		std::rewind(file);
+		text_reader reader(file);
+		read_count = reader.read(values_back.data(), count);
+	});
+	std::fclose(file);
+
+	// times are in microseconds
+	const double n = static_cast<double>(count) * 1.0e-3;
+	std::printf("to_chars    %6.1f ns, ostringstream %6.1f ns, debug operator<< %6.1f ns\n", format / n, stream_format / n, debug_format / n);
+	std::printf("from_chars  %6.1f ns, istringstream %6.1f ns\n", parse / n, stream_parse / n);
+	std::printf("text_writer %6.1f ns, text_reader   %6.1f ns, %zu values read\n", write / n, read / n, read_count);
+	return 0;
+}
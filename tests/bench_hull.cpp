@@ -0,0 +1,102 @@
+// 2D and 3D convex hulls of 100k and 1M points with one workspace reused
+// across calls: uniform, on the circle or sphere, snapped to a grid and
+// gaussian, with the largest distance of a point in front of a hull plane
+
+#include <math4games/math4games.h>
+#include <check.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace math4games;
+
+enum class distribution { uniform, surface, grid, gaussian };
+
+static const char* const distribution_names[] = { "uniform", "surface", "grid", "gaussian" };
+
+static float sample(std::mt19937& generator, const distribution shape) {
+	std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+	std::normal_distribution<float> normal;
+	if (shape == distribution::surface || shape == distribution::gaussian)
+		return normal(generator);
+	const float x = uniform(generator);
+	return shape == distribution::grid ? std::round(x * 10.0f) / 10.0f : x;
+}
+
+int main()
+{
+	const int repetitions = 5;
+	const std::size_t sizes[] = { 100000, 1000000 };
+	const distribution shapes[] = { distribution::uniform, distribution::surface, distribution::grid, distribution::gaussian };
+	std::mt19937 generator(42);
+	hull_workspace workspace;
+
+	// times are in milliseconds
+	for (const distribution shape : shapes)
+	{
+		for (const std::size_t count : sizes)
+		{
+			std::vector<point2> points(count);
+			for (point2& p : points)
+			{
+				float x = sample(generator, shape), y = sample(generator, shape);
+				if (shape == distribution::surface)
+				{
+					const float length = std::sqrt(x * x + y * y);
+					x /= length;
+					y /= length;
+				}
+				p.data = { x, y };
+			}
+
+			hull2 hull;
+			bool ok = true;
+			const double t = check::time(repetitions, [&]() { ok = convex_hull(points.data(), count, hull, workspace); });
+			// a sample of the points against every line, the circle has
+			// too many edges to test them all
+			const std::size_t stride = std::max<std::size_t>(1, count / 10000);
+			float outside = 0.0f;
+			for (const line2& l : hull.lines)
+				for (std::size_t k = 0; k < count; k += stride)
+					outside = std::max(outside, l.signed_distance(vec2(points[k].x, points[k].y)));
+			std::printf("2d %-8s %8zu points %s %6zu vertices %8.2f ms, outside %g\n",
+				distribution_names[static_cast<int>(shape)], count, ok ? "ok" : "failed", hull.indices.size(), t * 1.0e-3, outside);
+		}
+	}
+
+	for (const distribution shape : shapes)
+	{
+		for (const std::size_t count : sizes)
+		{
+			std::vector<point3> points(count);
+			for (point3& p : points)
+			{
+				float x = sample(generator, shape), y = sample(generator, shape), z = sample(generator, shape);
+				if (shape == distribution::surface)
+				{
+					const float length = std::sqrt(x * x + y * y + z * z);
+					x /= length;
+					y /= length;
+					z /= length;
+				}
+				p.data = { x, y, z };
+			}
+
+			hull3 hull;
+			bool ok = true;
+			const double t = check::time(repetitions, [&]() { ok = convex_hull(points.data(), count, hull, workspace); });
+			// a sample of the points against every plane, the sphere has
+			// too many faces to test them all
+			const std::size_t stride = std::max<std::size_t>(1, count / 1000);
+			float outside = 0.0f;
+			for (const plane& h : hull.planes)
+				for (std::size_t k = 0; k < count; k += stride)
+					outside = std::max(outside, h.signed_distance(vec3(points[k].x, points[k].y, points[k].z)));
+			std::printf("3d %-8s %8zu points %s %6zu vertices %7zu faces %8.2f ms, outside %g\n",
+				distribution_names[static_cast<int>(shape)], count, ok ? "ok" : "failed", hull.vertices.size(), hull.faces(), t * 1.0e-3, outside);
+		}
+	}
+	return 0;
+}
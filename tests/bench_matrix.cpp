@@ -0,0 +1,55 @@
+// nanoseconds per mat4 * mat4 and per transpose over 4096 matrices.
+// Built without and with MATH4GAMES_BOUNDS_CHECK, as bench_matrix and
+// bench_matrix_checked, to compare the unchecked element access with
+// the std::array::at one
+
+#include <math4games/math4games.h>
+#include <check.h>
+
+#include <random>
+#include <vector>
+
+using namespace math4games;
+
+int main()
+{
+	const std::size_t count = 4096;
+	const int repetitions = 200;
+	std::mt19937 generator(42);
+	std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+
+	std::vector<mat4> a(count), b(count), result(count);
+	for (std::size_t k = 0; k < count; ++k)
+	{
+		for (std::size_t i = 0; i < 16; ++i)
+		{
+			a[k].data[i] = uniform(generator);
+			b[k].data[i] = uniform(generator);
+		}
+	}
+
+	const double product = check::time(repetitions, [&]() {
+		for (std::size_t k = 0; k < count; ++k)
+			result[k].data = (a[k] * b[k]).data;
+	});
+	float sum = 0.0f;
+	for (const mat4& m : result)
+		sum += m.data[5];
+	const double transpose = check::time(repetitions, [&]() {
+		for (std::size_t k = 0; k < count; ++k)
+			result[k].data = a[k].transpose().data;
+	});
+	for (const mat4& m : result)
+		sum += m.data[5];
+
+	// times are in microseconds
+#ifdef MATH4GAMES_BOUNDS_CHECK
+	std::printf("checked element access\n");
+#else
+	std::printf("unchecked element access\n");
+#endif
+	std::printf("mat4 * mat4 %6.1f ns\n", product * 1.0e3 / count);
+	std::printf("transpose   %6.1f ns\n", transpose * 1.0e3 / count);
+	std::printf("checksum %g\n", sum);
+	return 0;
+}
@@ -0,0 +1,65 @@
+// nanoseconds per element of bulk kernels on aligned_vector storage, cache
+// line aligned, against the same storage offset by one float, in cache
+// (4k floats) and in memory (4M floats), and of mat4 * vec4 over
+// aligned_vector against std::vector. Built again with
+// MATH4GAMES_ALIGN_SIMD as bench_memory_simd, for 16 byte aligned vec4
+
+#include <math4games/math4games.h>
+#include <check.h>
+
+#include <random>
+#include <vector>
+
+using namespace math4games;
+
+template<typename F>
+void run(const char* const name, const std::size_t count, F kernel) {
+	const int repetitions = static_cast<int>(std::max<std::size_t>(4, (1 << 24) / count));
+	aligned_vector<float> a(count + 1), b(count + 1), result(count + 1);
+	std::mt19937 generator(42);
+	std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+	for (std::size_t k = 0; k <= count; ++k)
+	{
+		a[k] = uniform(generator);
+		b[k] = uniform(generator);
+	}
+
+	// times are in microseconds
+	const double aligned = check::time(repetitions, [&]() { kernel(a.data(), b.data(), result.data(), count); });
+	const double unaligned = check::time(repetitions, [&]() { kernel(a.data() + 1, b.data() + 1, result.data() + 1, count); });
+	const double n = static_cast<double>(count) * 1.0e-3;
+	std::printf("%-6s %8zu floats aligned %6.2f ns, unaligned %6.2f ns\n", name, count, aligned / n, unaligned / n);
+}
+
+int main()
+{
+	for (const std::size_t count : { std::size_t(4096), std::size_t(1) << 22 })
+	{
+		run("lerp", count, [](const float* a, const float* b, float* r, const std::size_t n) { bulk::lerp(a, b, 0.25f, r, n); });
+		run("sqrt", count, [](const float* a, const float*, float* r, const std::size_t n) { bulk::sqrt(a, r, n); });
+		run("sin", count, [](const float* a, const float*, float* r, const std::size_t n) { bulk::sin(a, r, n); });
+	}
+
+	// mat4 * vec4 on each vector of an array
+	typedef base_vector<4, float> vector;
+	const std::size_t count = 1 << 20;
+	const int repetitions = 10;
+	mat4 m;
+	for (std::size_t i = 0; i < 16; ++i)
+		m.data[i] = static_cast<float>(i % 5) * 0.25f;
+	aligned_vector<vector> aligned_points(count, vector(1.0f)), aligned_results(count);
+	std::vector<vector> points(count, vector(1.0f)), results(count);
+	const double aligned = check::time(repetitions, [&]() {
+		for (std::size_t k = 0; k < count; ++k)
+			aligned_results[k].data = (m * aligned_points[k]).data;
+	});
+	const double plain = check::time(repetitions, [&]() {
+		for (std::size_t k = 0; k < count; ++k)
+			results[k].data = (m * points[k]).data;
+	});
+	const double n = static_cast<double>(count) * 1.0e-3;
+	std::printf("mat4 * vec4, %zu byte vectors aligned to %zu: aligned_vector %5.2f ns, std::vector %5.2f ns\n",
+		sizeof(vector), alignof(vector), aligned / n, plain / n);
+	std::printf("checksum %g %g\n", aligned_results[7].data[1], results[7].data[1]);
+	return 0;
+}
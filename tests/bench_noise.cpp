@@ -0,0 +1,71 @@
+// nanoseconds per sample of perlin and simplex noise in 2, 3 and 4
+// dimensions, one point at a time and in bulk over 1M points, with and
+// without gradients, and of 5 octave fbm over a 128^3 grid
+
+#include <math4games/math4games.h>
+#include <check.h>
+
+#include <random>
+#include <vector>
+
+using namespace math4games;
+
+template<std::size_t D>
+void run(std::mt19937& generator) {
+	const std::size_t count = 1 << 20;
+	const int repetitions = 3;
+	std::uniform_real_distribution<float> uniform(-100.0f, 100.0f);
+	std::vector<base_vector<D, float>> points(count), gradients(count);
+	for (base_vector<D, float>& p : points)
+		for (std::size_t i = 0; i < D; ++i)
+			p.data[i] = uniform(generator);
+	std::vector<float> values(count);
+
+	for (const noise_type type : { noise_type::perlin, noise_type::simplex })
+	{
+		const bool is_perlin = type == noise_type::perlin;
+		const double single = check::time(repetitions, [&]() {
+			for (std::size_t k = 0; k < count; ++k)
+				values[k] = is_perlin ? perlin(points[k]) : simplex(points[k]);
+		});
+		const double single_gradient = check::time(repetitions, [&]() {
+			for (std::size_t k = 0; k < count; ++k)
+				values[k] = is_perlin ? perlin(points[k], gradients[k]) : simplex(points[k], gradients[k]);
+		});
+
+		// one octave, the bulk version of the same noise
+		fractal_noise<D> noise;
+		noise.type = type;
+		noise.octaves = 1;
+		const double bulk = check::time(repetitions, [&]() { noise.evaluate(points.data(), values.data(), count); });
+		const double bulk_gradient = check::time(repetitions, [&]() {
+			noise.evaluate(points.data(), values.data(), count, gradients.data());
+		});
+
+		// times are in microseconds
+		const double n = static_cast<double>(count) * 1.0e-3;
+		std::printf("%zud %-7s single %6.1f ns, gradient %6.1f ns, bulk %6.1f ns, gradient %6.1f ns\n",
+			D, is_perlin ? "perlin" : "simplex", single / n, single_gradient / n, bulk / n, bulk_gradient / n);
+	}
+}
+
+int main()
+{
+	std::mt19937 generator(42);
+	run<2>(generator);
+	run<3>(generator);
+	run<4>(generator);
+
+	// fbm over a grid, on one thread and on all of them
+	fractal_noise<3> fbm;
+	const base_vector<3, float> origin({ 0.0f, 0.0f, 0.0f }), step({ 0.05f, 0.05f, 0.05f });
+	const base_vector<3, unsigned int> size({ 128, 128, 128 });
+	std::vector<float> grid(128 * 128 * 128);
+	const double one = check::time(1, [&]() { fbm.evaluate_grid(origin, step, size, grid.data()); });
+	const double all = check::time(1, [&]() {
+		fbm.evaluate_grid(origin, step, size, grid.data(), static_cast<base_vector<3, float>*>(nullptr), thread_count());
+	});
+	const double n = static_cast<double>(grid.size()) * 1.0e-3;
+	std::printf("3d fbm 5 octaves grid %6.1f ns, %u threads %6.1f ns\n", one / n, thread_count(), all / n);
+	return 0;
+}
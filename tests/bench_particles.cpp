@@ -0,0 +1,83 @@
+// particles per millisecond of the particle system at 2M particles, with
+// gravity, drag, an attractor, a ground plane and bounds: the fused
+// simulate() step, the same stages as separate passes, and a plain loop
+// over arrays of vec3 for reference
+
+#include <math4games/math4games.h>
+#include <check.h>
+
+#include <random>
+#include <vector>
+
+using namespace math4games;
+
+int main()
+{
+	const std::size_t count = 2000000;
+	const int repetitions = 10;
+	const float dt = 1.0f / 60.0f;
+	std::mt19937 generator(42);
+	std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+
+	particle_system particles;
+	particles.resize(count);
+	std::vector<vec3> positions(count), velocities(count);
+	for (std::size_t k = 0; k < count; ++k)
+	{
+		positions[k] = vec3(50.0f * uniform(generator), 50.0f + 50.0f * uniform(generator), 50.0f * uniform(generator));
+		velocities[k] = vec3(uniform(generator), uniform(generator), uniform(generator));
+		particles.set(k, positions[k], velocities[k]);
+	}
+
+	const plane ground(vec3(0.0f, 1.0f, 0.0f), 0.0f);
+	const aabb box(vec3(-60.0f, -10.0f, -60.0f), vec3(60.0f, 110.0f, 60.0f));
+	attractor center;
+	center.position = base_vector<3, float>({ 0.0f, 50.0f, 0.0f });
+	center.strength = 10.0f;
+
+	particle_settings settings;
+	settings.drag = 0.1f;
+	settings.attractors = &center;
+	settings.attractor_count = 1;
+	settings.planes = &ground;
+	settings.plane_count = 1;
+	settings.bounded = true;
+	settings.bounds = box;
+
+	const double euler = check::time(repetitions, [&]() { simulate(particles, settings, dt); });
+	settings.integrator = particle_integrator::verlet;
+	const double verlet = check::time(repetitions, [&]() { simulate(particles, settings, dt); });
+	const double passes = check::time(repetitions, [&]() {
+		apply_gravity(particles, settings.gravity);
+		apply_drag(particles, settings.drag);
+		apply_attractors(particles, &center, 1);
+		integrate_euler(particles, dt);
+		collide(particles, ground);
+		collide(particles, box);
+	});
+	const double single_thread = check::time(repetitions, [&]() { simulate(particles, settings, dt, 1); });
+
+	// the same euler step with vec3 operators, gravity, drag and the ground only
+	const vec3 gravity(0.0f, -9.81f, 0.0f);
+	const double aos = check::time(repetitions, [&]() {
+		for (std::size_t k = 0; k < count; ++k)
+		{
+			velocities[k] = velocities[k] + (gravity - velocities[k] * settings.drag) * dt;
+			positions[k] = positions[k] + velocities[k] * dt;
+			if (positions[k].y < 0.0f)
+			{
+				positions[k].y = 0.0f;
+				velocities[k].y = -0.5f * velocities[k].y;
+			}
+		}
+	});
+
+	// times are in microseconds
+	const double n = static_cast<double>(count);
+	std::printf("%zu particles, %u threads\n", count, thread_count());
+	std::printf("simulate euler  %8.0f particles/ms\n", n / euler * 1.0e3);
+	std::printf("simulate verlet %8.0f particles/ms, one thread %8.0f particles/ms\n", n / verlet * 1.0e3, n / single_thread * 1.0e3);
+	std::printf("separate passes %8.0f particles/ms\n", n / passes * 1.0e3);
+	std::printf("vec3 loop       %8.0f particles/ms, with fewer stages\n", n / aos * 1.0e3);
+	return 0;
+}
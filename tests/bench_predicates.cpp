@@ -0,0 +1,148 @@
+// nanoseconds per call of orient2d, orient3d, incircle and insphere on
+// random points, on small integer lattices and on points of a line, plane,
+// circle or sphere rounded to float, the last two nearly degenerate.
+// Built again with MATH4GAMES_PROFILE as bench_predicates_profile, which
+// also prints the share of calls decided by the double filter, without
+// the exact stage; its times include the counting
+
+#include <math4games/math4games.h>
+#include <check.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace math4games;
+
+typedef base_vector<2, double> vector2d;
+typedef base_vector<3, double> vector3d;
+
+enum class inputs { random, lattice, rounded };
+
+static const char* const input_names[] = { "random", "lattice", "rounded" };
+
+#ifdef MATH4GAMES_PROFILE
+// calls counted at the site of the operation, over every thread
+static std::uint64_t calls(const std::string& operation) {
+	profile::registry& r = profile::registry::instance();
+	std::uint64_t total = 0;
+	for (std::size_t i = 0; i < r.sites.size(); ++i)
+	{
+		if (r.sites[i].first != operation)
+			continue;
+		for (const auto& t : r.threads)
+		{
+			std::lock_guard<std::mutex> lock(t->mutex);
+			if (i < t->counters.size())
+				total += t->counters[i].calls;
+		}
+	}
+	return total;
+}
+#endif
+
+// time count calls of the predicate on consecutive groups of points
+template<typename F>
+static void run(const char* const name, const inputs set, const std::size_t count, F predicate) {
+	const int repetitions = 5;
+	long sum = 0;
+#ifdef MATH4GAMES_PROFILE
+	profile::reset();
+#endif
+	const double t = check::time(repetitions, [&]() {
+		for (std::size_t k = 0; k < count; ++k)
+			sum += predicate(k);
+	});
+	std::printf("%-8s %-8s %6.1f ns", name, input_names[static_cast<int>(set)], t * 1.0e3 / count);
+#ifdef MATH4GAMES_PROFILE
+	const double exact = static_cast<double>(calls(std::string(name) + " exact"));
+	std::printf(", filter hit rate %7.3f%%", 100.0 * (1.0 - exact / calls(name)));
+#endif
+	std::printf(", sign sum %ld\n", sum);
+}
+
+int main()
+{
+	const std::size_t count = 1 << 18;
+	std::mt19937 generator(42);
+	std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+	std::normal_distribution<double> normal;
+	auto lattice = [&generator]() { return static_cast<double>(generator() % 4); };
+	auto to_float = [](const double x) { return static_cast<double>(static_cast<float>(x)); };
+
+	const inputs sets[] = { inputs::random, inputs::lattice, inputs::rounded };
+	for (const inputs set : sets)
+	{
+		// groups of 3 and 4 points in the plane, of 4 and 5 in space
+		std::vector<vector2d> lines(count * 3), circles(count * 4);
+		std::vector<vector3d> planes(count * 4), spheres(count * 5);
+		for (vector2d& p : lines)
+			p.data = { uniform(generator), uniform(generator) };
+		for (vector2d& p : circles)
+			p.data = { uniform(generator), uniform(generator) };
+		for (vector3d& p : planes)
+			p.data = { uniform(generator), uniform(generator), uniform(generator) };
+		for (vector3d& p : spheres)
+			p.data = { uniform(generator), uniform(generator), uniform(generator) };
+
+		if (set == inputs::lattice)
+		{
+			for (vector2d& p : lines)
+				p.data = { lattice(), lattice() };
+			for (vector2d& p : circles)
+				p.data = { lattice(), lattice() };
+			for (vector3d& p : planes)
+				p.data = { lattice(), lattice(), lattice() };
+			for (vector3d& p : spheres)
+				p.data = { lattice(), lattice(), lattice() };
+		}
+		else if (set == inputs::rounded)
+		{
+			for (vector2d& p : lines)
+				p.data = { to_float(p.data[0]), to_float(p.data[1]) };
+			for (vector3d& p : planes)
+				p.data = { to_float(p.data[0]), to_float(p.data[1]), to_float(p.data[2]) };
+			for (std::size_t k = 0; k < count; ++k)
+			{
+				// the last point of each line and plane on the others
+				vector2d* l = &lines[k * 3];
+				const double t = uniform(generator);
+				for (unsigned int i = 0; i < 2; ++i)
+					l[2].data[i] = to_float(l[0].data[i] + t * (l[1].data[i] - l[0].data[i]));
+				vector3d* p = &planes[k * 4];
+				const double s = uniform(generator), r = uniform(generator);
+				for (unsigned int i = 0; i < 3; ++i)
+					p[3].data[i] = to_float(p[0].data[i] + s * (p[1].data[i] - p[0].data[i]) + r * (p[2].data[i] - p[0].data[i]));
+			}
+			for (vector2d& p : circles)
+			{
+				const double angle = 3.14159265358979323846 * uniform(generator);
+				p.data = { to_float(std::cos(angle)), to_float(std::sin(angle)) };
+			}
+			for (vector3d& p : spheres)
+			{
+				const double x = normal(generator), y = normal(generator), z = normal(generator);
+				const double length = std::sqrt(x * x + y * y + z * z);
+				p.data = { to_float(x / length), to_float(y / length), to_float(z / length) };
+			}
+		}
+
+		run("orient2d", set, count, [&lines](const std::size_t k) {
+			const vector2d* p = &lines[k * 3];
+			return orient2d(p[0], p[1], p[2]);
+		});
+		run("orient3d", set, count, [&planes](const std::size_t k) {
+			const vector3d* p = &planes[k * 4];
+			return orient3d(p[0], p[1], p[2], p[3]);
+		});
+		run("incircle", set, count, [&circles](const std::size_t k) {
+			const vector2d* p = &circles[k * 4];
+			return incircle(p[0], p[1], p[2], p[3]);
+		});
+		run("insphere", set, count, [&spheres](const std::size_t k) {
+			const vector3d* p = &spheres[k * 5];
+			return insphere(p[0], p[1], p[2], p[3], p[4]);
+		});
+	}
+	return 0;
+}
@@ -0,0 +1,124 @@
+// linear blend skinning of 1M vertices with a palette of 64 bones: 4 and
+// 8 influences, 3x4 and 4x4 palettes, positions alone and with normals,
+// against the blend of matrix4 temporaries through matrix.h operators
+
+#include <math4games/math4games.h>
+#include <check.h>
+
+#include <random>
+#include <vector>
+
+using namespace math4games;
+
+// structure of arrays storage for count 3 vectors
+struct soa_storage
+{
+	std::vector<float> values;
+	soa_vec3 view;
+
+	explicit soa_storage(const std::size_t count) : values(3 * count) {
+		for (std::size_t i = 0; i < 3; ++i)
+			view.data[i] = values.data() + i * count;
+		view.count = count;
+	}
+};
+
+template<std::size_t Influences>
+std::vector<skin_influences<Influences>> random_influences(std::mt19937& generator, const std::size_t count, const unsigned int bones) {
+	std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+	std::vector<skin_influences<Influences>> influences(count);
+	for (skin_influences<Influences>& influence : influences)
+	{
+		float sum = 0.0f;
+		for (std::size_t i = 0; i < Influences; ++i)
+		{
+			influence.bones[i] = static_cast<std::uint16_t>(generator() % bones);
+			influence.weights[i] = uniform(generator);
+			sum += influence.weights[i];
+		}
+		for (std::size_t i = 0; i < Influences; ++i)
+			influence.weights[i] /= sum;
+	}
+	return influences;
+}
+
+int main()
+{
+	const std::size_t count = 1000000;
+	const unsigned int bones = 64;
+	const int repetitions = 10;
+	std::mt19937 generator(43);
+	std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+
+	std::vector<base_matrix<4, 4, float>> pose(bones), inverse_bind(bones);
+	for (unsigned int b = 0; b < bones; ++b)
+	{
+		const quaternion q = quaternion::axis_angle(vec3(0.0f, 1.0f, 0.0f), 360.0f * uniform(generator));
+		pose[b] = compose(vec3(uniform(generator), uniform(generator), uniform(generator)), q, vec3(1.0f, 1.0f, 1.0f));
+		inverse_bind[b] = compose(vec3(uniform(generator), uniform(generator), uniform(generator)), quaternion(0.0f, 0.0f, 0.0f, 1.0f), vec3(1.0f, 1.0f, 1.0f));
+	}
+	std::vector<bone_matrix> palette3(bones);
+	std::vector<base_matrix<4, 4, float>> palette4(bones);
+	skin_palette(pose.data(), inverse_bind.data(), palette3.data(), bones);
+	skin_palette(pose.data(), inverse_bind.data(), palette4.data(), bones);
+
+	soa_storage positions(count), normals(count), skinned_positions(count), skinned_normals(count);
+	std::vector<base_vector<4, float>> aos_positions(count), aos_skinned(count);
+	for (std::size_t k = 0; k < count; ++k)
+	{
+		const base_vector<3, float> p({ uniform(generator), uniform(generator), uniform(generator) });
+		positions.view.set(k, p);
+		normals.view.set(k, base_vector<3, float>({ 0.0f, 1.0f, 0.0f }));
+		aos_positions[k] = base_vector<4, float>({ p.data[0], p.data[1], p.data[2], 1.0f });
+	}
+	const std::vector<skin_influences4> influences4 = random_influences<4>(generator, count, bones);
+	const std::vector<skin_influences8> influences8 = random_influences<8>(generator, count, bones);
+
+	const double positions4 = check::time(repetitions, [&]() {
+		skin(palette3.data(), influences4.data(), positions.view, skinned_positions.view);
+	});
+	const double positions4_single = check::time(repetitions, [&]() {
+		skin(palette3.data(), influences4.data(), positions.view, skinned_positions.view, 1);
+	});
+	const double positions4_matrix4 = check::time(repetitions, [&]() {
+		skin(palette4.data(), influences4.data(), positions.view, skinned_positions.view);
+	});
+	const double normals4 = check::time(repetitions, [&]() {
+		skin(palette3.data(), influences4.data(), positions.view, normals.view, skinned_positions.view, skinned_normals.view);
+	});
+	const double positions8 = check::time(repetitions, [&]() {
+		skin(palette3.data(), influences8.data(), positions.view, skinned_positions.view);
+	});
+	const double normals8 = check::time(repetitions, [&]() {
+		skin(palette3.data(), influences8.data(), positions.view, normals.view, skinned_positions.view, skinned_normals.view);
+	});
+
+	// a weighted matrix4 per influence, then matrix4 * vec4
+	const double operators = check::time(repetitions, [&]() {
+		for (std::size_t k = 0; k < count; ++k)
+		{
+			const skin_influences4& influence = influences4[k];
+			base_matrix<4, 4, float> m = palette4[influence.bones[0]] * influence.weights[0];
+			for (std::size_t i = 1; i < 4; ++i)
+				m = m + palette4[influence.bones[i]] * influence.weights[i];
+			aos_skinned[k] = m * aos_positions[k];
+		}
+	});
+
+	// the bulk and the operator results agree
+	skin(palette4.data(), influences4.data(), positions.view, skinned_positions.view);
+	float error = 0.0f;
+	for (std::size_t k = 0; k < count; ++k)
+	{
+		const base_vector<3, float> p = skinned_positions.view.get(k);
+		for (unsigned int i = 0; i < 3; ++i)
+			error = std::max(error, std::fabs(p.data[i] - aos_skinned[k].data[i]));
+	}
+
+	std::printf("%zu vertices, %u bones, %u threads, largest difference from the operators %g\n", count, bones, thread_count(), error);
+	std::printf("4 influences: positions %6.2f ms (one thread %6.2f ms, matrix4 palette %6.2f ms), with normals %6.2f ms\n",
+		positions4 * 1.0e-3, positions4_single * 1.0e-3, positions4_matrix4 * 1.0e-3, normals4 * 1.0e-3);
+	std::printf("8 influences: positions %6.2f ms, with normals %6.2f ms\n", positions8 * 1.0e-3, normals8 * 1.0e-3);
+	std::printf("matrix.h operators, 4 influences: positions %6.2f ms\n", operators * 1.0e-3);
+	return 0;
+}
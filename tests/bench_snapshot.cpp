@@ -0,0 +1,66 @@
+// throughput of the snapshot codec on 20k entities, with a full and a delta
+// snapshot where 30% of the entities move, 1% teleport and 20% rotate
+
+#include <math4games/math4games.h>
+#include <check.h>
+
+#include <random>
+#include <vector>
+
+using namespace math4games;
+
+typedef base_vector<3, float> position;
+
+int main()
+{
+	std::mt19937 generator(5);
+	std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+	std::normal_distribution<float> normal;
+	auto random_rotation = [&]() {
+		const float x = normal(generator), y = normal(generator), z = normal(generator), w = normal(generator);
+		const float length = std::sqrt(x * x + y * y + z * z + w * w);
+		return quaternion(x / length, y / length, z / length, w / length);
+	};
+	auto random_position = [&]() {
+		return position({ 2000.0f * uniform(generator) - 1000.0f, 100.0f * uniform(generator), 2000.0f * uniform(generator) - 1000.0f });
+	};
+
+	const std::size_t count = 20000;
+	const int repetitions = 200;
+	std::vector<position> positions(count), moved(count), output_positions(count);
+	std::vector<quaternion> rotations(count), turned(count), output_rotations(count);
+	for (std::size_t k = 0; k < count; ++k)
+	{
+		positions[k] = moved[k] = random_position();
+		rotations[k] = turned[k] = random_rotation();
+		const float r = uniform(generator);
+		if (r < 0.3f)
+			moved[k] = position({ positions[k].data[0] + 0.6f * uniform(generator) - 0.3f, positions[k].data[1], positions[k].data[2] + 0.6f * uniform(generator) - 0.3f });
+		else if (r < 0.31f)
+			moved[k] = random_position();
+		if (uniform(generator) < 0.2f)
+			turned[k] = random_rotation();
+	}
+
+	const snapshot_codec codec(position({ -1000.0f, 0.0f, -1000.0f }), position({ 1000.0f, 100.0f, 1000.0f }), 0.01f, 10, 8);
+	quantized_snapshot baseline, current, decoded;
+	std::vector<std::uint8_t> full, delta;
+	codec.quantize(positions.data(), rotations.data(), count, baseline);
+	codec.quantize(moved.data(), turned.data(), count, current);
+	codec.encode(current, nullptr, full);
+	codec.encode(current, &baseline, delta);
+
+	const double quantize = check::time(repetitions, [&]() { codec.quantize(moved.data(), turned.data(), count, current); });
+	const double encode_full = check::time(repetitions, [&]() { codec.encode(current, nullptr, full); });
+	const double encode_delta = check::time(repetitions, [&]() { codec.encode(current, &baseline, delta); });
+	const double decode_full = check::time(repetitions, [&]() { codec.decode(full.data(), full.size(), nullptr, decoded); });
+	const double decode_delta = check::time(repetitions, [&]() { codec.decode(delta.data(), delta.size(), &baseline, decoded); });
+	const double dequantize = check::time(repetitions, [&]() { codec.dequantize(decoded, output_positions.data(), output_rotations.data()); });
+
+	std::printf("%zu entities, full %.1f bits/entity, delta %.1f bits/entity\n", count, full.size() * 8.0 / count, delta.size() * 8.0 / count);
+	std::printf("quantize %8.1f us\n", quantize);
+	std::printf("encode   %8.1f us full, %8.1f us delta\n", encode_full, encode_delta);
+	std::printf("decode   %8.1f us full, %8.1f us delta\n", decode_full, decode_delta);
+	std::printf("dequantize %6.1f us\n", dequantize);
+	return 0;
+}
@@ -0,0 +1,124 @@
+// space filling curve keys, radix sort and spatial sort of 1M points, and
+// the speedup they give to a uniform grid neighbour query that visits the
+// points in array order
+
+#include <math4games/math4games.h>
+#include <check.h>
+
+#include <random>
+#include <vector>
+
+using namespace math4games;
+
+typedef base_point<3, float> position;
+
+// points within radius of each point, found through a uniform grid of
+// cells of size radius over the unit cube, with the points of each cell
+// stored contiguously in the order of the array
+struct neighbour_grid
+{
+	unsigned int resolution;
+	std::vector<std::uint32_t> first;
+	std::vector<std::uint32_t> items;
+
+	neighbour_grid(const std::vector<position>& points, const float radius)
+		: resolution(static_cast<unsigned int>(1.0f / radius)), first(resolution * resolution * resolution + 1, 0), items(points.size()) {
+		for (const position& p : points)
+			++first[cell(p) + 1];
+		for (std::size_t c = 1; c < first.size(); ++c)
+			first[c] += first[c - 1];
+		std::vector<std::uint32_t> next(first.begin(), first.end() - 1);
+		for (std::size_t k = 0; k < points.size(); ++k)
+			items[next[cell(points[k])]++] = static_cast<std::uint32_t>(k);
+	}
+
+	unsigned int coordinate(const float x) const {
+		const int c = static_cast<int>(x * resolution);
+		return static_cast<unsigned int>(std::min(std::max(c, 0), static_cast<int>(resolution) - 1));
+	}
+
+	std::size_t cell(const position& p) const {
+		return (static_cast<std::size_t>(coordinate(p.data[2])) * resolution + coordinate(p.data[1])) * resolution + coordinate(p.data[0]);
+	}
+
+	// total number of neighbour pairs, each point in array order
+	std::size_t query(const std::vector<position>& points, const float radius) const {
+		const float r2 = radius * radius;
+		std::size_t pairs = 0;
+		for (const position& p : points) {
+			const int x = static_cast<int>(coordinate(p.data[0])), y = static_cast<int>(coordinate(p.data[1])), z = static_cast<int>(coordinate(p.data[2]));
+			const int last = static_cast<int>(resolution) - 1;
+			for (int k = std::max(z - 1, 0); k <= std::min(z + 1, last); ++k) {
+				for (int j = std::max(y - 1, 0); j <= std::min(y + 1, last); ++j) {
+					const std::size_t row = (static_cast<std::size_t>(k) * resolution + j) * resolution;
+					const std::uint32_t begin = first[row + std::max(x - 1, 0)];
+					const std::uint32_t end = first[row + std::min(x + 1, last) + 1];
+					for (std::uint32_t i = begin; i < end; ++i) {
+						const position& q = points[items[i]];
+						const float dx = q.data[0] - p.data[0], dy = q.data[1] - p.data[1], dz = q.data[2] - p.data[2];
+						pairs += dx * dx + dy * dy + dz * dz <= r2;
+					}
+				}
+			}
+		}
+		return pairs;
+	}
+};
+
+int main()
+{
+	const std::size_t count = 1 << 20;
+	const float radius = 0.01f;
+	const int repetitions = 5;
+	std::mt19937 generator(37);
+	std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+	std::vector<position> points(count);
+	for (position& p : points)
+		p = position({ uniform(generator), uniform(generator), uniform(generator) });
+	position min, max;
+	bounds(points.data(), count, min, max);
+
+	// keys and sorting
+	std::vector<std::uint64_t> keys(count);
+	std::vector<std::uint32_t> order(count);
+	const double morton = check::time(repetitions, [&]() { morton_keys(points.data(), keys.data(), count, min, max); });
+	const double hilbert = check::time(repetitions, [&]() { hilbert_keys(points.data(), keys.data(), count, min, max); });
+	std::vector<std::uint64_t> sorted_keys(count);
+	const double radix = check::time(repetitions, [&]() {
+		sorted_keys = keys;
+		radix_sort(sorted_keys.data(), order.data(), count, 63);
+	});
+	const double radix_serial = check::time(repetitions, [&]() {
+		sorted_keys = keys;
+		radix_sort(sorted_keys.data(), order.data(), count, 63, 1);
+	});
+	std::vector<position> hilbert_points;
+	const double sort = check::time(repetitions, [&]() {
+		hilbert_points = points;
+		spatial_sort(hilbert_points.data(), order.data(), count);
+	});
+
+	std::vector<position> morton_points(count);
+	morton_keys(points.data(), keys.data(), count, min, max);
+	radix_sort(keys.data(), order.data(), count, 63);
+	reorder(points.data(), morton_points.data(), order.data(), count);
+
+	std::printf("%zu points\n", count);
+	std::printf("morton keys %7.2f ms, hilbert keys %7.2f ms\n", morton * 1.0e-3, hilbert * 1.0e-3);
+	std::printf("radix sort  %7.2f ms, one thread %7.2f ms\n", radix * 1.0e-3, radix_serial * 1.0e-3);
+	std::printf("spatial sort %6.2f ms\n", sort * 1.0e-3);
+
+	// neighbour queries in random, Morton and Hilbert order
+	const std::vector<position>* orders[3] = { &points, &morton_points, &hilbert_points };
+	const char* names[3] = { "random ", "morton ", "hilbert" };
+	double random_time = 0.0;
+	for (unsigned int o = 0; o < 3; ++o) {
+		const neighbour_grid grid(*orders[o], radius);
+		std::size_t pairs = 0;
+		const double query = check::time(repetitions, [&]() { pairs = grid.query(*orders[o], radius); });
+		if (o == 0)
+			random_time = query;
+		std::printf("neighbour query, %s order %8.2f ms, %.2fx, %zu pairs\n", names[o], query * 1.0e-3, random_time / query, pairs);
+	}
+	return 0;
+}
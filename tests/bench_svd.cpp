@@ -0,0 +1,102 @@
+// throughput of the 3x3 svd and polar decomposition on 100k random
+// matrices: one matrix at a time and in batches of 4 and 8 lanes
+
+#include <math4games/math4games.h>
+#include <check.h>
+
+#include <random>
+#include <vector>
+
+using namespace math4games;
+
+// structure of arrays storage for count 3x3 matrices or 3 vectors
+struct soa_storage
+{
+	std::vector<float> values;
+
+	soa_storage(const std::size_t elements, const std::size_t count) : values(elements * count) {}
+
+	soa_mat3 matrices(const std::size_t count) {
+		soa_mat3 m;
+		for (std::size_t i = 0; i < 9; ++i)
+			m.data[i] = values.data() + i * count;
+		m.count = count;
+		return m;
+	}
+
+	soa_vec3 vectors(const std::size_t count) {
+		soa_vec3 v;
+		for (std::size_t i = 0; i < 3; ++i)
+			v.data[i] = values.data() + i * count;
+		v.count = count;
+		return v;
+	}
+};
+
+int main()
+{
+	const std::size_t count = 100000;
+	const int repetitions = 20;
+	std::mt19937 generator(27);
+	std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+
+	std::vector<base_matrix<3, 3, float>> matrices(count);
+	soa_storage input(9, count), u(9, count), s(3, count), v(9, count);
+	soa_mat3 soa_input = input.matrices(count), soa_u = u.matrices(count), soa_v = v.matrices(count);
+	soa_vec3 soa_s = s.vectors(count);
+	for (std::size_t k = 0; k < count; ++k)
+	{
+		for (unsigned int i = 0; i < 9; ++i)
+			matrices[k].data[i] = uniform(generator);
+		soa_input.set(k, matrices[k]);
+	}
+
+	std::vector<svd3> results(count);
+	std::vector<polar3> polars(count);
+	std::vector<quaternion> rotations(count);
+	std::vector<base_matrix<3, 3, float>> stretches(count);
+
+	const double svd_scalar = check::time(repetitions, [&]() {
+		for (std::size_t k = 0; k < count; ++k)
+			results[k] = svd(matrices[k]);
+	});
+	const double svd_4 = check::time(repetitions, [&]() { svd<4>(soa_input, soa_u, soa_s, soa_v); });
+	const double svd_8 = check::time(repetitions, [&]() { svd<8>(soa_input, soa_u, soa_s, soa_v); });
+	const double polar_scalar = check::time(repetitions, [&]() {
+		for (std::size_t k = 0; k < count; ++k)
+			polars[k] = polar(matrices[k]);
+	});
+	const double polar_4 = check::time(repetitions, [&]() { polar<4>(soa_input, soa_u, soa_v); });
+	const double polar_8 = check::time(repetitions, [&]() { polar<8>(soa_input, soa_u, soa_v); });
+	const double polar_quaternion = check::time(repetitions, [&]() {
+		polar(matrices.data(), rotations.data(), stretches.data(), count);
+	});
+
+	// largest reconstruction error of the batch svd, u diag(s) v^t - m
+	svd<8>(soa_input, soa_u, soa_s, soa_v);
+	float error = 0.0f;
+	for (std::size_t k = 0; k < count; ++k)
+	{
+		const base_matrix<3, 3, float> mu = soa_u.get(k), mv = soa_v.get(k);
+		const base_vector<3, float> ms = soa_s.get(k);
+		for (unsigned int i = 0; i < 3; ++i)
+		{
+			for (unsigned int j = 0; j < 3; ++j)
+			{
+				float r = 0.0f;
+				for (unsigned int c = 0; c < 3; ++c)
+					r += mu.data[i * 3 + c] * ms.data[c] * mv.data[j * 3 + c];
+				error = std::max(error, std::fabs(r - matrices[k].data[i * 3 + j]));
+			}
+		}
+	}
+
+	// matrices per microsecond are millions per second
+	const double n = static_cast<double>(count);
+	std::printf("%zu matrices, largest svd reconstruction error %g\n", count, error);
+	std::printf("svd    scalar %7.2f M/s, 4 lanes %7.2f M/s, 8 lanes %7.2f M/s\n",
+		n / svd_scalar, n / svd_4, n / svd_8);
+	std::printf("polar  scalar %7.2f M/s, 4 lanes %7.2f M/s, 8 lanes %7.2f M/s, quaternions %7.2f M/s\n",
+		n / polar_scalar, n / polar_4, n / polar_8, n / polar_quaternion);
+	return 0;
+}
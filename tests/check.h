@@ -0,0 +1,48 @@
+/*
+	Tests
+	Vito Domenico Tagliente
+	math library for games
+*/
+
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+
+// minimal checks for the tests: a failed check is printed and makes
+// the test exit with a non zero code
+namespace check
+{
+	inline int& failures() {
+		static int count = 0;
+		return count;
+	}
+
+	inline void expect(const bool condition, const char* const expression, const char* const file, const int line) {
+		if (!condition)
+		{
+			std::printf("%s:%d: check failed: %s\n", file, line, expression);
+			++failures();
+		}
+	}
+
+	inline int result() {
+		if (failures() == 0)
+			std::printf("all checks passed\n");
+		return failures() == 0 ? 0 : 1;
+	}
+
+	// microseconds for each call of the function, over the given
+	// repetitions after a first untimed call
+	template <typename F>
+	double time(const int repetitions, F function) {
+		function();
+		const auto begin = std::chrono::steady_clock::now();
+		for (int r = 0; r < repetitions; ++r)
+			function();
+		const auto end = std::chrono::steady_clock::now();
+		return std::chrono::duration<double, std::micro>(end - begin).count() / repetitions;
+	}
+}
+
+#define CHECK(condition) check::expect((condition), #condition, __FILE__, __LINE__)
@@ -0,0 +1,7 @@
+// second translation unit of test_link, including the whole library again
+
+#include <math4games/math4games.h>
+
+float link_unit_radians(const float degrees) {
+	return math4games::radians(degrees);
+}
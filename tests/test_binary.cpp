@@ -0,0 +1,159 @@
+// round trip of the binary container: arrays of vectors, points, matrices
+// and quaternions written in aos and soa layouts, as f32 and f64, must map
+// back with the same header and the same values, and files with a broken
+// header, a data offset inside the header or missing data must not open
+
+#include <math4games/math4games.h>
+#include <check.h>
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace math4games;
+
+const char* const path = "test_binary.m4gb";
+
+// the mapped file has the expected header and element k component c is value(k, c)
+template<typename T, typename Value>
+bool matches(const element_kind element, const std::size_t rows, const std::size_t columns,
+	const data_layout layout, const std::size_t count, Value value) {
+	binary_file file;
+	if (!file.open(path))
+		return false;
+	const binary_header& h = file.header();
+	if (h.element != element || h.scalar != scalar_traits<T>::kind || h.rows != rows || h.columns != columns ||
+		h.layout != layout || h.count != count || h.offset != binary_data_alignment)
+		return false;
+	const binary_view<T> view = file.view<T>();
+	if (view.data == nullptr || view.count != count || view.components != rows * columns)
+		return false;
+	// the other scalar type gives an empty view
+	if (file.view<typename std::conditional<std::is_same<T, float>::value, double, float>::type>().data != nullptr)
+		return false;
+	for (std::size_t k = 0; k < count; ++k)
+		for (std::size_t c = 0; c < rows * columns; ++c)
+			if (view(k, c) != value(k, c))
+				return false;
+	return true;
+}
+
+// a file of the header and size bytes of data
+void write_raw(const binary_header& h, const std::size_t size) {
+	unsigned char head[binary_data_alignment] = {};
+	detail::encode_header(h, head);
+	std::vector<unsigned char> data(size, 0);
+	std::FILE* file = std::fopen(path, "wb");
+	std::fwrite(head, 1, sizeof(head), file);
+	std::fwrite(data.data(), 1, data.size(), file);
+	std::fclose(file);
+}
+
+bool opens() {
+	binary_file file;
+	return file.open(path);
+}
+
+int main()
+{
+	std::mt19937 generator(42);
+	std::uniform_real_distribution<float> uniform(-100.0f, 100.0f);
+	// 5000 elements, more than one write chunk
+	const std::size_t count = 5000;
+
+	std::vector<vec3> vectors(count);
+	std::vector<base_vector<3, double>> doubles(count);
+	std::vector<point2> points(count);
+	std::vector<mat4> matrices(count);
+	std::vector<base_matrix<3, 2, double>> double_matrices(count);
+	std::vector<quaternion> rotations(count);
+	for (std::size_t k = 0; k < count; ++k)
+	{
+		vectors[k] = vec3(uniform(generator), uniform(generator), uniform(generator));
+		for (double& value : doubles[k].data)
+			value = uniform(generator) / 3.0;
+		points[k] = point2(uniform(generator), uniform(generator));
+		for (float& value : matrices[k].data)
+			value = uniform(generator);
+		for (double& value : double_matrices[k].data)
+			value = uniform(generator) / 7.0;
+		rotations[k] = quaternion(uniform(generator), uniform(generator), uniform(generator), uniform(generator));
+	}
+
+	for (const data_layout layout : { data_layout::aos, data_layout::soa })
+	{
+		CHECK(write_binary(path, vectors.data(), count, layout));
+		CHECK(matches<float>(element_kind::vector, 3, 1, layout, count,
+			[&](std::size_t k, std::size_t c) { return vectors[k][static_cast<unsigned int>(c)]; }));
+
+		CHECK(write_binary(path, doubles.data(), count, layout));
+		CHECK(matches<double>(element_kind::vector, 3, 1, layout, count,
+			[&](std::size_t k, std::size_t c) { return doubles[k].data[c]; }));
+
+		CHECK(write_binary(path, points.data(), count, layout));
+		CHECK(matches<float>(element_kind::point, 2, 1, layout, count,
+			[&](std::size_t k, std::size_t c) { return points[k][static_cast<unsigned int>(c)]; }));
+
+		CHECK(write_binary(path, matrices.data(), count, layout));
+		CHECK(matches<float>(element_kind::matrix, 4, 4, layout, count,
+			[&](std::size_t k, std::size_t c) { return matrices[k].data[c]; }));
+
+		CHECK(write_binary(path, double_matrices.data(), count, layout));
+		CHECK(matches<double>(element_kind::matrix, 3, 2, layout, count,
+			[&](std::size_t k, std::size_t c) { return double_matrices[k].data[c]; }));
+
+		CHECK(write_binary(path, rotations.data(), count, layout));
+		CHECK(matches<float>(element_kind::quaternion, 4, 1, layout, count,
+			[&](std::size_t k, std::size_t c) { return c < 3 ? rotations[k].v[static_cast<unsigned int>(c)] : rotations[k].w; }));
+	}
+
+	// the typed accessors of the views
+	CHECK(write_binary(path, matrices.data(), count));
+	{
+		binary_file file(path);
+		const binary_view<float> view = file.view<float>();
+		const base_matrix<4, 4, float> m = view.matrix<4, 4>(17);
+		CHECK(m.data == matrices[17].data);
+		CHECK(view.element(17)[5] == matrices[17].data[5]);
+	}
+	CHECK(write_binary(path, rotations.data(), count, data_layout::soa));
+	{
+		binary_file file(path);
+		const binary_view<float> view = file.view<float>();
+		const quaternion q = view.rotation(9);
+		CHECK(q.v.data == rotations[9].v.data && q.w == rotations[9].w);
+		CHECK(view.component(3)[9] == rotations[9].w);
+	}
+
+	// broken files
+	binary_header h;
+	h.element = element_kind::vector;
+	h.rows = 4;
+	h.count = 16;
+	h.offset = binary_data_alignment;
+	write_raw(h, 256);
+	CHECK(opens());
+	write_raw(h, 255);
+	CHECK(!opens());
+	h.offset = 0;
+	write_raw(h, 256);
+	CHECK(!opens());
+	h.offset = 32;
+	write_raw(h, 256);
+	CHECK(!opens());
+	h.offset = 2 * binary_data_alignment;
+	write_raw(h, 256);
+	CHECK(!opens());
+	h.offset = binary_data_alignment;
+	h.columns = 2;
+	write_raw(h, 512);
+	CHECK(!opens());
+	h.columns = 1;
+	h.version = binary_version + 1;
+	write_raw(h, 256);
+	CHECK(!opens());
+
+	std::remove(path);
+	CHECK(!opens());
+	return check::result();
+}
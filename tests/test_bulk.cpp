@@ -0,0 +1,170 @@
+// largest error of each accuracy tier of the bulk functions against
+// <cmath> in double: ulps of the float result, and relative error
+
+#include <math4games/math4games.h>
+#include <check.h>
+
+#include <cfloat>
+#include <random>
+#include <vector>
+
+using namespace math4games;
+
+// distance in ulps of the float result r from the exact value
+double ulp_error(const float r, const double exact) {
+	if (std::isnan(exact))
+		return std::isnan(r) ? 0.0 : HUGE_VAL;
+	const float rounded = static_cast<float>(exact);
+	if (std::isinf(rounded))
+		return r == rounded ? 0.0 : HUGE_VAL;
+	const float magnitude = std::fabs(rounded);
+	const double ulp = magnitude < FLT_MIN ? std::ldexp(1.0, -149)
+		: static_cast<double>(std::nextafter(magnitude, HUGE_VALF)) - magnitude;
+	return std::fabs(static_cast<double>(r) - exact) / ulp;
+}
+
+std::mt19937 generator(50);
+
+// count values uniform in [low, high], or with a uniform logarithm
+std::vector<float> sample(const double low, const double high, const bool logarithmic = false) {
+	std::uniform_real_distribution<double> uniform(0.0, 1.0);
+	std::vector<float> values(1 << 18);
+	for (float& x : values)
+	{
+		const double u = uniform(generator);
+		x = static_cast<float>(logarithmic ? std::exp(std::log(low) + (std::log(high) - std::log(low)) * u) : low + (high - low) * u);
+	}
+	return values;
+}
+
+struct tier_error
+{
+	double ulps = 0.0;
+	double relative = 0.0;
+
+	void add(const float r, const double exact) {
+		ulps = std::max(ulps, ulp_error(r, exact));
+		// relative errors of normal results
+		const float rounded = static_cast<float>(exact);
+		if (std::isfinite(rounded) && std::fabs(rounded) >= FLT_MIN)
+			relative = std::max(relative, std::fabs(static_cast<double>(r) - exact) / std::fabs(exact));
+	}
+};
+
+// the precise tier is within 4 ulps, the fast one within a relative error of 1e-4
+void report(const char* name, const tier_error& precise, const tier_error& fast) {
+	std::printf("%-14s precise %6.2f ulp %.1e rel | fast %10.1f ulp %.1e rel\n", name, precise.ulps, precise.relative, fast.ulps, fast.relative);
+	CHECK(precise.ulps <= 4.0);
+	CHECK(fast.relative <= 1.0e-4);
+}
+
+typedef void (*unary)(const float*, float*, std::size_t);
+
+void test(const char* name, unary precise, unary fast, double (*exact)(double), const std::vector<float>& x) {
+	std::vector<float> r(x.size());
+	tier_error errors[2];
+	const unary functions[2] = { precise, fast };
+	for (unsigned int t = 0; t < 2; ++t)
+	{
+		functions[t](x.data(), r.data(), x.size());
+		for (std::size_t k = 0; k < x.size(); ++k)
+			errors[t].add(r[k], exact(x[k]));
+	}
+	report(name, errors[0], errors[1]);
+}
+
+int main()
+{
+	auto sin = [](const double x) { return std::sin(x); };
+	auto cos = [](const double x) { return std::cos(x); };
+	auto tan = [](const double x) { return std::tan(x); };
+	auto acos = [](const double x) { return std::acos(x); };
+	auto exp = [](const double x) { return std::exp(x); };
+	auto log = [](const double x) { return std::log(x); };
+	auto sqrt = [](const double x) { return std::sqrt(x); };
+	auto rsqrt = [](const double x) { return 1.0 / std::sqrt(x); };
+
+	test("sin", bulk::sin<accuracy::precise>, bulk::sin<accuracy::fast>, sin, sample(-100.0, 100.0));
+	test("sin large", bulk::sin<accuracy::precise>, bulk::sin<accuracy::fast>, sin, sample(-1.0e5, 1.0e5));
+	test("cos", bulk::cos<accuracy::precise>, bulk::cos<accuracy::fast>, cos, sample(-100.0, 100.0));
+	test("cos large", bulk::cos<accuracy::precise>, bulk::cos<accuracy::fast>, cos, sample(-1.0e5, 1.0e5));
+	test("tan", bulk::tan<accuracy::precise>, bulk::tan<accuracy::fast>, tan, sample(-100.0, 100.0));
+	test("acos", bulk::acos<accuracy::precise>, bulk::acos<accuracy::fast>, acos, sample(-1.0, 1.0));
+	test("exp", bulk::exp<accuracy::precise>, bulk::exp<accuracy::fast>, exp, sample(-87.0, 88.0));
+	test("exp overflow", bulk::exp<accuracy::precise>, bulk::exp<accuracy::fast>, exp, sample(-110.0, 100.0));
+	test("log", bulk::log<accuracy::precise>, bulk::log<accuracy::fast>, log, sample(1.0e-38, 1.0e38, true));
+	test("log near 1", bulk::log<accuracy::precise>, bulk::log<accuracy::fast>, log, sample(0.5, 2.0));
+	test("sqrt", bulk::sqrt<accuracy::precise>, bulk::sqrt<accuracy::fast>, sqrt, sample(1.0e-38, 1.0e38, true));
+	test("rsqrt", bulk::rsqrt<accuracy::precise>, bulk::rsqrt<accuracy::fast>, rsqrt, sample(1.0e-38, 1.0e38, true));
+
+	// sincos matches sin and cos
+	{
+		const std::vector<float> x = sample(-100.0, 100.0);
+		std::vector<float> s(x.size()), c(x.size()), s2(x.size()), c2(x.size());
+		bulk::sincos<accuracy::precise>(x.data(), s.data(), c.data(), x.size());
+		bulk::sin<accuracy::precise>(x.data(), s2.data(), x.size());
+		bulk::cos<accuracy::precise>(x.data(), c2.data(), x.size());
+		CHECK(s == s2 && c == c2);
+	}
+
+	// atan2 over the four quadrants
+	{
+		const std::vector<float> y = sample(-10.0, 10.0), x = sample(-10.0, 10.0);
+		std::vector<float> r(x.size());
+		tier_error errors[2];
+		bulk::atan2<accuracy::precise>(y.data(), x.data(), r.data(), x.size());
+		for (std::size_t k = 0; k < x.size(); ++k)
+			errors[0].add(r[k], std::atan2(static_cast<double>(y[k]), static_cast<double>(x[k])));
+		bulk::atan2<accuracy::fast>(y.data(), x.data(), r.data(), x.size());
+		for (std::size_t k = 0; k < x.size(); ++k)
+			errors[1].add(r[k], std::atan2(static_cast<double>(y[k]), static_cast<double>(x[k])));
+		report("atan2", errors[0], errors[1]);
+	}
+
+	// special values follow <cmath>
+	{
+		const float special[] = { 0.0f, -0.0f, HUGE_VALF, -HUGE_VALF, NAN, 1.0e-40f, -1.0f, 1.0f, FLT_MAX, 89.0f, -104.0f, 1.0e10f };
+		const std::size_t n = sizeof(special) / sizeof(special[0]);
+		float r[n];
+		bulk::sin(special, r, n);
+		for (std::size_t k = 0; k < n; ++k)
+			CHECK(ulp_error(r[k], std::sin(static_cast<double>(special[k]))) <= 4.0);
+		bulk::exp(special, r, n);
+		for (std::size_t k = 0; k < n; ++k)
+			CHECK(ulp_error(r[k], std::exp(static_cast<double>(special[k]))) <= 4.0);
+		bulk::log(special, r, n);
+		for (std::size_t k = 0; k < n; ++k)
+			CHECK(ulp_error(r[k], std::log(static_cast<double>(special[k]))) <= 4.0);
+		bulk::sqrt(special, r, n);
+		for (std::size_t k = 0; k < n; ++k)
+			CHECK(ulp_error(r[k], std::sqrt(static_cast<double>(special[k]))) <= 4.0);
+		const float y[] = { 0.0f, -0.0f, 0.0f, -0.0f, 1.0f, HUGE_VALF, -HUGE_VALF, 1.0f };
+		const float x[] = { 0.0f, 0.0f, -0.0f, -0.0f, -0.0f, HUGE_VALF, -1.0f, -HUGE_VALF };
+		float a[8];
+		bulk::atan2(y, x, a, 8);
+		for (std::size_t k = 0; k < 8; ++k)
+			CHECK(a[k] == std::atan2(y[k], x[k]) && std::signbit(a[k]) == std::signbit(std::atan2(y[k], x[k])));
+	}
+
+	// the remaining functions match their scalar versions, in place too
+	{
+		std::vector<float> a = sample(-1.0, 1.0), b = sample(-1.0, 1.0), t = sample(0.0, 1.0), r(a.size());
+		bulk::lerp(a.data(), b.data(), t.data(), r.data(), a.size());
+		double error = 0.0;
+		for (std::size_t k = 0; k < a.size(); ++k)
+			error = std::max(error, static_cast<double>(std::fabs(r[k] - lerp(a[k], b[k], t[k]))));
+		CHECK(error <= 2.0 * FLT_EPSILON);
+		bulk::radians(a.data(), r.data(), a.size());
+		error = 0.0;
+		for (std::size_t k = 0; k < a.size(); ++k)
+			error = std::max(error, ulp_error(r[k], static_cast<double>(radians(a[k]))));
+		CHECK(error <= 1.0);
+		bulk::clamp(a.data(), -0.5f, 0.5f, a.data(), a.size());
+		bool clamped = true;
+		for (std::size_t k = 0; k < a.size(); ++k)
+			clamped = clamped && a[k] >= -0.5f && a[k] <= 0.5f;
+		CHECK(clamped);
+	}
+
+	return check::result();
+}
@@ -0,0 +1,165 @@
+// the closed form inverses of the camera against the general inverse,
+// the depth mapping of the standard, reverse z and infinite projections,
+// the frustum against unprojected points, and the lazy recomputation of
+// the cached matrices after set_aspect and look_at
+
+#include <math4games/math4games.h>
+#include <check.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+using namespace math4games;
+
+typedef base_vector<3, float> position;
+typedef base_vector<4, float> homogeneous;
+
+const float infinity = std::numeric_limits<float>::infinity();
+
+// m * v, the data of m row major
+static homogeneous apply(const base_matrix<4, 4, float>& m, const homogeneous& v) {
+	homogeneous r;
+	for (unsigned int i = 0; i < 4; ++i)
+		r.data[i] = m.data[i * 4] * v.data[0] + m.data[i * 4 + 1] * v.data[1] + m.data[i * 4 + 2] * v.data[2] + m.data[i * 4 + 3] * v.data[3];
+	return r;
+}
+
+// largest difference between the entries of a and b, relative to the largest entry of b
+static float relative_difference(const base_matrix<4, 4, float>& a, const base_matrix<4, 4, float>& b) {
+	float d = 0.0f, largest = 0.0f;
+	for (std::size_t i = 0; i < 16; ++i)
+	{
+		d = std::max(d, std::abs(a.data[i] - b.data[i]));
+		largest = std::max(largest, std::abs(b.data[i]));
+	}
+	return d / largest;
+}
+
+// projected depth of the view space point at distance in front of the camera
+static float depth(const camera& c, const float distance) {
+	const homogeneous clip = apply(c.projection(), homogeneous({ 0.0f, 0.0f, -distance, 1.0f }));
+	return clip.data[2] / clip.data[3];
+}
+
+// the world point at the ndc coordinates x, y, z
+static vec3 unproject(const camera& c, const float x, const float y, const float z) {
+	const homogeneous p = apply(c.inverse_view_projection(), homogeneous({ x, y, z, 1.0f }));
+	return vec3(p.data[0] / p.data[3], p.data[1] / p.data[3], p.data[2] / p.data[3]);
+}
+
+// the inverses, the depth mapping and the frustum of a camera
+static void check_camera(std::mt19937& generator, const camera& c, const float near_plane, const float far_plane) {
+	bool invertible = false;
+	CHECK(relative_difference(c.inverse_view(), c.view().inverse(invertible)) <= 1.0e-5f);
+	CHECK(invertible);
+	CHECK(relative_difference(c.inverse_projection(), c.projection().inverse(invertible)) <= 1.0e-4f);
+	CHECK(invertible);
+
+	// view space points projected and unprojected back, through the cached
+	// view projection and its inverse
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	float error = 0.0f;
+	for (int k = 0; k < 20; ++k)
+	{
+		const float distance = near_plane + 10.0f * unit(generator);
+		const homogeneous local({ distance * (0.6f * unit(generator) - 0.3f), distance * (0.6f * unit(generator) - 0.3f), -distance, 1.0f });
+		const homogeneous world = apply(c.inverse_view(), local);
+		const homogeneous clip = apply(c.view_projection(), world);
+		const vec3 back = unproject(c, clip.data[0] / clip.data[3], clip.data[1] / clip.data[3], clip.data[2] / clip.data[3]);
+		const vec3 d(back.x - world.data[0], back.y - world.data[1], back.z - world.data[2]);
+		error = std::max(error, d.magnitude() / distance);
+	}
+	CHECK(error <= 1.0e-3f);
+
+	// near and far planes, and depth strictly monotone in between
+	const float near_depth = c.reverse_z() ? 1.0f : -1.0f, far_depth = c.reverse_z() ? 0.0f : 1.0f;
+	CHECK(std::abs(depth(c, near_plane) - near_depth) <= 1.0e-5f);
+	if (std::isinf(far_plane))
+		CHECK(std::abs(depth(c, 1.0e7f * near_plane) - far_depth) <= 1.0e-5f);
+	else
+		CHECK(std::abs(depth(c, far_plane) - far_depth) <= 1.0e-4f);
+	float last = near_depth;
+	for (float distance = near_plane * 1.5f; distance < std::min(far_plane, 1.0e5f); distance *= 1.5f)
+	{
+		const float d = depth(c, distance);
+		CHECK(c.reverse_z() ? d < last : d > last);
+		last = d;
+	}
+
+	// points unprojected inside the ndc cube are in the frustum, the ones outside are not
+	const frustum& f = c.view_frustum();
+	const float z0 = c.reverse_z() ? 0.95f : -0.95f, z1 = c.reverse_z() ? 0.05f : 0.95f;
+	for (const float x : { -0.95f, 0.0f, 0.95f })
+		for (const float y : { -0.95f, 0.95f })
+			for (const float z : { z0, z1 })
+			{
+				CHECK(f.contains(unproject(c, x, y, z)));
+				CHECK(!f.contains(unproject(c, x < 0.0f ? -1.1f : 1.1f, y, z)));
+				CHECK(!f.contains(unproject(c, x, y < 0.0f ? -1.1f : 1.1f, z)));
+			}
+	CHECK(!f.contains(c.position()));
+	if (std::isinf(far_plane))
+	{
+		const vec3 eye(c.position().data[0], c.position().data[1], c.position().data[2]);
+		const vec3 ahead = unproject(c, 0.0f, 0.0f, 0.0f) - eye;
+		CHECK(f.contains(eye + ahead * 1.0e4f));
+	}
+}
+
+int main()
+{
+	std::mt19937 generator(42);
+	std::uniform_real_distribution<float> uniform(-100.0f, 100.0f), unit(0.0f, 1.0f);
+	for (int k = 0; k < 200; ++k)
+	{
+		camera c;
+		const position eye({ uniform(generator), uniform(generator), uniform(generator) });
+		const position target({ uniform(generator), uniform(generator), uniform(generator) });
+		c.look_at(eye, target);
+		const float fov = 0.5f + 1.5f * unit(generator), aspect = 0.5f + 2.0f * unit(generator);
+		const float near_plane = 0.05f + unit(generator), far_plane = 100.0f + 1000.0f * unit(generator);
+
+		// standard and reverse z, finite and infinite
+		for (const bool reverse_z : { false, true })
+		{
+			for (const float far : { far_plane, infinity })
+			{
+				c.set_perspective(fov, aspect, near_plane, far, reverse_z);
+				CHECK(c.reverse_z() == reverse_z);
+				check_camera(generator, c, near_plane, far);
+			}
+		}
+
+		c.set_orthographic(-aspect * 10.0f, aspect * 10.0f, -10.0f, 10.0f, near_plane, far_plane);
+		check_camera(generator, c, near_plane, far_plane);
+	}
+
+	// the cached matrices follow set_aspect and look_at
+	camera c;
+	c.set_perspective(1.0f, 1.0f, 0.1f, 100.0f);
+	c.look_at(position({ 0.0f, 0.0f, 10.0f }), position({ 0.0f, 0.0f, 0.0f }));
+	const base_matrix<4, 4, float> square = c.view_projection();
+	const base_matrix<4, 4, float> square_inverse = c.inverse_view_projection();
+	// beyond the right plane of a square view, inside a wide one
+	const vec3 side = unproject(c, 1.5f, 0.0f, 0.5f);
+	CHECK(!c.view_frustum().contains(side));
+
+	c.set_aspect(2.0f);
+	camera wide;
+	wide.set_perspective(1.0f, 2.0f, 0.1f, 100.0f);
+	CHECK(relative_difference(c.projection(), wide.projection()) <= 1.0e-6f);
+	CHECK(relative_difference(c.inverse_projection(), wide.inverse_projection()) <= 1.0e-6f);
+	CHECK(c.view_projection() != square && c.view_projection() == c.projection() * c.view());
+	CHECK(c.inverse_view_projection() != square_inverse && c.inverse_view_projection() == c.inverse_view() * c.inverse_projection());
+	CHECK(c.view_frustum().contains(side) && c.view_frustum().contains(vec3(0.0f, 0.0f, -15.0f)));
+	check_camera(generator, c, 0.1f, 100.0f);
+
+	c.look_at(position({ 0.0f, 0.0f, -10.0f }), position({ 0.0f, 0.0f, 0.0f }));
+	CHECK(c.view_projection() == c.projection() * c.view());
+	// the camera turned around
+	CHECK(!c.view_frustum().contains(vec3(0.0f, 0.0f, -15.0f)) && c.view_frustum().contains(vec3(0.0f, 0.0f, 5.0f)));
+	CHECK(std::abs(c.position().data[2] + 10.0f) <= 1.0e-5f);
+	return check::result();
+}
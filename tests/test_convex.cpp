@@ -0,0 +1,204 @@
+// gjk distances and epa penetration depths against the analytic results
+// of spheres, oriented boxes, capsules and point arrays, and the same
+// distances with and without the warm start cache on a moving pair
+
+#include <math4games/math4games.h>
+#include <check.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+using namespace math4games;
+
+// distance from a point to an oriented box, 0 inside
+static float box_distance(const convex_box& box, const vec3& p) {
+	const vec3 d = p - box.center;
+	float squared = 0.0f;
+	for (unsigned int j = 0; j < 3; ++j)
+	{
+		float local = 0.0f;
+		for (unsigned int i = 0; i < 3; ++i)
+			local += box.rotation.data[i * 3 + j] * d.data[i];
+		const float outside = std::max(std::abs(local) - box.extents.data[j], 0.0f);
+		squared += outside * outside;
+	}
+	return std::sqrt(squared);
+}
+
+// distance from a point to the segment a, b
+static float segment_distance(const vec3& a, const vec3& b, const vec3& p) {
+	const vec3 ab = b - a;
+	const float t = std::min(std::max(((p - a) * ab) / (ab * ab), 0.0f), 1.0f);
+	return vec3(p - (a + ab * t)).magnitude();
+}
+
+// float gjk finds the squared distance within rounding of the squared
+// size of the shapes, the distance itself within about sqrt(epsilon) of it
+const float distance_tolerance = 1.0e-3f;
+
+int main()
+{
+	std::mt19937 generator(42);
+	std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> size(0.2f, 2.0f);
+
+	auto random_vector = [&](const float scale) {
+		return vec3(scale * uniform(generator), scale * uniform(generator), scale * uniform(generator));
+	};
+	auto random_box = [&](const vec3& center) {
+		convex_box box;
+		box.center = center;
+		quaternion q(uniform(generator), uniform(generator), uniform(generator), uniform(generator));
+		box.rotation.data = to_matrix3(q.normalize()).data;
+		box.extents = vec3(size(generator), size(generator), size(generator));
+		return box;
+	};
+
+	// sphere and sphere, separated and overlapping
+	for (int k = 0; k < 1000; ++k)
+	{
+		convex_sphere a, b;
+		a.center = random_vector(5.0f);
+		b.center = random_vector(5.0f);
+		a.radius = size(generator);
+		b.radius = size(generator);
+		const float expected = vec3(b.center - a.center).magnitude() - a.radius - b.radius;
+
+		const gjk_result g = gjk_distance(a, b);
+		CHECK(g.intersect == (expected <= 0.0f) || std::abs(expected) < 1.0e-3f);
+		CHECK(gjk_intersect(a, b) == g.intersect);
+		if (!g.intersect)
+		{
+			CHECK(std::abs(g.distance - expected) <= 1.0e-4f * (1.0f + expected));
+			CHECK(std::abs(vec3(g.point_a - a.center).magnitude() - a.radius) <= 1.0e-3f);
+			CHECK(std::abs(vec3(g.point_b - b.center).magnitude() - b.radius) <= 1.0e-3f);
+		}
+		else if (expected < -1.0e-3f)
+		{
+			// curved shapes converge from below
+			const epa_result e = epa_penetration(a, b, g);
+			CHECK(e.valid);
+			CHECK(e.depth <= -expected * 1.0001f + 1.0e-4f && e.depth >= -expected * 0.98f - 1.0e-3f);
+		}
+	}
+
+	// sphere and oriented box
+	for (int k = 0; k < 1000; ++k)
+	{
+		const convex_box box = random_box(random_vector(1.0f));
+		convex_sphere sphere;
+		sphere.center = random_vector(5.0f);
+		sphere.radius = size(generator);
+		const float outside = box_distance(box, sphere.center);
+		const float expected = outside - sphere.radius;
+
+		const gjk_result g = gjk_distance(box, sphere);
+		if (expected > 1.0e-3f)
+		{
+			CHECK(!g.intersect);
+			CHECK(std::abs(g.distance - expected) <= distance_tolerance);
+			CHECK(box_distance(box, g.point_a) <= distance_tolerance);
+		}
+		else if (expected < -1.0e-3f && outside > 0.0f)
+		{
+			// the sphere center is outside the box, the depth is along
+			// the closest point direction
+			CHECK(g.intersect);
+			const epa_result e = epa_penetration(box, sphere, g);
+			CHECK(e.valid);
+			CHECK(e.depth <= -expected * 1.0001f + 1.0e-4f && e.depth >= -expected * 0.98f - 1.0e-3f);
+		}
+	}
+
+	// oriented box and a point array of its corners give the same distances
+	for (int k = 0; k < 200; ++k)
+	{
+		const convex_box box = random_box(random_vector(1.0f));
+		point3 corners[8];
+		for (unsigned int c = 0; c < 8; ++c)
+		{
+			const float local[3] = { c & 1 ? 1.0f : -1.0f, c & 2 ? 1.0f : -1.0f, c & 4 ? 1.0f : -1.0f };
+			for (unsigned int i = 0; i < 3; ++i)
+			{
+				corners[c].data[i] = box.center.data[i];
+				for (unsigned int j = 0; j < 3; ++j)
+					corners[c].data[i] += box.rotation.data[i * 3 + j] * local[j] * box.extents.data[j];
+			}
+		}
+		const convex_points<point3> points(corners, 8);
+		const convex_box other = random_box(random_vector(6.0f));
+		const gjk_result a = gjk_distance(box, other), b = gjk_distance(points, other);
+		CHECK(a.intersect == b.intersect);
+		CHECK(std::abs(a.distance - b.distance) <= distance_tolerance);
+	}
+
+	// overlapping axis aligned boxes, the depth is the smallest overlap
+	for (int k = 0; k < 1000; ++k)
+	{
+		convex_box a, b;
+		a.center = random_vector(0.5f);
+		b.center = random_vector(0.5f);
+		a.extents = vec3(size(generator), size(generator), size(generator));
+		b.extents = vec3(size(generator), size(generator), size(generator));
+		float expected = std::numeric_limits<float>::max();
+		for (unsigned int i = 0; i < 3; ++i)
+			expected = std::min(expected, a.extents.data[i] + b.extents.data[i] - std::abs(a.center.data[i] - b.center.data[i]));
+		if (expected < 1.0e-2f)
+			continue;
+
+		const gjk_result g = gjk_distance(a, b);
+		CHECK(g.intersect);
+		const epa_result e = epa_penetration(a, b, g);
+		CHECK(e.valid);
+		CHECK(std::abs(e.depth - expected) <= 1.0e-4f * (1.0f + expected));
+	}
+
+	// capsule and sphere
+	for (int k = 0; k < 1000; ++k)
+	{
+		convex_capsule capsule;
+		capsule.a = random_vector(2.0f);
+		capsule.b = random_vector(2.0f);
+		capsule.radius = size(generator);
+		convex_sphere sphere;
+		sphere.center = random_vector(6.0f);
+		sphere.radius = size(generator);
+		const float expected = segment_distance(capsule.a, capsule.b, sphere.center) - capsule.radius - sphere.radius;
+		const gjk_result g = gjk_distance(capsule, sphere);
+		if (expected > 1.0e-3f)
+		{
+			CHECK(!g.intersect);
+			CHECK(std::abs(g.distance - expected) <= distance_tolerance);
+		}
+		else if (expected < -1.0e-3f)
+		{
+			CHECK(g.intersect);
+		}
+	}
+
+	// a box moving past another: the warm started queries give the cold
+	// results, in fewer iterations
+	for (int pair = 0; pair < 20; ++pair)
+	{
+		const convex_box a = random_box(vec3::zero);
+		convex_box b = random_box(vec3(-8.0f, uniform(generator), uniform(generator)));
+		const vec3 velocity(0.1f, 0.01f * uniform(generator), 0.01f * uniform(generator));
+		gjk_cache cache;
+		unsigned int cold_iterations = 0, warm_iterations = 0;
+		for (int frame = 0; frame < 160; ++frame)
+		{
+			b.center += velocity;
+			const gjk_result cold = gjk_distance(a, b);
+			const gjk_result warm = gjk_distance(a, b, &cache);
+			CHECK(cold.intersect == warm.intersect);
+			CHECK(std::abs(cold.distance - warm.distance) <= distance_tolerance);
+			CHECK(gjk_intersect(a, b) == cold.intersect);
+			cold_iterations += cold.iterations;
+			warm_iterations += warm.iterations;
+		}
+		CHECK(warm_iterations < cold_iterations);
+	}
+	return check::result();
+}
@@ -0,0 +1,148 @@
+// accuracy of the symmetric 3x3 eigen solver on random rotations of
+// ill conditioned spectra: nearly singular, repeated and clustered
+// eigenvalues, mixed signs, spreads up to 1e12
+
+#include <math4games/math4games.h>
+#include <check.h>
+
+#include <random>
+#include <vector>
+
+using namespace math4games;
+
+// largest errors of a decomposition, relative to the largest eigenvalue
+struct eigen_errors
+{
+	double residual = 0.0;
+	double orthogonality = 0.0;
+	double values = 0.0;
+	bool sorted = true;
+	bool right_handed = true;
+};
+
+template<typename T>
+void measure(const double (&a)[3][3], const double (&expected)[3], const base_eigen3<T>& e, eigen_errors& errors) {
+	const double norm = std::max(std::fabs(expected[0]), std::max(std::fabs(expected[1]), std::fabs(expected[2])));
+	const double scale = norm > 0.0 ? norm : 1.0;
+	double v[3][3];
+	for (unsigned int i = 0; i < 3; ++i)
+		for (unsigned int j = 0; j < 3; ++j)
+			v[i][j] = static_cast<double>(e.vectors.data[i * 3 + j]);
+	for (unsigned int c = 0; c < 3; ++c)
+	{
+		// A v = lambda v for the column c
+		for (unsigned int i = 0; i < 3; ++i)
+		{
+			const double av = a[i][0] * v[0][c] + a[i][1] * v[1][c] + a[i][2] * v[2][c];
+			errors.residual = std::max(errors.residual, std::fabs(av - static_cast<double>(e.values.data[c]) * v[i][c]) / scale);
+		}
+		for (unsigned int d = 0; d < 3; ++d)
+		{
+			const double dot = v[0][c] * v[0][d] + v[1][c] * v[1][d] + v[2][c] * v[2][d];
+			errors.orthogonality = std::max(errors.orthogonality, std::fabs(dot - (c == d ? 1.0 : 0.0)));
+		}
+		errors.values = std::max(errors.values, std::fabs(static_cast<double>(e.values.data[c]) - expected[c]) / scale);
+	}
+	errors.sorted = errors.sorted && e.values.data[0] >= e.values.data[1] && e.values.data[1] >= e.values.data[2];
+	const double det =
+		v[0][0] * (v[1][1] * v[2][2] - v[1][2] * v[2][1]) -
+		v[0][1] * (v[1][0] * v[2][2] - v[1][2] * v[2][0]) +
+		v[0][2] * (v[1][0] * v[2][1] - v[1][1] * v[2][0]);
+	errors.right_handed = errors.right_handed && det > 0.0;
+}
+
+template<typename T>
+void run(const char* name, const double tolerance) {
+	const double spectra[][3] = {
+		{ 1.0, 0.5, 0.25 },
+		{ 1.0, 1.0e-6, 1.0e-12 },
+		{ 1.0e6, 1.0, 1.0e-6 },
+		{ 1.0, 1.0, 1.0e-3 },
+		{ 1.0, 1.0, 1.0 },
+		{ 2.0, 1.0 + 1.0e-7, 1.0 },
+		{ 1.0, 0.0, -1.0 },
+		{ 1.0e-3, -1.0e-9, -1.0 },
+		{ 0.0, 0.0, 0.0 },
+	};
+
+	std::mt19937 generator(26);
+	std::normal_distribution<double> normal;
+	std::vector<base_matrix<3, 3, T>> matrices;
+	std::vector<unsigned int> spectrum;
+	std::vector<std::array<double, 9>> exact;
+	for (unsigned int s = 0; s < sizeof(spectra) / sizeof(spectra[0]); ++s)
+	{
+		for (unsigned int n = 0; n < 1000; ++n)
+		{
+			// A = R diag(spectrum) R^T, R from a random unit quaternion,
+			// the first matrix of each spectrum is diagonal
+			double x = normal(generator), y = normal(generator), z = normal(generator), w = normal(generator);
+			if (n == 0)
+				x = y = z = 0.0, w = 1.0;
+			const double l = std::sqrt(x * x + y * y + z * z + w * w);
+			x /= l, y /= l, z /= l, w /= l;
+			const double r[3][3] = {
+				{ 1 - 2 * (y * y + z * z), 2 * (x * y - z * w), 2 * (x * z + y * w) },
+				{ 2 * (x * y + z * w), 1 - 2 * (x * x + z * z), 2 * (y * z - x * w) },
+				{ 2 * (x * z - y * w), 2 * (y * z + x * w), 1 - 2 * (x * x + y * y) }
+			};
+			std::array<double, 9> a;
+			base_matrix<3, 3, T> m;
+			for (unsigned int i = 0; i < 3; ++i)
+			{
+				for (unsigned int j = 0; j < 3; ++j)
+				{
+					a[i * 3 + j] = 0.0;
+					for (unsigned int k = 0; k < 3; ++k)
+						a[i * 3 + j] += r[i][k] * spectra[s][k] * r[j][k];
+				}
+			}
+			// exactly symmetric in T, the reference is the rounded matrix
+			for (unsigned int i = 0; i < 3; ++i)
+			{
+				for (unsigned int j = i; j < 3; ++j)
+				{
+					m.data[i * 3 + j] = m.data[j * 3 + i] = static_cast<T>(a[i * 3 + j]);
+					a[i * 3 + j] = a[j * 3 + i] = static_cast<double>(m.data[i * 3 + j]);
+				}
+			}
+			matrices.push_back(m);
+			spectrum.push_back(s);
+			exact.push_back(a);
+		}
+	}
+
+	std::vector<base_eigen3<T>> results(matrices.size());
+	eigen_symmetric(matrices.data(), results.data(), matrices.size());
+
+	std::vector<eigen_errors> errors(sizeof(spectra) / sizeof(spectra[0]));
+	for (std::size_t k = 0; k < matrices.size(); ++k)
+	{
+		double a[3][3];
+		for (unsigned int i = 0; i < 9; ++i)
+			a[i / 3][i % 3] = exact[k][i];
+		measure(a, spectra[spectrum[k]], results[k], errors[spectrum[k]]);
+		// the batch version matches the single one
+		const base_eigen3<T> single = eigen_symmetric(matrices[k]);
+		CHECK(single.values.data == results[k].values.data && single.vectors.data == results[k].vectors.data);
+	}
+
+	for (std::size_t s = 0; s < errors.size(); ++s)
+	{
+		const eigen_errors& e = errors[s];
+		std::printf("%s spectrum %g %g %g: residual %.2e, orthogonality %.2e, eigenvalues %.2e\n", name,
+			spectra[s][0], spectra[s][1], spectra[s][2], e.residual, e.orthogonality, e.values);
+		CHECK(e.residual <= tolerance);
+		CHECK(e.orthogonality <= tolerance);
+		CHECK(e.values <= tolerance);
+		CHECK(e.sorted);
+		CHECK(e.right_handed);
+	}
+}
+
+int main()
+{
+	run<float>("float ", 2.0e-6);
+	run<double>("double", 1.0e-14);
+	return check::result();
+}
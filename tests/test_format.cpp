@@ -0,0 +1,162 @@
+// round trip of the text format: shortest floats written by to_chars must
+// parse back to the same bits, through caller buffers and through the
+// buffered writer and reader, and malformed text must be rejected: plus
+// signs not followed by a number, lines longer than the reader buffer and
+// anything but spaces after a value
+
+#include <math4games/math4games.h>
+#include <check.h>
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace math4games;
+
+// random bit patterns, denormals and extremes included, nan excluded
+template<typename T, typename Bits>
+T random_value(std::mt19937_64& generator) {
+	for (;;) {
+		const Bits bits = static_cast<Bits>(generator());
+		T value;
+		std::memcpy(&value, &bits, sizeof(T));
+		if (value == value && value - value == 0)
+			return value;
+	}
+}
+
+template<typename T>
+bool same_bits(const T* a, const T* b, const std::size_t count) {
+	return std::memcmp(a, b, count * sizeof(T)) == 0;
+}
+
+template<typename T>
+bool parses(const char* text, T& value) {
+	const char* last = text + std::strlen(text);
+	const std::from_chars_result result = from_chars(text, last, value);
+	return result.ec == std::errc() && result.ptr == last;
+}
+
+// the text as a temporary file, rewound for reading
+std::FILE* temporary(const std::string& text) {
+	std::FILE* file = std::tmpfile();
+	std::fwrite(text.data(), 1, text.size(), file);
+	std::rewind(file);
+	return file;
+}
+
+int main()
+{
+	std::mt19937_64 generator(42);
+	char buffer[1024];
+
+	// shortest floats and doubles through caller buffers
+	for (int k = 0; k < 20000; ++k)
+	{
+		base_vector<3, float> v({ random_value<float, std::uint32_t>(generator),
+			random_value<float, std::uint32_t>(generator), random_value<float, std::uint32_t>(generator) });
+		base_vector<3, float> v_back;
+		std::to_chars_result written = to_chars(buffer, buffer + sizeof(buffer), v);
+		CHECK(written.ec == std::errc());
+		std::from_chars_result read = from_chars(buffer, written.ptr, v_back);
+		CHECK(read.ec == std::errc() && read.ptr == written.ptr && same_bits(v.data.data(), v_back.data.data(), 3));
+
+		base_point<2, double> p({ random_value<double, std::uint64_t>(generator), random_value<double, std::uint64_t>(generator) });
+		base_point<2, double> p_back;
+		written = to_chars(buffer, buffer + sizeof(buffer), p);
+		read = from_chars(buffer, written.ptr, p_back);
+		CHECK(read.ec == std::errc() && same_bits(p.data.data(), p_back.data.data(), 2));
+
+		mat4 m, m_back;
+		for (float& value : m.data)
+			value = random_value<float, std::uint32_t>(generator);
+		written = to_chars(buffer, buffer + sizeof(buffer), m);
+		read = from_chars(buffer, written.ptr, m_back);
+		CHECK(read.ec == std::errc() && same_bits(m.data.data(), m_back.data.data(), 16));
+
+		const quaternion q(random_value<float, std::uint32_t>(generator), random_value<float, std::uint32_t>(generator),
+			random_value<float, std::uint32_t>(generator), random_value<float, std::uint32_t>(generator));
+		quaternion q_back;
+		written = to_chars(buffer, buffer + sizeof(buffer), q);
+		read = from_chars(buffer, written.ptr, q_back);
+		CHECK(read.ec == std::errc() && same_bits(q.v.data.data(), q_back.v.data.data(), 3) && same_bits(&q.w, &q_back.w, 1));
+	}
+
+	// buffers too small for the text
+	const base_vector<3, float> third({ 1.0f / 3.0f, 2.0f / 3.0f, 1.0f });
+	CHECK(to_chars(buffer, buffer + 12, third).ec == std::errc::value_too_large);
+	CHECK(to_chars(buffer, buffer + 21, third).ec == std::errc::value_too_large);
+	CHECK(to_chars(buffer, buffer + 22, third).ec == std::errc());
+
+	// plus signs only before a number
+	base_vector<3, float> v;
+	CHECK(parses("+1 +.5 -2", v) && v.data[0] == 1.0f && v.data[1] == 0.5f && v.data[2] == -2.0f);
+	CHECK(parses("  1\t2 3", v));
+	CHECK(!parses("+-1 2 3", v));
+	CHECK(!parses("+ 1 2 3", v));
+	CHECK(!parses("1 2 +", v));
+	CHECK(!parses("1 2", v));
+
+	// the buffered writer and reader, with small buffers to refill often
+	std::uniform_real_distribution<float> uniform(-1000.0f, 1000.0f);
+	std::vector<base_vector<4, float>> values(10000), values_back(values.size() + 1);
+	for (base_vector<4, float>& value : values)
+		value = base_vector<4, float>({ uniform(generator), uniform(generator), uniform(generator), uniform(generator) });
+	std::FILE* file = std::tmpfile();
+	{
+		text_writer writer(file, 100);
+		CHECK(writer.write(values.data(), values.size()));
+		CHECK(writer.flush());
+	}
+	std::rewind(file);
+	{
+		text_reader reader(file, 128);
+		CHECK(reader.read(values_back.data(), values_back.size()) == values.size());
+		CHECK(reader.good());
+	}
+	std::fclose(file);
+	bool same = true;
+	for (std::size_t k = 0; k < values.size(); ++k)
+		same = same && same_bits(values[k].data.data(), values_back[k].data.data(), 4);
+	CHECK(same);
+
+	// empty lines, trailing spaces, crlf and a last line without terminator
+	file = temporary("1 2 3\r\n\n  4 5 6  \n7 8 9");
+	{
+		text_reader reader(file, 64);
+		base_vector<3, float> lines[4];
+		CHECK(reader.read(lines, 4) == 3);
+		CHECK(reader.good() && lines[2].data[2] == 9.0f);
+	}
+	std::fclose(file);
+
+	// a line longer than the reader buffer
+	file = temporary("1 2 3\n" + std::string(100, ' ') + "4 5 6\n7 8 9\n");
+	{
+		text_reader reader(file, 32);
+		base_vector<3, float> lines[3];
+		CHECK(reader.read(lines, 3) == 1);
+		CHECK(!reader.good());
+	}
+	std::fclose(file);
+
+	// anything but spaces after the value
+	file = temporary("1 2 3\n4 5 6 x\n7 8 9\n");
+	{
+		text_reader reader(file);
+		base_vector<3, float> lines[3];
+		CHECK(reader.read(lines, 3) == 1);
+		CHECK(!reader.good());
+	}
+	std::fclose(file);
+	file = temporary("1 2 3 4\n");
+	{
+		text_reader reader(file);
+		base_vector<3, float> line;
+		CHECK(!reader.read(line) && !reader.good());
+	}
+	std::fclose(file);
+	return check::result();
+}
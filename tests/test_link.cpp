@@ -0,0 +1,16 @@
+// the library included from two translation units, here and in
+// link_unit.cpp, links without multiple definitions
+
+#include <math4games/math4games.h>
+#include <check.h>
+
+using namespace math4games;
+
+float link_unit_radians(const float degrees);
+
+int main()
+{
+	CHECK(link_unit_radians(180.0f) == radians(180.0f));
+	CHECK(degrees(radians(90.0f)) == 90.0f);
+	return check::result();
+}
@@ -0,0 +1,167 @@
+// analytic gradients of perlin, simplex and fractal noise against central
+// differences, bulk and grid evaluations against single points, and
+// reference values that pin the output across machines and compilers
+
+#include <math4games/math4games.h>
+#include <check.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace math4games;
+
+// the values below are exact without contraction; fused multiply adds,
+// as with MATH4GAMES_NATIVE, change the last bits only
+const float reference_tolerance = 1.0e-6f;
+
+// largest difference between the gradient and central differences of
+// noise at random points, relative to the size of the gradient
+template<std::size_t D, typename Noise>
+float gradient_error(std::mt19937& generator, Noise noise) {
+	std::uniform_real_distribution<float> uniform(-20.0f, 20.0f);
+	const float h = 1.0e-3f;
+	float error = 0.0f;
+	for (int k = 0; k < 2000; ++k)
+	{
+		base_vector<D, float> p, gradient;
+		for (std::size_t i = 0; i < D; ++i)
+			p.data[i] = uniform(generator);
+		noise(p, &gradient);
+		for (std::size_t i = 0; i < D; ++i)
+		{
+			base_vector<D, float> forward = p, backward = p;
+			forward.data[i] += h;
+			backward.data[i] -= h;
+			const double difference = (static_cast<double>(noise(forward, nullptr)) - noise(backward, nullptr))
+				/ (static_cast<double>(forward.data[i]) - backward.data[i]);
+			error = std::max(error, static_cast<float>(std::abs(difference - gradient.data[i]) / (1.0 + std::abs(gradient.data[i]))));
+		}
+	}
+	return error;
+}
+
+template<std::size_t D>
+void check_gradients(std::mt19937& generator) {
+	for (const std::uint32_t seed : { 0u, 12345u })
+	{
+		const float perlin_error = gradient_error<D>(generator, [seed](const base_vector<D, float>& p, base_vector<D, float>* g) {
+			return g != nullptr ? perlin(p, *g, seed) : perlin(p, seed);
+		});
+		const float simplex_error = gradient_error<D>(generator, [seed](const base_vector<D, float>& p, base_vector<D, float>* g) {
+			return g != nullptr ? simplex(p, *g, seed) : simplex(p, seed);
+		});
+		CHECK(perlin_error < 0.01f);
+		CHECK(simplex_error < 0.01f);
+	}
+
+	fractal_noise<D> fbm;
+	fbm.seed = 3;
+	const float fbm_error = gradient_error<D>(generator, [&fbm](const base_vector<D, float>& p, base_vector<D, float>* g) {
+		return g != nullptr ? fbm(p, *g) : fbm(p);
+	});
+	CHECK(fbm_error < 0.01f);
+}
+
+// bulk and grid evaluations give the single point values and gradients
+template<std::size_t D>
+void check_bulk(std::mt19937& generator) {
+	std::uniform_real_distribution<float> uniform(-20.0f, 20.0f);
+	for (const noise_type type : { noise_type::perlin, noise_type::simplex })
+	{
+		fractal_noise<D> noise;
+		noise.type = type;
+		noise.fractal = fractal_type::ridged;
+		noise.octaves = 3;
+
+		// 37 points, a short last block of lanes
+		std::vector<base_vector<D, float>> points(37), gradients(points.size());
+		std::vector<float> values(points.size());
+		for (base_vector<D, float>& p : points)
+			for (std::size_t i = 0; i < D; ++i)
+				p.data[i] = uniform(generator);
+		noise.evaluate(points.data(), values.data(), points.size(), gradients.data(), 2);
+		float largest = 0.0f;
+		for (std::size_t k = 0; k < points.size(); ++k)
+		{
+			base_vector<D, float> gradient;
+			largest = std::max(largest, std::abs(noise(points[k], gradient) - values[k]));
+			for (std::size_t i = 0; i < D; ++i)
+				largest = std::max(largest, std::abs(gradient.data[i] - gradients[k].data[i]) / (1.0f + std::abs(gradient.data[i])));
+			CHECK(values[k] >= 0.0f && values[k] <= 1.0f);
+		}
+		CHECK(largest <= reference_tolerance);
+
+		base_vector<D, float> origin, step;
+		base_vector<D, unsigned int> size;
+		for (std::size_t i = 0; i < D; ++i)
+		{
+			origin.data[i] = uniform(generator);
+			step.data[i] = 0.1f * (i + 1);
+			size.data[i] = 3 + static_cast<unsigned int>(i);
+		}
+		std::vector<float> grid(D == 2 ? 12 : (D == 3 ? 60 : 360));
+		noise.evaluate_grid(origin, step, size, grid.data());
+		largest = 0.0f;
+		for (std::size_t k = 0; k < grid.size(); ++k)
+		{
+			base_vector<D, float> p;
+			std::size_t index = k;
+			for (std::size_t i = 0; i < D; ++i)
+			{
+				p.data[i] = origin.data[i] + step.data[i] * static_cast<float>(index % size.data[i]);
+				index /= size.data[i];
+			}
+			largest = std::max(largest, std::abs(noise(p) - grid[k]));
+		}
+		CHECK(largest <= reference_tolerance);
+	}
+}
+
+static bool near(const float value, const float expected) {
+	return std::abs(value - expected) <= reference_tolerance;
+}
+
+int main()
+{
+	std::mt19937 generator(42);
+	check_gradients<2>(generator);
+	check_gradients<3>(generator);
+	check_gradients<4>(generator);
+	check_bulk<2>(generator);
+	check_bulk<3>(generator);
+	check_bulk<4>(generator);
+
+	// values stay in [-1, 1]
+	std::uniform_real_distribution<float> uniform(-1000.0f, 1000.0f);
+	float largest = 0.0f;
+	for (int k = 0; k < 100000; ++k)
+	{
+		const base_vector<3, float> p({ uniform(generator), uniform(generator), uniform(generator) });
+		largest = std::max(largest, std::max(std::abs(perlin(p)), std::abs(simplex(p))));
+	}
+	CHECK(largest <= 1.0f);
+
+	// reference values, the output must not change across machines
+	const base_vector<2, float> p2({ 0.3f, 1.7f });
+	const base_vector<3, float> p3({ -2.25f, 0.5f, 3.1f });
+	const base_vector<4, float> p4({ 1.1f, -0.4f, 2.6f, 7.3f });
+	CHECK(near(perlin(p2), -0.21384275f));
+	CHECK(near(perlin(p3), -0.338159472f));
+	CHECK(near(perlin(p4), 0.103875175f));
+	CHECK(near(simplex(p2), -0.0739455596f));
+	CHECK(near(simplex(p3), 0.345701903f));
+	CHECK(near(simplex(p4), -0.181229293f));
+	CHECK(near(perlin(p2, 7), -0.155536726f));
+	CHECK(near(perlin(p3, 7), -0.064718999f));
+	CHECK(near(perlin(p4, 7), -0.3985852f));
+	CHECK(near(simplex(p2, 7), 0.564672589f));
+	CHECK(near(simplex(p3, 7), -0.291843295f));
+	CHECK(near(simplex(p4, 7), 0.0398341417f));
+	fractal_noise<3> fractal;
+	CHECK(near(fractal(p3), 0.164899975f));
+	fractal.fractal = fractal_type::ridged;
+	CHECK(near(fractal(p3), 0.344065577f));
+	return check::result();
+}
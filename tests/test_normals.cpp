@@ -0,0 +1,144 @@
+// normal matrices of rigid, uniformly scaled, mirrored, non-uniformly
+// scaled and sheared transforms against the inverse transpose from
+// inverse(bool&).transpose(), the similarity detection, and the aos and
+// soa batch normal transforms against the same reference
+
+#include <math4games/math4games.h>
+#include <check.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace math4games;
+
+typedef base_vector<3, float> direction;
+
+enum class kind { rigid, uniform, mirrored, nonuniform, sheared };
+
+// the upper 3x3, in the layout of the normal matrices
+static base_matrix<3, 3, float> upper(const base_matrix<4, 4, float>& m) {
+	const float* a = m.data.data();
+	return base_matrix<3, 3, float>({ a[0], a[1], a[2], a[4], a[5], a[6], a[8], a[9], a[10] });
+}
+
+// n * v with the rows of n, as transform_normals
+static direction apply(const base_matrix<3, 3, float>& n, const direction& v) {
+	direction r;
+	for (unsigned int i = 0; i < 3; ++i)
+		r.data[i] = n.data[i * 3] * v.data[0] + n.data[i * 3 + 1] * v.data[1] + n.data[i * 3 + 2] * v.data[2];
+	return r;
+}
+
+static direction normalized(const direction& v) {
+	const float length = std::sqrt(v.data[0] * v.data[0] + v.data[1] * v.data[1] + v.data[2] * v.data[2]);
+	return direction({ v.data[0] / length, v.data[1] / length, v.data[2] / length });
+}
+
+static float dot(const direction& a, const direction& b) {
+	return a.data[0] * b.data[0] + a.data[1] * b.data[1] + a.data[2] * b.data[2];
+}
+
+static float distance(const direction& a, const direction& b) {
+	const direction d({ a.data[0] - b.data[0], a.data[1] - b.data[1], a.data[2] - b.data[2] });
+	return std::sqrt(dot(d, d));
+}
+
+int main()
+{
+	std::mt19937 generator(42);
+	std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> size(0.2f, 5.0f);
+
+	const std::size_t count = 64;
+	std::vector<direction> normals(count), tangents(count), results(count);
+	std::vector<vec3> named(count), named_results(count);
+	std::vector<float> soa(3 * count), soa_results(3 * count);
+	const soa_vector<3, float> soa_normals{ { soa.data(), soa.data() + count, soa.data() + 2 * count }, count };
+	soa_vector<3, float> soa_view{ { soa_results.data(), soa_results.data() + count, soa_results.data() + 2 * count }, count };
+
+	for (const kind type : { kind::rigid, kind::uniform, kind::mirrored, kind::nonuniform, kind::sheared })
+	{
+		for (int k = 0; k < 200; ++k)
+		{
+			trs c;
+			c.translation = vector3(10.0f * uniform(generator), 10.0f * uniform(generator), 10.0f * uniform(generator));
+			c.rotation = quaternion(uniform(generator), uniform(generator), uniform(generator), uniform(generator)).normalize();
+			const float s = type == kind::rigid ? 1.0f : size(generator);
+			c.scale = vector3(s, s, s);
+			if (type == kind::mirrored)
+				c.scale[static_cast<unsigned int>(k % 3)] = -s;
+			if (type == kind::nonuniform || type == kind::sheared)
+				c.scale = vector3(size(generator), size(generator), -size(generator));
+			base_matrix<4, 4, float> m = compose(c);
+			if (type == kind::sheared)
+				for (unsigned int j = 0; j < 3; ++j)
+					m.data[j * 4 + 1] += 0.7f * m.data[j * 4];
+
+			// the reference inverse transpose
+			const base_matrix<3, 3, float> u = upper(m);
+			bool invertible = false;
+			const base_matrix<3, 3, float> reference = u.inverse(invertible).transpose();
+			CHECK(invertible);
+			float largest = 0.0f;
+			for (const float value : reference.data)
+				largest = std::max(largest, std::abs(value));
+
+			bool exact_invertible = false;
+			const base_matrix<3, 3, float> exact = inverse_transpose(m, exact_invertible);
+			CHECK(exact_invertible);
+			for (std::size_t i = 0; i < 9; ++i)
+				CHECK(std::abs(exact.data[i] - reference.data[i]) <= 1.0e-5f * largest);
+
+			const bool similarity = type == kind::rigid || type == kind::uniform || type == kind::mirrored;
+			CHECK(is_similarity(m, 1.0e-4f) == similarity);
+			const base_matrix<3, 3, float> n = normal_matrix(m);
+			if (similarity)
+				CHECK(n == u);
+
+			for (std::size_t j = 0; j < count; ++j)
+			{
+				normals[j] = normalized(direction({ uniform(generator), uniform(generator), uniform(generator) }));
+				// a direction in the surface of the normal
+				const direction r({ uniform(generator), uniform(generator), uniform(generator) });
+				const float along = dot(r, normals[j]);
+				tangents[j] = direction({ r.data[0] - along * normals[j].data[0], r.data[1] - along * normals[j].data[1],
+					r.data[2] - along * normals[j].data[2] });
+				named[j] = vec3(normals[j].data[0], normals[j].data[1], normals[j].data[2]);
+				for (unsigned int i = 0; i < 3; ++i)
+					soa[i * count + j] = normals[j].data[i];
+			}
+			transform_normals(n, normals.data(), results.data(), count);
+			transform_normals(n, named.data(), named_results.data(), count);
+			transform_normals(n, soa_normals, soa_view);
+
+			float error = 0.0f, tangent_error = 0.0f;
+			for (std::size_t j = 0; j < count; ++j)
+			{
+				// the same unit direction as the reference, not its opposite
+				const direction expected = normalized(apply(reference, normals[j]));
+				error = std::max(error, distance(results[j], expected));
+				error = std::max(error, distance(direction({ named_results[j].x, named_results[j].y, named_results[j].z }), expected));
+				error = std::max(error, distance(soa_view.get(j), expected));
+				// the transformed tangent stays in the transformed surface
+				const direction tangent = normalized(apply(u, tangents[j]));
+				tangent_error = std::max(tangent_error, std::abs(dot(tangent, results[j])));
+			}
+			CHECK(error <= 1.0e-4f);
+			CHECK(tangent_error <= 1.0e-4f);
+		}
+	}
+
+	// singular transforms and null normals
+	trs flat;
+	flat.scale = vector3(1.0f, 0.0f, 1.0f);
+	bool invertible = true;
+	inverse_transpose(compose(flat), invertible);
+	CHECK(!invertible);
+	const direction null({ 0.0f, 0.0f, 0.0f });
+	direction result({ 1.0f, 1.0f, 1.0f });
+	transform_normals(normal_matrix(compose(trs())), &null, &result, 1);
+	CHECK(result.data[0] == 0.0f && result.data[1] == 0.0f && result.data[2] == 0.0f);
+	return check::result();
+}
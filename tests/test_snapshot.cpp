@@ -0,0 +1,99 @@
+// round trip of the snapshot codec: the decoded snapshots must match the
+// encoded ones and the dequantized values must be within the codec errors,
+// for every rotation precision
+
+#include <math4games/math4games.h>
+#include <check.h>
+
+#include <random>
+#include <vector>
+
+using namespace math4games;
+
+typedef base_vector<3, float> position;
+
+int main()
+{
+	std::mt19937 generator(5);
+	std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+	std::normal_distribution<float> normal;
+	auto random_rotation = [&]() {
+		const float x = normal(generator), y = normal(generator), z = normal(generator), w = normal(generator);
+		const float length = std::sqrt(x * x + y * y + z * z + w * w);
+		return quaternion(x / length, y / length, z / length, w / length);
+	};
+
+	const std::size_t count = 5000;
+	std::vector<position> positions(count), moved(count), decoded_positions(count);
+	std::vector<quaternion> rotations(count), turned(count), decoded_rotations(count);
+	for (std::size_t k = 0; k < count; ++k)
+	{
+		positions[k] = position({ 1000.0f * uniform(generator), 50.0f + 50.0f * uniform(generator), 1000.0f * uniform(generator) });
+		rotations[k] = random_rotation();
+		// the next frame: some entities move a bit, some teleport, some rotate
+		const float r = uniform(generator);
+		moved[k] = positions[k];
+		if (r < -0.4f)
+			moved[k] = position({ positions[k].data[0] + 0.3f * uniform(generator), positions[k].data[1], positions[k].data[2] + 0.3f * uniform(generator) });
+		else if (r > 0.98f)
+			moved[k] = position({ 1000.0f * uniform(generator), 50.0f + 50.0f * uniform(generator), 1000.0f * uniform(generator) });
+		turned[k] = uniform(generator) > 0.6f ? random_rotation() : rotations[k];
+	}
+
+	for (unsigned int rotation_bits = 2; rotation_bits <= 10; ++rotation_bits)
+	{
+		const snapshot_codec codec(position({ -1000.0f, 0.0f, -1000.0f }), position({ 1000.0f, 100.0f, 1000.0f }), 0.01f, rotation_bits, 8);
+		quantized_snapshot baseline, current, decoded;
+		std::vector<std::uint8_t> buffer;
+
+		// full snapshot
+		codec.quantize(positions.data(), rotations.data(), count, baseline);
+		codec.encode(baseline, nullptr, buffer);
+		CHECK(codec.decode(buffer.data(), buffer.size(), nullptr, decoded));
+		CHECK(decoded.rotations == baseline.rotations);
+		for (unsigned int i = 0; i < 3; ++i)
+			CHECK(decoded.positions[i] == baseline.positions[i]);
+
+		codec.dequantize(decoded, decoded_positions.data(), decoded_rotations.data());
+		float position_error = 0.0f, rotation_error = 0.0f, reconstructed_error = 0.0f;
+		for (std::size_t k = 0; k < count; ++k)
+		{
+			for (unsigned int i = 0; i < 3; ++i)
+				position_error = std::max(position_error, std::fabs(positions[k].data[i] - decoded_positions[k].data[i]) - codec.position_error(i));
+			const float q[4] = { rotations[k].v.data[0], rotations[k].v.data[1], rotations[k].v.data[2], rotations[k].w };
+			const float d[4] = { decoded_rotations[k].v.data[0], decoded_rotations[k].v.data[1], decoded_rotations[k].v.data[2], decoded_rotations[k].w };
+			unsigned int largest = 0;
+			for (unsigned int i = 1; i < 4; ++i)
+				largest = std::fabs(q[i]) > std::fabs(q[largest]) ? i : largest;
+			const float sign = q[largest] < 0.0f ? -1.0f : 1.0f;
+			// the three encoded components are within rotation_error, the
+			// reconstructed one, at least 1/2, within 3 times that at first order
+			for (unsigned int i = 0; i < 4; ++i)
+			{
+				if (i == largest)
+					reconstructed_error = std::max(reconstructed_error, std::fabs(q[i] - sign * d[i]));
+				else
+					rotation_error = std::max(rotation_error, std::fabs(q[i] - sign * d[i]));
+			}
+		}
+		std::printf("rotation bits %2u: %5.1f bits/entity, quaternion error %g encoded, %g reconstructed (step/2 %g)\n",
+			rotation_bits, buffer.size() * 8.0 / count, rotation_error, reconstructed_error, codec.rotation_error());
+		CHECK(position_error <= 0.0f);
+		CHECK(rotation_error <= codec.rotation_error() * 1.0001f);
+		CHECK(reconstructed_error <= 3.0f * codec.rotation_error() + rotation_error * rotation_error * 4.0f);
+
+		// delta snapshot
+		codec.quantize(moved.data(), turned.data(), count, current);
+		codec.encode(current, &baseline, buffer);
+		CHECK(codec.decode(buffer.data(), buffer.size(), &baseline, decoded));
+		CHECK(decoded.rotations == current.rotations);
+		for (unsigned int i = 0; i < 3; ++i)
+			CHECK(decoded.positions[i] == current.positions[i]);
+
+		// corrupted streams are rejected
+		CHECK(!codec.decode(buffer.data(), buffer.size() - 5, &baseline, decoded));
+		CHECK(!codec.decode(buffer.data(), buffer.size(), nullptr, decoded));
+	}
+
+	return check::result();
+}
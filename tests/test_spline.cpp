@@ -0,0 +1,156 @@
+// forward differenced tessellation against per point evaluation for every
+// spline type, in float and double, and the arc length table: monotone
+// lengths and parameters, exact on a straight line, and converging to the
+// length of the curve as the samples grow
+
+#include <math4games/math4games.h>
+#include <check.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace math4games;
+
+const spline_type types[] = { spline_type::bezier, spline_type::hermite, spline_type::catmull_rom, spline_type::bspline };
+
+template<typename T>
+static T distance(const base_vector<3, T>& a, const base_vector<3, T>& b) {
+	T squared = T{};
+	for (unsigned int i = 0; i < 3; ++i)
+		squared += (a.data[i] - b.data[i]) * (a.data[i] - b.data[i]);
+	return std::sqrt(squared);
+}
+
+template<typename T>
+static spline<3, T> random_spline(std::mt19937& generator, const spline_type type, const std::size_t count) {
+	std::uniform_real_distribution<T> uniform(static_cast<T>(-10.0), static_cast<T>(10.0));
+	spline<3, T> curve(type);
+	curve.points.resize(count);
+	for (base_vector<3, T>& p : curve.points)
+		p = base_vector<3, T>({ uniform(generator), uniform(generator), uniform(generator) });
+	return curve;
+}
+
+// largest distance between the tessellation and the curve evaluated at each sample
+template<typename T, typename V>
+static T tessellation_error(const spline<3, T>& curve, const std::size_t count) {
+	std::vector<V> samples(count);
+	curve.tessellate(samples.data(), count);
+	const T h = count > 1 ? static_cast<T>(curve.segments()) / static_cast<T>(count - 1) : T{};
+	T error = T{};
+	for (std::size_t k = 0; k < count; ++k)
+	{
+		base_vector<3, T> sample;
+		sample.data = samples[k].data;
+		error = std::max(error, distance(sample, curve.evaluate(static_cast<T>(k) * h)));
+	}
+	return error;
+}
+
+template<typename T>
+static void check_tessellation(std::mt19937& generator, const T tolerance) {
+	for (const spline_type type : types)
+	{
+		for (const std::size_t points : { std::size_t(4), std::size_t(10), std::size_t(31) })
+		{
+			const spline<3, T> curve = random_spline<T>(generator, type, points);
+			if (curve.segments() == 0)
+				continue;
+			// fewer samples than segments, about one per segment and many
+			for (const std::size_t count : { std::size_t(1), std::size_t(2), std::size_t(3), curve.segments() + 1,
+				std::size_t(7), std::size_t(100), std::size_t(1001) })
+			{
+				const T error = tessellation_error<T, base_vector<3, T>>(curve, count);
+				CHECK(error <= tolerance);
+			}
+
+			// the end point is the last sample
+			std::vector<base_vector<3, T>> samples(50);
+			curve.tessellate(samples.data(), samples.size());
+			CHECK(distance(samples.back(), curve.evaluate(static_cast<T>(curve.segments()))) <= tolerance);
+
+			// one segment sampled over part of its range
+			const cubic_segment<3, T> segment = curve.segment(0);
+			std::vector<base_vector<3, T>> part(40);
+			segment.forward_difference(static_cast<T>(0.25), static_cast<T>(0.0125), part.data(), part.size());
+			T error = T{};
+			for (std::size_t k = 0; k < part.size(); ++k)
+				error = std::max(error, distance(part[k], segment.evaluate(static_cast<T>(0.25) + static_cast<T>(k) * static_cast<T>(0.0125))));
+			CHECK(error <= tolerance);
+		}
+	}
+}
+
+template<typename T>
+static bool monotone(const arc_length_table<3, T>& table) {
+	for (std::size_t i = 1; i < table.lengths.size(); ++i)
+		if (table.lengths[i] < table.lengths[i - 1])
+			return false;
+	T last = T{};
+	for (int k = 0; k <= 1000; ++k)
+	{
+		const T u = table.parameter(table.length() * static_cast<T>(k) / static_cast<T>(1000));
+		if (u < last)
+			return false;
+		last = u;
+	}
+	return table.lengths.front() == T{};
+}
+
+template<typename T>
+static void check_arc_length(std::mt19937& generator) {
+	for (const spline_type type : types)
+	{
+		const spline<3, T> curve = random_spline<T>(generator, type, 13);
+		// samples on the joins, bezier segments meet at corners
+		const std::size_t n = curve.segments();
+		const arc_length_table<3, T> coarse(curve, 8 * n + 1), table(curve, 64 * n + 1), fine(curve, 512 * n + 1);
+		CHECK(monotone(coarse) && monotone(table) && monotone(fine));
+		// the chords are shorter than the curve and converge to its length,
+		// the error falls with the square of the step, up to the rounding of the sums
+		const T rounding = fine.length() * std::numeric_limits<T>::epsilon() * 64;
+		CHECK(coarse.length() <= table.length() + rounding && table.length() <= fine.length() + rounding);
+		CHECK(fine.length() - table.length() <= (fine.length() - coarse.length()) / 20 + rounding);
+		// the ends and the table entries map to their parameters
+		CHECK(table.parameter(T{}) == T{} && table.parameter(-T{ 1 }) == T{});
+		const T end = static_cast<T>(curve.segments());
+		CHECK(std::abs(table.parameter(table.length()) - end) <= end * static_cast<T>(1.0e-5));
+		CHECK(std::abs(table.parameter(table.length() * 2) - end) <= end * static_cast<T>(1.0e-5));
+		for (std::size_t i = 0; i < table.lengths.size(); i += 37)
+			CHECK(std::abs(table.parameter(table.lengths[i]) - static_cast<T>(i) * table.step) <= end * static_cast<T>(1.0e-5));
+	}
+
+	// repeated control points, a curve that stops for a while
+	spline<3, T> stop(spline_type::bspline);
+	for (int k = 0; k < 8; ++k)
+		stop.points.push_back(base_vector<3, T>({ static_cast<T>(k < 4 ? 0 : k), T{}, T{} }));
+	CHECK(monotone(arc_length_table<3, T>(stop, 200)));
+
+	// a straight line at constant speed: the length is exact and linear in u
+	spline<3, T> line(spline_type::catmull_rom);
+	for (int k = 0; k < 6; ++k)
+		line.points.push_back(base_vector<3, T>({ static_cast<T>(2 * k), static_cast<T>(k), static_cast<T>(-2 * k) }));
+	const arc_length_table<3, T> straight(line, 100);
+	CHECK(std::abs(straight.length() - static_cast<T>(9)) <= static_cast<T>(1.0e-4));
+	for (int k = 0; k <= 9; ++k)
+		CHECK(std::abs(straight.parameter(static_cast<T>(k)) - static_cast<T>(k) / static_cast<T>(3)) <= static_cast<T>(1.0e-4));
+}
+
+int main()
+{
+	std::mt19937 generator(42);
+	check_tessellation<float>(generator, 1.0e-3f);
+	check_tessellation<double>(generator, 1.0e-9);
+	check_arc_length<float>(generator);
+	check_arc_length<double>(generator);
+
+	// samples into named vector types
+	const spline<3, float> curve = random_spline<float>(generator, spline_type::catmull_rom, 8);
+	const float vector_error = tessellation_error<float, vec3>(curve, 33);
+	const float point_error = tessellation_error<float, point3>(curve, 33);
+	CHECK(vector_error <= 1.0e-3f && point_error <= 1.0e-3f);
+	return check::result();
+}
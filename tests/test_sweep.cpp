@@ -0,0 +1,270 @@
+// times of impact of swept spheres and capsules against the analytic ones,
+// on faces, edges and corners of planes, boxes and triangles, exact for
+// spheres and within the conservative advancement tolerance for capsules,
+// and the 8 lane batch versions against the scalar ones on random pairs
+
+#include <math4games/math4games.h>
+#include <check.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace math4games;
+
+// relative to the distance travelled, the sphere tests are exact
+const float time_tolerance = 1.0e-5f;
+// conservative advancement stops within its 1e-4 gap of the contact, before it
+const float advance_tolerance = 2.0e-4f;
+
+static bool near(const vec3& a, const vec3& b, const float tolerance) {
+	const vec3 d = a - b;
+	return d * d <= tolerance * tolerance;
+}
+
+// a sphere falling along -y from height above a contact at height contact
+static swept_sphere falling(const float x, const float height, const float z, const float radius, const float speed) {
+	swept_sphere s;
+	s.center = vec3(x, height, z);
+	s.radius = radius;
+	s.delta = vec3(0.0f, -speed, 0.0f);
+	return s;
+}
+
+// the sphere hits at the time its center reaches height contact
+static bool hits_at(const sweep_hit& hit, const swept_sphere& s, const float contact) {
+	const float expected = (s.center.y - contact) / -s.delta.y;
+	return hit.hit && std::abs(hit.time - expected) <= time_tolerance;
+}
+
+// the contact point is at radius from the center at the time of impact, along the normal
+static bool consistent(const sweep_hit& hit, const swept_sphere& s) {
+	const vec3 center = s.center + s.delta * hit.time;
+	return near(hit.point + hit.normal * s.radius, center, 1.0e-4f) && std::abs(hit.normal.magnitude() - 1.0f) <= 1.0e-5f;
+}
+
+static void check_spheres(std::mt19937& generator) {
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	const aabb box(vec3(-1.0f, -1.0f, -1.0f), vec3(1.0f, 1.0f, 1.0f));
+	const plane ground(vec3(0.0f, 1.0f, 0.0f), 1.0f);
+	const triangle tri(vec3(-1.0f, 1.0f, -1.0f), vec3(1.0f, 1.0f, -1.0f), vec3(-1.0f, 1.0f, 1.0f));
+	for (int k = 0; k < 1000; ++k)
+	{
+		const float radius = 0.1f + 0.5f * unit(generator);
+		const float speed = 4.0f + 4.0f * unit(generator);
+		const float a = radius * 0.9f * unit(generator), b = radius * 0.9f * unit(generator);
+
+		// faces: the plane, the top of the box and inside the triangle
+		const float x = -0.9f + 0.8f * unit(generator), z = -0.9f + 0.8f * unit(generator);
+		const swept_sphere face = falling(x, 4.0f, z, radius, speed);
+		const sweep_hit on_plane = sweep(face, ground), on_box = sweep(face, box), on_triangle = sweep(face, tri);
+		CHECK(hits_at(on_plane, face, 1.0f + radius) && consistent(on_plane, face));
+		CHECK(hits_at(on_box, face, 1.0f + radius) && consistent(on_box, face));
+		CHECK(hits_at(on_triangle, face, 1.0f + radius) && consistent(on_triangle, face));
+		CHECK(near(on_box.normal, vec3(0.0f, 1.0f, 0.0f), 1.0e-6f) && near(on_triangle.normal, vec3(0.0f, 1.0f, 0.0f), 1.0e-6f));
+
+		// an edge of the box at a from the path, and the hypotenuse of the triangle
+		const swept_sphere edge = falling(1.0f + a, 4.0f, z, radius, speed);
+		const float edge_contact = 1.0f + std::sqrt(radius * radius - a * a);
+		const sweep_hit on_edge = sweep(edge, box);
+		CHECK(hits_at(on_edge, edge, edge_contact) && consistent(on_edge, edge));
+		CHECK(near(on_edge.point, vec3(1.0f, 1.0f, z), 1.0e-4f));
+		const float along = -0.5f + unit(generator);
+		const swept_sphere hypotenuse = falling(along + a * std::sqrt(0.5f), 4.0f, -along + a * std::sqrt(0.5f), radius, speed);
+		const sweep_hit on_hypotenuse = sweep(hypotenuse, tri);
+		CHECK(hits_at(on_hypotenuse, hypotenuse, edge_contact) && consistent(on_hypotenuse, hypotenuse));
+
+		// a corner of the box at a and b from the path, and of the triangle
+		const float corner_contact = 1.0f + std::sqrt(std::max(radius * radius - a * a - b * b, 0.0f));
+		if (a * a + b * b < radius * radius)
+		{
+			const swept_sphere corner = falling(1.0f + a, 4.0f, 1.0f + b, radius, speed);
+			const sweep_hit on_corner = sweep(corner, box);
+			CHECK(hits_at(on_corner, corner, corner_contact) && consistent(on_corner, corner));
+			CHECK(near(on_corner.point, vec3(1.0f, 1.0f, 1.0f), 1.0e-4f));
+			const swept_sphere vertex = falling(-1.0f - a, 4.0f, -1.0f - b, radius, speed);
+			const sweep_hit on_vertex = sweep(vertex, tri);
+			CHECK(hits_at(on_vertex, vertex, corner_contact) && consistent(on_vertex, vertex));
+		}
+
+		// past the edges, stopping short and moving away
+		const swept_sphere wide = falling(1.0f + radius * 1.01f, 4.0f, z, radius, speed);
+		CHECK(!sweep(wide, box).hit && !sweep(wide, tri).hit);
+		const swept_sphere slow = falling(x, 4.0f, z, radius, (3.0f - radius) * 0.99f);
+		CHECK(!sweep(slow, box).hit && !sweep(slow, ground).hit && !sweep(slow, tri).hit);
+		const swept_sphere away = falling(x, 4.0f, z, radius, -speed);
+		CHECK(!sweep(away, box).hit && !sweep(away, ground).hit && !sweep(away, tri).hit);
+
+		// overlapping at time 0
+		const swept_sphere inside = falling(x, 1.0f + radius * 0.5f, z, radius, speed);
+		CHECK(sweep(inside, box).time == 0.0f && sweep(inside, tri).time == 0.0f && sweep(inside, ground).time == 0.0f);
+	}
+
+	// a fast sphere through a thin wall, it would tunnel between two frames
+	const aabb wall(vec3(-1.0f, -0.01f, -1.0f), vec3(1.0f, 0.01f, 1.0f));
+	const swept_sphere bullet = falling(0.0f, 10.0f, 0.0f, 0.05f, 20.0f);
+	CHECK(hits_at(sweep(bullet, wall), bullet, 0.06f));
+}
+
+// a capsule falling along -y, its segment from a to b
+static swept_capsule falling(const vec3& a, const vec3& b, const float radius, const float speed) {
+	swept_capsule s;
+	s.a = a;
+	s.b = b;
+	s.radius = radius;
+	s.delta = vec3(0.0f, -speed, 0.0f);
+	return s;
+}
+
+// the lowest end of the capsule reaches height contact at the time of the hit,
+// exactly or from above within the advancement tolerance
+static bool hits_at(const sweep_hit& hit, const swept_capsule& s, const float contact, const float tolerance) {
+	const float expected = (std::min(s.a.y, s.b.y) - contact) / -s.delta.y;
+	return hit.hit && hit.time <= expected + time_tolerance && hit.time >= expected - tolerance;
+}
+
+static void check_capsules(std::mt19937& generator) {
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	const aabb box(vec3(-1.0f, -1.0f, -1.0f), vec3(1.0f, 1.0f, 1.0f));
+	const plane ground(vec3(0.0f, 1.0f, 0.0f), 1.0f);
+	const triangle tri(vec3(-1.0f, 1.0f, -1.0f), vec3(1.0f, 1.0f, -1.0f), vec3(-1.0f, 1.0f, 1.0f));
+	for (int k = 0; k < 500; ++k)
+	{
+		const float radius = 0.1f + 0.5f * unit(generator);
+		const float speed = 4.0f + 4.0f * unit(generator);
+		const float x = -0.5f + 0.4f * unit(generator), z = -0.5f + 0.4f * unit(generator);
+		const float tilt = 0.5f * unit(generator);
+
+		// a tilted capsule on the plane, the box top and the triangle
+		const swept_capsule face = falling(vec3(x, 4.0f, z), vec3(x + 0.3f, 4.0f + tilt, z + 0.2f), radius, speed);
+		CHECK(hits_at(sweep(face, ground), face, 1.0f + radius, time_tolerance));
+		CHECK(hits_at(sweep(face, box), face, 1.0f + radius, advance_tolerance));
+		CHECK(hits_at(sweep(face, tri), face, 1.0f + radius, advance_tolerance));
+
+		// a capsule along z over an edge of the box, at a from it
+		const float a = radius * 0.9f * unit(generator);
+		const swept_capsule edge = falling(vec3(1.0f + a, 4.0f, -2.0f), vec3(1.0f + a, 4.0f, 2.0f), radius, speed);
+		const sweep_hit on_edge = sweep(edge, box);
+		CHECK(hits_at(on_edge, edge, 1.0f + std::sqrt(radius * radius - a * a), advance_tolerance));
+		CHECK(near(on_edge.point, vec3(1.0f, 1.0f, on_edge.point.z), 1.0e-3f));
+
+		// crossing the triangle without any end above it
+		const swept_capsule across = falling(vec3(-3.0f, 4.0f, -0.5f), vec3(3.0f, 4.0f, -0.5f), radius, speed);
+		CHECK(hits_at(sweep(across, tri), across, 1.0f + radius, advance_tolerance));
+
+		// past the edge, stopping short and moving away
+		const swept_capsule wide = falling(vec3(1.0f + radius * 1.05f, 4.0f, -2.0f), vec3(1.0f + radius * 1.05f, 4.0f, 2.0f), radius, speed);
+		CHECK(!sweep(wide, box).hit);
+		const swept_capsule slow = falling(face.a, face.b, radius, (3.0f - radius) * 0.99f);
+		CHECK(!sweep(slow, box).hit && !sweep(slow, ground).hit && !sweep(slow, tri).hit);
+		const swept_capsule away = falling(face.a, face.b, radius, -speed);
+		CHECK(!sweep(away, box).hit && !sweep(away, ground).hit && !sweep(away, tri).hit);
+	}
+}
+
+// random pairs near each other, so that about half hit
+static swept_sphere random_sphere(std::mt19937& generator) {
+	std::uniform_real_distribution<float> uniform(-3.0f, 3.0f), size(0.05f, 0.6f);
+	swept_sphere s;
+	s.center = vec3(uniform(generator), uniform(generator), uniform(generator));
+	s.radius = size(generator);
+	s.delta = vec3(-s.center.x, -s.center.y, -s.center.z) * (0.5f + 0.3f * uniform(generator))
+		+ vec3(uniform(generator), uniform(generator), uniform(generator)) * 0.3f;
+	return s;
+}
+
+static aabb random_aabb(std::mt19937& generator) {
+	std::uniform_real_distribution<float> uniform(-1.0f, 1.0f), size(0.1f, 1.0f);
+	const vec3 center(uniform(generator), uniform(generator), uniform(generator));
+	const vec3 extents(size(generator), size(generator), size(generator));
+	return aabb(center - extents, center + extents);
+}
+
+static triangle random_triangle(std::mt19937& generator) {
+	std::uniform_real_distribution<float> uniform(-1.5f, 1.5f);
+	return triangle(vec3(uniform(generator), uniform(generator), uniform(generator)),
+		vec3(uniform(generator), uniform(generator), uniform(generator)), vec3(uniform(generator), uniform(generator), uniform(generator)));
+}
+
+static plane random_plane(std::mt19937& generator) {
+	std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+	return plane(vec3(uniform(generator), uniform(generator), uniform(generator)).normalize(), uniform(generator));
+}
+
+// the batch results are the scalar ones, the first hit is the earliest
+static bool same_hits(const sweep_hit* batch, const sweep_hit* scalar, const std::size_t count, const std::size_t first) {
+	std::size_t earliest = count;
+	for (std::size_t k = 0; k < count; ++k)
+	{
+		const sweep_hit& a = batch[k];
+		const sweep_hit& b = scalar[k];
+		if (a.hit != b.hit)
+			return false;
+		if (!a.hit)
+			continue;
+		if (std::abs(a.time - b.time) > time_tolerance || !near(a.normal, b.normal, 1.0e-4f) || !near(a.point, b.point, 1.0e-4f))
+			return false;
+		if (earliest == count || b.time < scalar[earliest].time)
+			earliest = k;
+	}
+	return first == earliest || (first != count && earliest != count && batch[first].time == batch[earliest].time);
+}
+
+template<typename Primitive, typename Random>
+static void check_batch(std::mt19937& generator, Random random) {
+	// 1003 pairs, a short last block of lanes
+	const std::size_t count = 1003;
+	std::vector<swept_sphere> spheres(count);
+	std::vector<Primitive> primitives(count);
+	for (std::size_t k = 0; k < count; ++k)
+	{
+		spheres[k] = random_sphere(generator);
+		primitives[k] = random(generator);
+	}
+	std::vector<sweep_hit> batch(count), scalar(count);
+	std::size_t hits = 0;
+
+	// one sphere against many primitives
+	for (std::size_t k = 0; k < count; ++k)
+	{
+		scalar[k] = sweep(spheres[0], primitives[k]);
+		hits += scalar[k].hit;
+	}
+	std::size_t first = sweep(spheres[0], primitives.data(), count, batch.data());
+	CHECK(same_hits(batch.data(), scalar.data(), count, first));
+
+	// many spheres against one primitive
+	for (std::size_t k = 0; k < count; ++k)
+	{
+		scalar[k] = sweep(spheres[k], primitives[0]);
+		hits += scalar[k].hit;
+	}
+	first = sweep(spheres.data(), count, primitives[0], batch.data());
+	CHECK(same_hits(batch.data(), scalar.data(), count, first));
+	CHECK(hits > count / 10 && hits < 2 * count - count / 10);
+
+	// capsules, the batch versions loop on the scalar test
+	std::vector<swept_capsule> capsules(count);
+	for (std::size_t k = 0; k < count; ++k)
+	{
+		capsules[k].a = spheres[k].center;
+		capsules[k].b = spheres[k].center + vec3(0.2f, 0.3f, -0.1f);
+		capsules[k].radius = spheres[k].radius;
+		capsules[k].delta = spheres[k].delta;
+		scalar[k] = sweep(capsules[k], primitives[0]);
+	}
+	first = sweep(capsules.data(), count, primitives[0], batch.data());
+	CHECK(same_hits(batch.data(), scalar.data(), count, first));
+}
+
+int main()
+{
+	std::mt19937 generator(42);
+	check_spheres(generator);
+	check_capsules(generator);
+	check_batch<plane>(generator, random_plane);
+	check_batch<aabb>(generator, random_aabb);
+	check_batch<triangle>(generator, random_triangle);
+	return check::result();
+}
@@ -0,0 +1,137 @@
+// compose and decompose round trips on random transforms, with negative
+// scales, zero scales and shear, and the rotation of the 2D transform
+
+#include <math4games/math4games.h>
+#include <check.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace math4games;
+
+static float largest_difference(const base_matrix<4, 4, float>& a, const base_matrix<4, 4, float>& b) {
+	float d = 0.0f;
+	for (std::size_t i = 0; i < 16; ++i)
+		d = std::max(d, std::abs(a.data[i] - b.data[i]));
+	return d;
+}
+
+// the same rotation, q and -q included
+static bool same_rotation(const quaternion& a, const quaternion& b) {
+	const float d = a.v[0] * b.v[0] + a.v[1] * b.v[1] + a.v[2] * b.v[2] + a.w * b.w;
+	return std::abs(std::abs(d) - 1.0f) < 1.0e-5f;
+}
+
+static bool unit(const quaternion& q) {
+	const float n = q.v[0] * q.v[0] + q.v[1] * q.v[1] + q.v[2] * q.v[2] + q.w * q.w;
+	return std::abs(n - 1.0f) < 1.0e-5f;
+}
+
+int main()
+{
+	std::mt19937 generator(42);
+	std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> size(0.1f, 10.0f);
+
+	auto random_rotation = [&]() {
+		quaternion q(uniform(generator), uniform(generator), uniform(generator), uniform(generator));
+		return q.normalize();
+	};
+
+	std::vector<base_matrix<4, 4, float>> matrices;
+	std::vector<trs> expected;
+	for (int k = 0; k < 1000; ++k)
+	{
+		trs c;
+		c.translation = vector3(100.0f * uniform(generator), 100.0f * uniform(generator), 100.0f * uniform(generator));
+		c.rotation = random_rotation();
+		c.scale = vector3(size(generator), size(generator), size(generator));
+		const base_matrix<4, 4, float> m = compose(c);
+
+		bool sheared = true;
+		const trs d = decompose(m, sheared);
+		CHECK(!sheared);
+		CHECK(same_rotation(d.rotation, c.rotation));
+		for (unsigned int i = 0; i < 3; ++i)
+		{
+			CHECK(std::abs(d.translation[i] - c.translation[i]) <= 1.0e-5f * std::abs(c.translation[i]));
+			CHECK(std::abs(d.scale[i] - c.scale[i]) <= 1.0e-5f * c.scale[i]);
+		}
+		CHECK(largest_difference(compose(d), m) <= 1.0e-5f * 100.0f);
+		matrices.push_back(m);
+		expected.push_back(d);
+	}
+
+	// the batch gives the same components
+	std::vector<trs> batch(matrices.size());
+	decompose(matrices.data(), batch.data(), matrices.size());
+	for (std::size_t k = 0; k < matrices.size(); ++k)
+	{
+		CHECK(same_rotation(batch[k].rotation, expected[k].rotation));
+		CHECK(batch[k].scale == expected[k].scale);
+	}
+
+	// a negative scale on any axis is folded into x and composes back
+	for (unsigned int axis = 0; axis < 3; ++axis)
+	{
+		trs c;
+		c.translation = vector3(1.0f, 2.0f, 3.0f);
+		c.rotation = random_rotation();
+		c.scale = vector3(2.0f, 3.0f, 4.0f);
+		c.scale[axis] = -c.scale[axis];
+		const base_matrix<4, 4, float> m = compose(c);
+
+		bool sheared = true;
+		const trs d = decompose(m, sheared);
+		CHECK(!sheared);
+		CHECK(d.scale[0] < 0.0f && d.scale[1] > 0.0f && d.scale[2] > 0.0f);
+		CHECK(std::abs(std::abs(d.scale[axis]) - std::abs(c.scale[axis])) <= 1.0e-5f);
+		CHECK(unit(d.rotation));
+		CHECK(largest_difference(compose(d), m) <= 1.0e-5f);
+	}
+
+	// shear of the y axis along x, and of z along y
+	for (unsigned int axis = 1; axis < 3; ++axis)
+	{
+		trs c;
+		c.rotation = random_rotation();
+		c.scale = vector3(1.0f, 2.0f, 3.0f);
+		base_matrix<4, 4, float> m = compose(c);
+		for (unsigned int j = 0; j < 3; ++j)
+			m.data[j * 4 + axis] += 0.3f * m.data[j * 4 + axis - 1];
+		bool sheared = false;
+		const trs d = decompose(m, sheared);
+		CHECK(sheared);
+		CHECK(unit(d.rotation));
+	}
+
+	// zero scales give a rotation that is still a unit quaternion
+	for (unsigned int zeros = 1; zeros <= 3; ++zeros)
+	{
+		trs c;
+		c.rotation = random_rotation();
+		c.scale = vector3(2.0f, 3.0f, 4.0f);
+		for (unsigned int i = 0; i < zeros; ++i)
+			c.scale[i] = 0.0f;
+		const trs d = decompose(compose(c));
+		CHECK(unit(d.rotation));
+		for (unsigned int i = 0; i < 3; ++i)
+			CHECK(std::abs(d.scale[i] - c.scale[i]) <= 1.0e-5f);
+	}
+
+	// the 2D rotation keeps the sign of the direction
+	const base_vector<2, float> origin({ 0.0f, 0.0f }), one({ 1.0f, 1.0f });
+	const base_matrix<3, 3, float> up = transform(origin, base_vector<2, float>({ 0.0f, 1.0f }), one);
+	const base_matrix<3, 3, float> down = transform(origin, base_vector<2, float>({ 0.0f, -2.0f }), one);
+	const base_matrix<3, 3, float> left = transform(origin, base_vector<2, float>({ -3.0f, 0.0f }), one);
+	const base_matrix<3, 3, float> quarter = rotate_z<3, float>(90.0f), half = rotate_z<3, float>(180.0f);
+	for (std::size_t i = 0; i < 9; ++i)
+	{
+		CHECK(std::abs(up.data[i] - quarter.data[i]) <= 1.0e-6f);
+		CHECK(std::abs(down.data[i] - quarter.transpose().data[i]) <= 1.0e-6f);
+		CHECK(std::abs(left.data[i] - half.data[i]) <= 1.0e-6f);
+	}
+	return check::result();
+}
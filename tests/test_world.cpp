@@ -0,0 +1,207 @@
+// rebasing far positions and transforms to a near origin against the
+// exact double differences, the batch and soa rebases against the scalar
+// one, and the cell and offset positions: construction, the carry of
+// whole cells on both sides of zero, long walks and differences far from
+// the world origin
+
+#include <math4games/math4games.h>
+#include <check.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace math4games;
+
+typedef base_vector<3, double> dposition;
+typedef base_vector<3, float> fposition;
+typedef base_vector<3, int> cells;
+
+const float cell = static_cast<float>(world_cell_size);
+// half an ulp of the offsets, the precision of a cell and offset position
+const double offset_precision = world_cell_size * std::ldexp(1.0, -24);
+
+// largest error of the float a against the double b, in ulps of b
+static double ulps(const fposition& a, const dposition& b) {
+	double largest = 0.0;
+	for (unsigned int i = 0; i < 3; ++i)
+	{
+		const double ulp = std::max(std::ldexp(std::abs(b.data[i]), -23), static_cast<double>(std::numeric_limits<float>::denorm_min()));
+		largest = std::max(largest, std::abs(a.data[i] - b.data[i]) / ulp);
+	}
+	return largest;
+}
+
+static dposition difference(const dposition& a, const dposition& b) {
+	return dposition({ a.data[0] - b.data[0], a.data[1] - b.data[1], a.data[2] - b.data[2] });
+}
+
+static double largest_error(const dposition& a, const dposition& b) {
+	const dposition d = difference(a, b);
+	return std::max(std::abs(d.data[0]), std::max(std::abs(d.data[1]), std::abs(d.data[2])));
+}
+
+static bool in_cell(const world_position& p) {
+	for (unsigned int i = 0; i < 3; ++i)
+		if (!(p.offset.data[i] >= 0.0f && p.offset.data[i] < cell))
+			return false;
+	return true;
+}
+
+static void check_rebase(std::mt19937_64& generator) {
+	std::uniform_real_distribution<double> far(-1.0e9, 1.0e9), near(-1000.0, 1000.0);
+	const std::size_t count = 1000;
+	std::vector<dposition> positions(count);
+	std::vector<base_matrix<4, 4, double>> transforms(count);
+	std::vector<base_matrix<4, 4, float>> locals(count);
+	std::vector<fposition> rebased(count);
+	double rebase_error = 0.0, naive_error = 0.0, transform_error = 0.0;
+	for (std::size_t k = 0; k < count; ++k)
+	{
+		// a position near a far origin
+		const dposition origin({ far(generator), far(generator), far(generator) });
+		positions[k] = dposition({ origin.data[0] + near(generator), origin.data[1] + near(generator), origin.data[2] + near(generator) });
+		const dposition exact = difference(positions[k], origin);
+		rebased[k] = rebase(positions[k], origin);
+		rebase_error = std::max(rebase_error, ulps(rebased[k], exact));
+		// narrowing first loses everything below the ulp of the far origin
+		const fposition naive = narrow(positions[k]) - narrow(origin);
+		naive_error = std::max(naive_error, largest_error(widen(naive), exact));
+
+		// the translation is rebased as the position, the linear part is narrowed
+		const quaternion rotation = quaternion(near(generator), near(generator), near(generator), near(generator)).normalize();
+		const fposition scale({ 0.5f, 2.0f, 3.0f });
+		transforms[k] = compose(positions[k], rotation, scale);
+		locals[k] = rebase(transforms[k], origin);
+		const base_matrix<4, 4, float> expected = compose(rebased[k], rotation, scale);
+		for (std::size_t i = 0; i < 16; ++i)
+			transform_error = std::max(transform_error, static_cast<double>(std::abs(locals[k].data[i] - expected.data[i])));
+	}
+	CHECK(rebase_error <= 0.5);
+	CHECK(naive_error >= 10.0);
+	CHECK(transform_error == 0.0);
+
+	// batch versions of vectors, named vectors and points, matrices and soa
+	const dposition origin({ far(generator), far(generator), far(generator) });
+	std::vector<fposition> batch(count);
+	std::vector<vec3> named(count);
+	std::vector<point3> points(count);
+	std::vector<base_matrix<4, 4, float>> matrices(count);
+	rebase(positions.data(), batch.data(), count, origin);
+	rebase(positions.data(), named.data(), count, origin);
+	rebase(positions.data(), points.data(), count, origin);
+	rebase(transforms.data(), matrices.data(), count, origin);
+	std::vector<double> soa(3 * count);
+	std::vector<float> soa_results(3 * count);
+	for (std::size_t k = 0; k < count; ++k)
+		for (unsigned int i = 0; i < 3; ++i)
+			soa[i * count + k] = positions[k].data[i];
+	const soa_vector<3, double> soa_positions{ { soa.data(), soa.data() + count, soa.data() + 2 * count }, count };
+	soa_vector<3, float> soa_view{ { soa_results.data(), soa_results.data() + count, soa_results.data() + 2 * count }, count };
+	rebase(soa_positions, soa_view, origin);
+	bool same = true;
+	for (std::size_t k = 0; k < count; ++k)
+	{
+		const fposition expected = rebase(positions[k], origin);
+		same = same && batch[k] == expected && named[k].data == expected.data && points[k].data == expected.data;
+		same = same && soa_view.get(k) == expected && matrices[k] == rebase(transforms[k], origin);
+	}
+	CHECK(same);
+
+	// narrowing and widening
+	const fposition f({ 1.0f / 3.0f, -1.0e30f, 1.0e-30f });
+	CHECK(narrow(widen(f)) == f);
+	const base_matrix<3, 3, float> m({ 1.0f / 3.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f, 1.0f / 7.0f });
+	CHECK(narrow(widen(m)) == m);
+}
+
+static void check_cells(std::mt19937_64& generator) {
+	std::uniform_real_distribution<double> far(-1.0e9, 1.0e9), near(-3000.0, 3000.0);
+
+	// construction from double positions, on both sides of zero
+	double error = 0.0;
+	bool inside = true;
+	for (int k = 0; k < 10000; ++k)
+	{
+		const dposition p({ far(generator), near(generator), far(generator) * 1.0e-6 });
+		const world_position w(p);
+		inside = inside && in_cell(w);
+		error = std::max(error, largest_error(w.position(), p));
+	}
+	CHECK(inside);
+	CHECK(error <= offset_precision);
+
+	// on and just below cell boundaries
+	const world_position boundary(dposition({ 3.0 * world_cell_size, -2.0 * world_cell_size, 0.0 }));
+	CHECK(boundary.cell == cells({ 3, -2, 0 }) && boundary.offset == fposition({ 0.0f, 0.0f, 0.0f }));
+	const world_position below(dposition({ -1.0e-9, 5.0 * world_cell_size - 1.0e-9, 0.0 }));
+	CHECK(in_cell(below) && largest_error(below.position(), dposition({ 0.0, 5.0 * world_cell_size, 0.0 })) <= offset_precision);
+
+	// the carry of whole cells
+	world_position p(dposition({ 5.0 * world_cell_size + 1000.0, 10.0, 0.0 }));
+	p += fposition({ 100.0f, -20.0f, 4.5f * cell });
+	CHECK(p.cell == cells({ 6, -1, 4 }));
+	CHECK(p.offset == fposition({ 1100.0f - cell, cell - 10.0f, 0.5f * cell }));
+	p -= fposition({ 3.0f * cell, -10.0f, 5.0f * cell });
+	CHECK(p.cell == cells({ 3, 0, -1 }));
+	CHECK(p.offset == fposition({ 1100.0f - cell, 0.0f, 0.5f * cell }));
+	CHECK((p + fposition({ 1.0f, 1.0f, 1.0f }) - fposition({ 1.0f, 1.0f, 1.0f })).cell == p.cell);
+
+	// a long walk far from the world origin: the cell and offset position
+	// keeps the precision of its offsets, a float position does not move at all
+	const dposition start({ 3.0e8, -7.0e8, 1.0e8 });
+	world_position walker(start);
+	dposition exact = start;
+	fposition naive = narrow(start);
+	std::uniform_real_distribution<float> step(-0.3f, 0.5f);
+	const int steps = 100000;
+	for (int k = 0; k < steps; ++k)
+	{
+		const fposition d({ step(generator), step(generator), step(generator) });
+		walker += d;
+		naive += d;
+		for (unsigned int i = 0; i < 3; ++i)
+			exact.data[i] += d.data[i];
+	}
+	CHECK(in_cell(walker));
+	CHECK(largest_error(walker.position(), exact) <= steps * offset_precision);
+	CHECK(largest_error(widen(naive), exact) >= 1000.0);
+
+	// differences far from the world origin, and invariant under a shift by whole cells
+	float difference_error = 0.0f;
+	bool invariant = true;
+	std::vector<world_position> positions(1000);
+	std::vector<fposition> rebased(positions.size());
+	const world_position origin(dposition({ far(generator), far(generator), far(generator) }));
+	for (world_position& q : positions)
+	{
+		q = origin + fposition({ static_cast<float>(near(generator)), static_cast<float>(near(generator)), static_cast<float>(near(generator)) });
+		const fposition d = q - origin;
+		const dposition expected = difference(q.position(), origin.position());
+		difference_error = std::max(difference_error, static_cast<float>(ulps(d, expected)));
+		world_position shifted = q, shifted_origin = origin;
+		for (unsigned int i = 0; i < 3; ++i)
+		{
+			shifted.cell.data[i] -= 1000000;
+			shifted_origin.cell.data[i] -= 1000000;
+		}
+		invariant = invariant && shifted - shifted_origin == d && rebase(q, origin) == d;
+	}
+	CHECK(difference_error <= 1.0f);
+	CHECK(invariant);
+	rebase(positions.data(), rebased.data(), positions.size(), origin);
+	bool same = true;
+	for (std::size_t k = 0; k < positions.size(); ++k)
+		same = same && rebased[k] == positions[k] - origin;
+	CHECK(same);
+}
+
+int main()
+{
+	std::mt19937_64 generator(42);
+	check_rebase(generator);
+	check_cells(generator);
+	return check::result();
+}